@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "core/Window.h"
+
+namespace stereorizer::bench
+{
+	struct BenchModel {
+		std::string meshPath;
+		std::string shaderPath;
+		glm::vec3 position = glm::vec3(0.0f);
+		float rotationAngle = 0.0f;		// degrees
+		glm::vec3 rotationAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+		glm::vec3 scale = glm::vec3(1.0f);
+		glm::vec3 color = glm::vec3(1.0f);
+	};
+
+	struct BenchLight {
+		bool point = false;
+		glm::vec3 vector = glm::vec3(-1.0f, -1.0f, -1.0f);	// direction, or position for a point light
+		glm::vec3 color = glm::vec3(1.0f);
+		float intensity = 1.0f;
+	};
+
+	struct BenchResolution {
+		int width = 0;		// both eyes side by side, each eye gets half
+		int height = 0;
+	};
+
+	// Scene, head path and run matrix of one benchmark, read from a text file. Every line is a
+	// directive followed by its values, '#' starts a comment; paths are relative to the working directory.
+	//   model <mesh> <shader>			position/rotation/scale/color lines that follow apply to it
+	//   position <x> <y> <z>
+	//   rotation <degrees> <axis x> <axis y> <axis z>
+	//   scale <x> <y> <z>
+	//   color <r> <g> <b>
+	//   light directional|point <x> <y> <z>	then light_color <r> <g> <b>, light_intensity <i>
+	//   path <camera path file>		see CameraPath
+	//   fov <degrees>, near <m>, far <m>, ipd <m>
+	//   technique <name>...			names from graphics::StereoTechniqueRegistry, repeatable
+	//   resolution <width>x<height>...	window size, repeatable
+	//   frames <n>, warmup <n>, timestep <seconds>, frames_in_flight <1-3>
+	//   output <path without extension>	.csv and .json are written next to each other
+	struct BenchConfig {
+		std::vector<BenchModel> models;
+		BenchLight light;
+		std::string cameraPath;
+		float fov = 45.0f;
+		float nearPlane = 0.1f;
+		float farPlane = 100.0f;
+		float ipd = 0.064f;
+		std::vector<std::string> techniques;
+		std::vector<BenchResolution> resolutions;
+		int frames = 300;
+		int warmupFrames = 30;
+		float timestep = 1.0f / 90.0f;
+		int framesInFlight = 2;
+		std::string outputPath = "bench_results";
+
+		bool Load(const std::string& path);
+		// Checks what the runner relies on, errors name the source the config came from
+		bool Validate(const std::string& source) const;
+	};
+}
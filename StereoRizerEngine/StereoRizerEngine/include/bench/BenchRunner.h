@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench/BenchConfig.h"
+#include "bench/CameraPath.h"
+
+namespace stereorizer::bench
+{
+	struct BenchFrameResult {
+		size_t run = 0;				// index into the run list
+		uint64_t frame = 0;			// 0-based within the measured frames
+		double cpuMs = 0.0;			// CPU time of the frame, submission only
+		double fenceWaitMs = 0.0;	// time blocked on the frame ring fence, not part of cpuMs
+		double gpuMs = -1.0;		// negative when the GPU timing never came back
+		double techniqueGpuMs = -1.0;	// the technique's own GPU time, negative when it never came back
+		float pixelReuse = 0.0f;	// share of right-eye pixels taken from the left eye
+		uint64_t glCallsIssued = 0;		// state calls that reached the driver, see GLStateCache
+		uint64_t glCallsSkipped = 0;	// redundant state calls the cache dropped
+	};
+
+	struct BenchRunResult {
+		std::string technique;
+		int width = 0;
+		int height = 0;
+		bool skipped = false;		// the technique isn't supported by this GL
+		size_t firstFrame = 0;		// range of the run in the frame list
+		size_t frameCount = 0;
+	};
+
+	// Drives a headless Window through every technique x resolution of a BenchConfig. Each run
+	// replays the same head path from frame 0 with a fixed timestep after a few warmup frames,
+	// so two runs differ only in how the eyes are rendered. Results go to CSV (one row per frame)
+	// and JSON (per-run summaries plus the frames).
+	class BenchRunner {
+	public:
+		explicit BenchRunner(BenchConfig config);
+		~BenchRunner();
+
+		bool Run();
+
+		bool WriteCsv(const std::string& path) const;
+		bool WriteJson(const std::string& path) const;
+
+		const std::vector<BenchRunResult>& GetRuns() const { return _runs; }
+		const std::vector<BenchFrameResult>& GetFrames() const { return _frames; }
+
+	private:
+		BenchConfig _config;
+		CameraPath _path;
+		std::unique_ptr<core::Window> _window;
+		std::vector<std::shared_ptr<graphics::Model>> _models;
+		std::vector<BenchRunResult> _runs;
+		std::vector<BenchFrameResult> _frames;
+
+		bool LoadScene();
+		void RunTechnique(const std::string& technique, const BenchResolution& resolution);
+		// Places both eyes at the given frame of the path for the current resolution
+		void ApplyCameras(uint64_t frame, const BenchResolution& resolution);
+	};
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace stereorizer::bench
+{
+	// Head pose in world space, angles in degrees with the Camera conventions (yaw -90 looks down -Z)
+	struct HeadPose {
+		glm::vec3 position = glm::vec3(0.0f);
+		float yaw = -90.0f;
+		float pitch = 0.0f;
+	};
+
+	// Head motion for scripted runs. Either keyframes sampled by time (Catmull-Rom on the position,
+	// linear on the angles) or a recorded trace with one pose per frame that is replayed verbatim.
+	//
+	// Text format, one entry per line, '#' starts a comment:
+	//   key <time> <x> <y> <z> <yaw> <pitch>	keyframe, times strictly increasing
+	//   pose <x> <y> <z> <yaw> <pitch>		trace sample of the next frame
+	class CameraPath {
+	public:
+		bool Load(const std::string& path);
+
+		void AddKeyframe(float time, const HeadPose& pose);
+		void AddTraceSample(const HeadPose& pose);
+
+		bool IsEmpty() const { return _keys.empty() && _trace.empty(); }
+		bool IsTrace() const { return !_trace.empty(); }
+		// Seconds covered by the keyframes, trace length is in frames
+		float GetDuration() const { return _keys.empty() ? 0.0f : _keys.back().time; }
+		size_t GetTraceLength() const { return _trace.size(); }
+
+		// Pose at the given frame of a run stepping timestep seconds per frame. Traces hold their
+		// last sample past the end, keyframes their last key.
+		HeadPose Sample(uint64_t frame, float timestep) const;
+
+		// Parallel eye views around the head, ipd in meters
+		static void GetEyeViews(const HeadPose& head, float ipd, glm::mat4& leftView, glm::mat4& rightView);
+
+	private:
+		struct Keyframe {
+			float time;
+			HeadPose pose;
+		};
+
+		std::vector<Keyframe> _keys;
+		std::vector<HeadPose> _trace;
+
+		HeadPose SampleKeyframes(float time) const;
+	};
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// CPU scope instrumentation, compiled in only with STEREORIZER_ENABLE_PROFILING.
+// Without it the macros expand to nothing, so instrumented code carries no overhead.
+//   PROFILE_SCOPE("name")  times the enclosing block, the name must be a string literal
+//   PROFILE_FUNCTION()     same, named after the enclosing function
+//   PROFILE_FRAME_END()    marks the end of a frame for N-frame captures
+#if defined(STEREORIZER_ENABLE_PROFILING)
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ::stereorizer::core::CpuScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_FRAME_END() ::stereorizer::core::CpuProfiler::Get().EndFrame()
+#else
+#define PROFILE_SCOPE(name) do {} while(0)
+#define PROFILE_FUNCTION() do {} while(0)
+#define PROFILE_FRAME_END() do {} while(0)
+#endif
+
+namespace stereorizer::core
+{
+	// Records CPU scopes of every thread during a capture of N frames and writes them as a
+	// Chrome trace_event JSON file (load it in chrome://tracing or Perfetto). Each thread appends
+	// to its own fixed-size buffer, publishing events with a release store of the count, so
+	// recording takes no lock; the buffer list itself is only locked when a thread registers.
+	class CpuProfiler {
+	public:
+		static constexpr size_t EventsPerThread = 1 << 16;
+
+		static CpuProfiler& Get();
+		static constexpr bool IsCompiledIn() {
+#if defined(STEREORIZER_ENABLE_PROFILING)
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		// Starts recording, the trace is written to path after frameCount PROFILE_FRAME_END()s
+		void BeginCapture(int frameCount, const std::string& path);
+		bool IsCapturing() const { return _capturing.load(std::memory_order_relaxed); }
+		int GetRemainingFrames() const { return _remainingFrames; }
+		void EndFrame();
+
+		// Called by CpuScope
+		void Record(const char* name, uint64_t startNs, uint64_t endNs);
+		static uint64_t NowNs();
+
+	private:
+		struct Event {
+			const char* name;
+			uint64_t startNs;
+			uint64_t endNs;
+		};
+
+		struct ThreadBuffer {
+			uint32_t threadId = 0;
+			std::atomic<uint32_t> generation{ 0 };	// capture the events belong to, only written by the owning thread
+			std::atomic<size_t> count{ 0 };
+			std::atomic<size_t> dropped{ 0 };
+			std::unique_ptr<Event[]> events{ new Event[EventsPerThread] };
+		};
+
+		std::atomic<bool> _capturing{ false };
+		std::atomic<uint32_t> _generation{ 0 };
+		uint64_t _captureStartNs = 0;
+		int _remainingFrames = 0;
+		std::string _capturePath;
+
+		std::mutex _buffersMutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> _buffers;
+
+		CpuProfiler() = default;
+		ThreadBuffer& GetThreadBuffer();
+		bool WriteTrace(const std::string& path);
+	};
+
+	class CpuScope {
+	public:
+		explicit CpuScope(const char* name) : _name(name) {
+			if (CpuProfiler::Get().IsCapturing())
+				_startNs = CpuProfiler::NowNs();
+		}
+		~CpuScope() {
+			if (_startNs != 0)
+				CpuProfiler::Get().Record(_name, _startNs, CpuProfiler::NowNs());
+		}
+
+		CpuScope(const CpuScope&) = delete;
+		CpuScope& operator=(const CpuScope&) = delete;
+
+	private:
+		const char* _name;
+		uint64_t _startNs = 0;
+	};
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace stereorizer::core
+{
+	// How close the pacer wakes up to its deadlines, all times in microseconds
+	struct FramePacingStats {
+		uint64_t frames = 0;
+		uint64_t missedDeadlines = 0;	// frames that were already a full period late, the schedule was re-anchored
+		double lastErrorUs = 0.0;
+		double meanErrorUs = 0.0;
+		double maxErrorUs = 0.0;
+	};
+
+	// Portable frame limiter. Deadlines are absolute (anchor + n * period) so wake-up errors
+	// don't accumulate into drift. Waits sleep coarsely until shortly before the deadline and
+	// spin on steady_clock for the rest; the spin margin adapts to how much the OS oversleeps.
+	// On Windows the sleep goes through a high resolution waitable timer, Sleep alone would
+	// overshoot MaxSleepSlack.
+	class FramePacer {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static constexpr std::chrono::microseconds MinSleepSlack{ 200 };
+		static constexpr std::chrono::microseconds MaxSleepSlack{ 4000 };
+
+		// fps <= 0 disables pacing
+		void SetTargetFPS(float fps);
+		float GetTargetFPS() const { return _targetFPS; }
+
+		// Blocks until the next deadline, call once per frame
+		void WaitForNextFrame();
+		// Drops the schedule, the next wait starts a new one (e.g. after a stall or a mode switch)
+		void Reset();
+
+		const FramePacingStats& GetStats() const { return _stats; }
+		void ResetStats() { _stats = {}; }
+
+	private:
+		float _targetFPS = 60.0f;
+		Clock::duration _period = Clock::duration::zero();
+		Clock::time_point _nextDeadline;
+		bool _scheduled = false;
+		Clock::duration _sleepSlack = std::chrono::microseconds(1000);
+		FramePacingStats _stats;
+
+		void SleepUntil(Clock::time_point deadline);
+		void RecordError(Clock::duration error);
+	};
+}
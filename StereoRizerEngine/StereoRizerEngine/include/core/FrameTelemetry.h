@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace stereorizer::core
+{
+	// HDR-histogram style latency buckets over microseconds: exact below 2 * SubBucketCount,
+	// then SubBucketCount linear buckets per power of two (~3% relative precision) up to
+	// 2^MaxValueBits us. Recording is a relaxed atomic increment, so any thread may record or read.
+	class LatencyHistogram {
+	public:
+		static constexpr int SubBucketBits = 5;
+		static constexpr int SubBucketCount = 1 << SubBucketBits;
+		static constexpr int MaxValueBits = 27;		// ~134 s
+		static constexpr int BucketCount = (MaxValueBits - SubBucketBits) * SubBucketCount + SubBucketCount;
+
+		void Record(double ms);
+		void Reset();
+
+		uint64_t GetCount() const { return _count.load(std::memory_order_relaxed); }
+		double GetMaxMs() const { return (double)_maxUs.load(std::memory_order_relaxed) / 1000.0; }
+		double GetMeanMs() const;
+		// Upper edge of the bucket holding the given fraction (0-1) of the samples
+		double GetPercentileMs(double fraction) const;
+
+	private:
+		std::atomic<uint32_t> _buckets[BucketCount] = {};
+		std::atomic<uint64_t> _count{ 0 };
+		std::atomic<uint64_t> _sumUs{ 0 };
+		std::atomic<uint64_t> _maxUs{ 0 };
+
+		static int BucketIndex(uint64_t us);
+		static uint64_t BucketUpperEdge(int index);
+	};
+
+	struct FrameTimeSummary {
+		uint64_t frames = 0;
+		double meanMs = 0.0;
+		double p50Ms = 0.0;
+		double p95Ms = 0.0;
+		double p99Ms = 0.0;
+		double maxMs = 0.0;
+	};
+
+	struct FrameSample {
+		uint64_t frame = 0;
+		float cpuMs = 0.0f;
+		float gpuMs = -1.0f;		// negative until the GPU timing of the frame came back
+		float intervalMs = 0.0f;	// wall time since the previous frame ended
+	};
+
+	// Per-frame CPU/GPU times and frame intervals. The render thread is the only writer;
+	// the histograms are atomics and the history slots seqlocks, so other threads (or a
+	// benchmark driver) can read them at any time without locking. GPU times arrive a few frames late and are
+	// matched to their frame by number.
+	class FrameTelemetry {
+	public:
+		static constexpr size_t HistorySize = 512;
+		// A frame whose interval exceeds this many target intervals skipped at least one refresh
+		static constexpr double MissedIntervalFactor = 1.5;
+
+		// 0 disables missed-frame counting
+		void SetTargetIntervalMs(double ms) { _targetIntervalMs.store(ms, std::memory_order_relaxed); }
+		double GetTargetIntervalMs() const { return _targetIntervalMs.load(std::memory_order_relaxed); }
+
+		void RecordFrame(uint64_t frame, double cpuMs, double intervalMs);
+		void RecordGpuTime(uint64_t frame, double gpuMs);
+		void Reset();
+
+		FrameTimeSummary GetCpuSummary() const { return Summarize(_cpu); }
+		FrameTimeSummary GetGpuSummary() const { return Summarize(_gpu); }
+		FrameTimeSummary GetIntervalSummary() const { return Summarize(_interval); }
+		uint64_t GetMissedFrames() const { return _missedFrames.load(std::memory_order_relaxed); }
+
+		// Up to HistorySize most recent frames, oldest first
+		std::vector<FrameSample> GetHistory() const;
+
+	private:
+		// sequence is odd while the writer updates the slot; a reader retries until it read the
+		// fields between two equal even values
+		struct Slot {
+			std::atomic<uint32_t> sequence{ 0 };
+			std::atomic<uint64_t> frame{ UINT64_MAX };
+			std::atomic<float> cpuMs{ 0.0f };
+			std::atomic<float> gpuMs{ -1.0f };
+			std::atomic<float> intervalMs{ 0.0f };
+		};
+
+		Slot _history[HistorySize];
+		std::atomic<uint64_t> _missedFrames{ 0 };
+		std::atomic<double> _targetIntervalMs{ 0.0 };
+		LatencyHistogram _cpu;
+		LatencyHistogram _gpu;
+		LatencyHistogram _interval;
+
+		static FrameTimeSummary Summarize(const LatencyHistogram& histogram);
+		static void BeginWrite(Slot& slot);
+		static void EndWrite(Slot& slot);
+		// False when the slot holds no frame
+		static bool ReadSlot(const Slot& slot, FrameSample& sample);
+	};
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "core/Surface.h"
+
+namespace stereorizer::core
+{
+	class GlfwSurface : public Surface {
+	public:
+		GlfwSurface() = default;
+		~GlfwSurface() override;
+
+		bool Init(int width, int height, const char* title) override;
+		void MakeCurrent() override;
+		void PollEvents() override;
+		void SwapBuffers() override;
+
+		bool ShouldClose() const override;
+		void RequestClose() override;
+
+		void GetFramebufferSize(int& width, int& height) const override;
+		void SetSize(int width, int height) override;
+
+		GLuint GetPresentFramebuffer() const override { return 0; }
+		bool IsHeadless() const override { return false; }
+		GLFWwindow* GetGlfwWindow() const override { return _window; }
+
+	private:
+		GLFWwindow* _window = nullptr;
+	};
+}
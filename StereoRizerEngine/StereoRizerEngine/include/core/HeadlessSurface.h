@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+#include "core/Surface.h"
+
+namespace stereorizer::core
+{
+	// GL 4.5 core context without a display through EGL on the Mesa surfaceless platform
+	// (llvmpipe works), so the full pipeline runs on machines without a GPU or X server.
+	// The frame is presented into an offscreen RGBA8 + depth/stencil framebuffer that can
+	// be read back with ReadPixels. Other platforms borrow the context of a hidden GLFW window.
+	class HeadlessSurface : public Surface {
+	public:
+		HeadlessSurface() = default;
+		~HeadlessSurface() override;
+
+		HeadlessSurface(const HeadlessSurface&) = delete;
+		HeadlessSurface& operator=(const HeadlessSurface&) = delete;
+
+		bool Init(int width, int height, const char* title) override;
+		void MakeCurrent() override;
+		void PollEvents() override {}
+		// Nothing to present, only flushes so the GPU keeps working while the CPU records
+		void SwapBuffers() override;
+
+		bool ShouldClose() const override { return _closeRequested; }
+		void RequestClose() override { _closeRequested = true; }
+
+		void GetFramebufferSize(int& width, int& height) const override;
+		void SetSize(int width, int height) override;
+
+		GLuint GetPresentFramebuffer() const override { return _framebuffer; }
+		bool IsHeadless() const override { return true; }
+
+		// Tightly packed RGBA8 rows of the present framebuffer, bottom row first
+		bool ReadPixels(std::vector<unsigned char>& pixels) const;
+
+	private:
+		void* _display = nullptr;	// EGLDisplay
+		void* _context = nullptr;	// EGLContext, or the hidden GLFWwindow
+		GLuint _framebuffer = 0;
+		GLuint _colorBuffer = 0;
+		GLuint _depthStencilBuffer = 0;
+		int _width = 0;
+		int _height = 0;
+		bool _closeRequested = false;
+
+		bool CreateContext();
+		void CreateFramebuffer();
+		void DeleteFramebuffer();
+	};
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace stereorizer::core
+{
+	// Read-only memory mapping of a whole file. Pages come in on first touch, so handing a range
+	// of it to the driver is the only copy the data ever sees.
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		// False (and closed) when the file is missing, empty or can't be mapped
+		bool Open(const std::string& path);
+		void Close();
+
+		bool IsOpen() const { return _data != nullptr; }
+		const uint8_t* GetData() const { return _data; }
+		size_t GetSize() const { return _size; }
+
+	private:
+		const uint8_t* _data = nullptr;
+		size_t _size = 0;
+#ifdef _WIN32
+		void* _file = nullptr;
+		void* _mapping = nullptr;
+#endif
+	};
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <GL/glew.h>
+
+struct GLFWwindow;
+
+namespace stereorizer::core
+{
+	enum class SurfaceBackend {
+		Glfw,		// On-screen window with input, ImGui and optional OpenXR
+		Headless	// GL context without a display, the frame ends up in an offscreen framebuffer
+	};
+
+	// Owns the GL context and whatever the frame is presented to. Window drives the
+	// render loop through this interface and never talks to the platform directly.
+	class Surface {
+	public:
+		virtual ~Surface() = default;
+
+		static std::unique_ptr<Surface> Create(SurfaceBackend backend);
+
+		// Creates the surface, makes a GL 4.5 core context current on the calling thread and loads
+		// the GL entry points
+		virtual bool Init(int width, int height, const char* title) = 0;
+		virtual void MakeCurrent() = 0;
+		virtual void PollEvents() = 0;
+		virtual void SwapBuffers() = 0;
+
+		virtual bool ShouldClose() const = 0;
+		virtual void RequestClose() = 0;
+
+		virtual void GetFramebufferSize(int& width, int& height) const = 0;
+		virtual void SetSize(int width, int height) = 0;
+
+		// Where the final image is drawn: 0 for a window, an offscreen FBO when headless
+		virtual GLuint GetPresentFramebuffer() const = 0;
+		virtual bool IsHeadless() const = 0;
+
+		// Native window for input and ImGui, nullptr when there is none
+		virtual GLFWwindow* GetGlfwWindow() const { return nullptr; }
+	};
+}
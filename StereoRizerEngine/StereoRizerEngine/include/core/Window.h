@@ -3,53 +3,65 @@
 
 #include <iostream>
 
-#define WIN32_LEAN_AND_MEAN
-#include <Windows.h>
-#include <unknwn.h>
-
 #include <GL/glew.h>
-#include <GLFW/glfw3.h>
-
-#define XR_USE_GRAPHICS_API_OPENGL
-#define XR_USE_PLATFORM_WIN32
-#include "openxr/openxr.h"
-#include "openxr/openxr_platform.h"
 
+#include "core/Surface.h"
 #include "graphics/Renderer.h"
 #include "graphics/Light.h"
-#include "graphics/GfxAPIUtils.h"
 #include "graphics/Shader.h"
-#include "xr/OpenXRSupport.h"
+#include "graphics/StereoRenderTarget.h"
+#include "graphics/FrameUniformBuffer.h"
+#include "graphics/FrameRing.h"
+#include "graphics/GpuProfiler.h"
+#include "graphics/AssetLoader.h"
+#include "graphics/MeshManager.h"
+#include "graphics/StereoTechnique.h"
+#include "core/FramePacer.h"
+#include "core/FrameTelemetry.h"
 #include <vector>
 #include <algorithm>
 #include <memory>
 #include <functional>
-#include <vector>
-#include <algorithm>
+#include <string>
+#include <unordered_map>
 
-// ImGui includes
-#include <imgui.h>
-#include <imgui_impl_glfw.h>
-#include <imgui_impl_opengl3.h>
+namespace stereorizer::xr
+{
+	class OpenXRSupport;
+}
 
 namespace stereorizer::core
 {
+	// What is presented of each eye, how the eyes are produced is the stereo technique's business
 	enum class ViewDisplayMode {
 		Color,
-		Depth,
-		ReprojectionMask
+		Depth
 	};
 
 	class Window
 	{
 	public:
-		Window(int width, int height, const char* title);
+		// Headless runs the same pipeline without a display, no input, ImGui or OpenXR
+		Window(int width, int height, const char* title, SurfaceBackend backend = SurfaceBackend::Glfw);
 		~Window();
 
 		void Destroy();
 		void PollEvents();
 		void SwapBuffers();
 		void Run();
+		// One iteration of Run(), for drivers that own the loop (benchmarks, captures)
+		void RenderFrame();
+
+		// Run() returns after this many frames, 0 runs until the surface closes
+		void SetFrameLimit(uint64_t frames) { _frameLimit = frames; }
+		// Every frame advances time by this many seconds instead of reading the clock, 0 restores the clock
+		void SetFixedTimestep(float seconds) { _fixedTimestep = seconds; }
+		// Number the next frame gets, the same numbering GpuProfiler and FrameTelemetry report
+		uint64_t GetFrameNumber() const { return _frameNumber; }
+		bool IsHeadless() const { return _surface && _surface->IsHeadless(); }
+		// False when the surface or its GL context couldn't be created
+		bool IsReady() const { return _surfaceReady; }
+		Surface* GetSurface() const { return _surface.get(); }
 
 		// Manage scene models owned by the application (Window stores non-owning pointers)
 		void AddModel(std::shared_ptr<stereorizer::graphics::Model> model);
@@ -61,6 +73,11 @@ namespace stereorizer::core
 
 		int GetWidth() const;
 		int GetHeight() const;
+		// Resizes the surface, the eye targets follow on the next frame
+		void SetSize(int width, int height);
+
+		std::shared_ptr<stereorizer::graphics::Camera> GetLeftCamera() const;
+		std::shared_ptr<stereorizer::graphics::Camera> GetRightCamera() const;
 
 		// IPD accessors
 		float GetIPD() const;
@@ -77,25 +94,56 @@ namespace stereorizer::core
 		GLuint GetRightViewDepthTexture() const;
 		GLuint GetRightViewColorTexture() const;
 
+		// Stereo technique by registry name (see graphics::StereoTechniqueRegistry), false and
+		// unchanged when the name is unknown or the technique isn't supported by this GL
+		bool SetStereoTechnique(const std::string& name);
+		const std::string& GetStereoTechniqueName() const { return _stereoTechniqueName; }
+		stereorizer::graphics::IStereoTechnique* GetStereoTechnique() const { return _stereoTechnique; }
+
 		// FPS control
 		void SetTargetFPS(float targetFPS);
 		float GetTargetFPS() const;
 		float GetCurrentFPS() const;
 
+		// Per-frame CPU/GPU times, percentiles and missed frames
+		const FrameTelemetry& GetFrameTelemetry() const;
+		stereorizer::graphics::GpuProfiler* GetGpuProfiler() const { return _gpuProfiler.get(); }
+		// Streams meshes in the background, pumped once per frame. Null without a GL surface.
+		stereorizer::graphics::AssetLoader* GetAssetLoader() const { return _assetLoader.get(); }
+		// Shared meshes by path, scenes acquire theirs here rather than loading duplicates
+		stereorizer::graphics::MeshManager* GetMeshManager() const { return _meshManager.get(); }
+		// Share of right-eye pixels the active technique reused from the left eye rather than shaded
+		float GetPixelReuseRatio() const;
+
+		// How many frames the CPU may run ahead of the GPU (1-3)
+		void SetFramesInFlight(int count);
+		int GetFramesInFlight() const;
+		// Time the last frame blocked on the fence of the frame slot it reused
+		double GetLastFenceWaitMs() const;
+
 	private:
 		int _width;
 		int _height;
 		const char* _title;
-		// GLFW windows must be destroyed with glfwDestroyWindow; use unique_ptr with custom deleter
-		// use std::function deleter so unique_ptr is default-constructible
-		std::unique_ptr<GLFWwindow, std::function<void(GLFWwindow*)>> _window;
+		std::unique_ptr<Surface> _surface;
+		bool _surfaceReady = false;
+		uint64_t _frameLimit = 0;
+		float _fixedTimestep = 0.0f;
 		std::unique_ptr<stereorizer::graphics::Renderer> _leftRenderer;
 		std::unique_ptr<stereorizer::graphics::Renderer> _rightRenderer;
+		std::unique_ptr<stereorizer::graphics::StereoRenderTarget> _stereoTarget;
+		std::unique_ptr<stereorizer::graphics::FrameUniformBuffer> _frameUniforms;
+		std::unique_ptr<stereorizer::graphics::FrameRing> _frameRing;
+		std::unique_ptr<stereorizer::graphics::GpuProfiler> _gpuProfiler;
+		std::unique_ptr<stereorizer::graphics::AssetLoader> _assetLoader;
+		std::unique_ptr<stereorizer::graphics::MeshManager> _meshManager;
 		std::vector<std::shared_ptr<stereorizer::graphics::Model>> _models;
 		std::shared_ptr<stereorizer::graphics::Light> _sceneLight;
 		bool UpdateXRViews();
-		void RenderModelsLeft();
-		void RenderModelsRight();
+		void UpdateFrameData();
+		void PresentViews();
+		// Registered technique by name, created on first use
+		stereorizer::graphics::IStereoTechnique* FindStereoTechnique(const std::string& name);
 		void InitResources();
 		void RenderImGui();
 		void handleMouseInput();
@@ -107,9 +155,15 @@ namespace stereorizer::core
 		float deltaTime = 0.0f;
 		float currentFrame = 0.0f;
 		float lastFrame = 0.0f;
+		std::chrono::steady_clock::time_point _startTime = std::chrono::steady_clock::now();
 		
 		// FPS control
-		float _targetFPS = 60.0f;
+		FramePacer _framePacer;
+		int _traceFrameCount = 120;
+		FrameTelemetry _frameTelemetry;
+		uint64_t _frameNumber = 0;
+		uint64_t _lastGpuFrameReported = UINT64_MAX;
+		std::chrono::steady_clock::time_point _lastFrameEnd;
 		float _currentFPS = 0.0f;
 		float _frameTimeAccumulator = 0.0f;
 		int _frameCount = 0;
@@ -121,14 +175,16 @@ namespace stereorizer::core
 		bool firstMouse = true;
 		float lastX = 0, lastY = 0;
 
-		stereorizer::xr::OpenXRSupport _xrSupport;
-		GraphicsAPI_Type m_apiType = GraphicsAPI_Type::OpenGL;
+		std::unique_ptr<stereorizer::xr::OpenXRSupport> _xrSupport;
 		
 		// Depth texture state
 		ViewDisplayMode _leftViewDisplayMode = ViewDisplayMode::Color;
 		ViewDisplayMode _rightViewDisplayMode = ViewDisplayMode::Color;
 
-		std::shared_ptr<stereorizer::graphics::Shader> _reprojectionShader = nullptr;
-		std::shared_ptr<stereorizer::graphics::Shader> _standardShader = nullptr;
+		// Created on first selection and kept, switching back doesn't lose their targets or settings
+		std::unordered_map<std::string, std::unique_ptr<stereorizer::graphics::IStereoTechnique>> _stereoTechniques;
+		stereorizer::graphics::IStereoTechnique* _stereoTechnique = nullptr;
+		std::string _stereoTechniqueName;
+		stereorizer::graphics::StereoTargets _stereoTargets;
 	};
 }
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace stereorizer::core
+{
+	// Fixed set of worker threads for short CPU jobs of the frame and longer background tasks such
+	// as asset imports. No GL context on any of them, everything they produce is handed back to
+	// the GL thread.
+	class WorkerPool {
+	public:
+		// fn(begin, end, slot): slot 0 is the calling thread, workers are 1..GetSlotCount() - 1
+		using RangeJob = std::function<void(size_t begin, size_t end, unsigned slot)>;
+
+		static WorkerPool& Get();
+
+		// threadCount 0 picks one less than the hardware threads, the caller being the last one
+		explicit WorkerPool(unsigned threadCount = 0);
+		~WorkerPool();
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		// Distinct slots a RangeJob can see, size per-thread buckets with this
+		unsigned GetSlotCount() const { return (unsigned)_threads.size() + 1; }
+
+		// Runs job over [0, count) in chunks of at least minChunk and returns once all of them are
+		// done. The caller takes chunks too, so a busy pool only makes it slower, never stuck.
+		// Two chunks never run on the same slot at once, as long as only one thread calls this.
+		void ParallelFor(size_t count, size_t minChunk, const RangeJob& job);
+
+		// Queues task to run once on some worker and returns right away. Tasks run in submission
+		// order as workers free up. Without workers (single core) it runs right away on the caller.
+		void Submit(std::function<void()> task);
+
+	private:
+		std::vector<std::thread> _threads;
+		std::mutex _mutex;
+		std::condition_variable _wake;
+		std::deque<std::function<void(unsigned)>> _tasks;
+		bool _stopping = false;
+
+		void WorkerLoop(unsigned slot);
+	};
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "Mesh.h"
+#include "StagingBuffer.h"
+
+namespace stereorizer::graphics
+{
+	// A mesh on its way in. mesh is usable right away (it draws the loader's placeholder until its
+	// data is uploaded); uploaded becomes ready once the upload was issued, true on success.
+	struct MeshHandle {
+		std::shared_ptr<Mesh> mesh;
+		std::shared_future<bool> uploaded;
+
+		bool IsReady() const { return uploaded.valid() && uploaded.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+	};
+
+	struct AssetLoaderStats {
+		size_t loading = 0;			// submitted, still importing or mapping on a worker
+		size_t waitingUpload = 0;	// loaded, waiting for room in the staging ring
+		size_t uploaded = 0;		// since creation
+		size_t failed = 0;
+		uint64_t stagedBytes = 0;	// since creation
+		double lastUploadMs = 0.0;	// CPU time of the last Update
+	};
+
+	// Loads meshes off the GL thread. Imports and cache reads run on the WorkerPool; what they
+	// produce is uploaded on the GL thread in Update, through a persistently mapped staging ring
+	// whose batches are fenced, so a frame never waits for a copy. Scenes add models with the
+	// handle's mesh right away and render the placeholder box until the real data arrives.
+	// The loader owns GL objects: create and destroy it with a current context, GL thread only.
+	class AssetLoader {
+	public:
+		static constexpr size_t StagingSize = 32u << 20;
+		// Bytes handed to the GPU per Update, keeps a burst of finished loads from costing one frame
+		// all of it. A single larger mesh still goes in one Update.
+		static constexpr size_t UploadBudget = 8u << 20;
+
+		AssetLoader();
+		~AssetLoader();
+
+		AssetLoader(const AssetLoader&) = delete;
+		AssetLoader& operator=(const AssetLoader&) = delete;
+
+		// Queues the load of path and returns at once (unless the pool has no workers). Waiting on
+		// the handle's future from the GL thread never returns, use Finish there.
+		MeshHandle LoadMesh(const std::string& path, const MeshImportOptions& options = {});
+
+		// Once per frame: uploads the loads that finished as far as the budget and staging allow
+		void Update();
+		// Blocks until every queued load is uploaded, e.g. before a benchmark starts measuring
+		void Finish();
+
+		bool IsIdle() const { return _loading.empty() && _uploads.empty(); }
+		const AssetLoaderStats& GetStats() const { return _stats; }
+
+	private:
+		// What a worker touches. GL objects stay out of it, a task outliving the loader must not
+		// be the one to destroy them.
+		struct LoadJob {
+			std::string path;
+			MeshImportOptions options;
+			MeshData data;
+			bool loaded = false;
+		};
+
+		// GL thread side of a job
+		struct Request {
+			std::shared_ptr<LoadJob> job;
+			std::shared_ptr<Mesh> mesh;
+			std::promise<bool> uploaded;
+		};
+
+		// Shared with the worker tasks, which may outlive the loader
+		struct Completions {
+			std::mutex mutex;
+			std::condition_variable ready;
+			std::deque<std::shared_ptr<LoadJob>> jobs;
+		};
+
+		std::shared_ptr<Completions> _completions;
+		std::unordered_map<const LoadJob*, Request> _loading;
+		std::deque<Request> _uploads;
+		StagingBuffer _staging;
+		std::shared_ptr<Mesh> _placeholder;
+		AssetLoaderStats _stats;
+
+		// Moves finished loads over to _uploads, waiting for one when wait is set and none is done
+		void CollectCompleted(bool wait);
+		// Uploads queued requests, wait blocks on staging instead of leaving them for later
+		void UploadQueued(bool wait);
+	};
+}
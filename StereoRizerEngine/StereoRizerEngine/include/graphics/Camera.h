@@ -41,6 +41,8 @@ namespace stereorizer::graphics
 		// Shader uniform upload
 		void UploadToShader(std::shared_ptr<Shader> shader) const;
 		void UploadToReprojectionShader(std::shared_ptr<Shader> shader) const;
+		// Uploads both eyes as viewMatrix[2]/projectionMatrix[2] for the single-pass stereo shaders
+		static void UploadStereoToShader(std::shared_ptr<Shader> shader, const Camera& left, const Camera& right);
 
 	private:
 		float _FOV;
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <GL/glew.h>
+
+#include "Shader.h"
+
+namespace stereorizer::graphics
+{
+	// Hierarchical min/max depth (Hi-Z) of a depth texture: an RG32F mip chain where every texel
+	// holds the nearest (r) and farthest (g) depth of the block of level 0 texels it covers.
+	// Built with one compute dispatch per level.
+	class DepthPyramid {
+	public:
+		// Level whose texels (8x8 blocks) reprojection tests before any full resolution fetch
+		static constexpr int BlockTestLevel = 3;
+		// GPU budget of a build at 2x the recommended XR resolution. A build measured over it
+		// suspends the pyramid for OverBudgetSkipBuilds builds, then the next one is timed again;
+		// meanwhile reprojection fetches full resolution depth and culling is skipped.
+		static constexpr double BuildBudgetMs = 0.25;
+		static constexpr int OverBudgetSkipBuilds = 30;
+
+		DepthPyramid();
+		~DepthPyramid();
+
+		DepthPyramid(const DepthPyramid&) = delete;
+		DepthPyramid& operator=(const DepthPyramid&) = delete;
+
+		// holesAsFar treats negative depths (forward reprojection holes) as the far plane. False, and
+		// the pyramid invalid, when it failed or is suspended for being over budget.
+		bool Build(GLuint depthTexture, int width, int height, bool holesAsFar = false);
+
+		GLuint GetTexture() const { return _texture; }
+		int GetLevelCount() const { return _levelCount; }
+		int GetWidth() const { return _width; }
+		int GetHeight() const { return _height; }
+		bool IsValid() const { return _texture != 0 && _built; }
+
+		// GPU time of the most recent build whose result is available, -1 until then
+		double GetLastBuildTimeMs() const { return _lastBuildTimeMs; }
+		bool IsOverBudget() const { return _skipBuilds > 0; }
+
+	private:
+		std::shared_ptr<Shader> _shader = nullptr;
+		GLuint _texture = 0;
+		int _levelCount = 0;
+		int _width = 0;
+		int _height = 0;
+		bool _built = false;
+
+		// Two timer queries alternate so reading one never waits on the build just issued
+		GLuint _timerQueries[2] = { 0, 0 };
+		bool _timerPending[2] = { false, false };
+		int _timerIndex = 0;
+		double _lastBuildTimeMs = -1.0;
+		int _skipBuilds = 0;
+
+		bool CreateResources(int width, int height);
+		void DeleteResources();
+		void ReadBuildTime(int index);
+	};
+}
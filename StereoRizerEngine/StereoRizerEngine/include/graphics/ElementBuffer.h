@@ -11,7 +11,23 @@ namespace stereorizer::graphics
 		GLuint id;
 	public:
 		const int indicesSize;
+		// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		const GLenum indexType;
+
+		// Stored as 16-bit indices whenever every index fits
 		ElementBuffer(const std::vector<uint32_t>& indices, BufferAccessType accessType, BufferCallType callType);
+		// Immutable storage filled straight from indices, e.g. a mapped file. Null indices leave
+		// it undefined, to be filled by a buffer copy.
+		ElementBuffer(const uint32_t* indices, size_t count);
+		// Same, indices of indexType
+		ElementBuffer(const void* indices, size_t count, GLenum indexType);
 		~ElementBuffer();
+
+		GLuint getId() const { return id; }
+		// Bytes per index
+		uint32_t indexBytes() const { return indexType == GL_UNSIGNED_SHORT ? 2 : 4; }
+
+		// Smallest type that can address vertexCount vertices
+		static GLenum indexTypeFor(size_t vertexCount) { return vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT; }
 	};
 }
\ No newline at end of file
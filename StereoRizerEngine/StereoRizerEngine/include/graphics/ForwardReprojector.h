@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+#include <GL/glew.h>
+
+#include "Shader.h"
+
+namespace stereorizer::graphics
+{
+	struct ForwardReprojectionStats {
+		int filledPixels = 0;	// Cracks closed by dilation
+		int holePixels = 0;		// Left for the geometric re-render
+	};
+
+	// Geometry-free right eye: scatters the left eye's color and depth into the right view with an
+	// atomicMin depth resolve (depth pass, then color pass), closes cracks up to the fill radius by
+	// depth-aware dilation and marks whatever stays empty as a hole.
+	class ForwardReprojector {
+	public:
+		// Matches the compute work group size, injected into the shader as GROUP_SIZE
+		static constexpr int GroupSize = 16;
+		static constexpr int MaxFillRadius = 4;
+
+		ForwardReprojector();
+		~ForwardReprojector();
+
+		ForwardReprojector(const ForwardReprojector&) = delete;
+		ForwardReprojector& operator=(const ForwardReprojector&) = delete;
+
+		// Gaps up to 2 * radius + 1 pixels wide are filled, wider ones are flagged as holes
+		void SetFillRadius(int radius);
+		int GetFillRadius() const { return _fillRadius; }
+
+		// Writes the reprojected image into rightColorTexture. Left and right views share width x height.
+		bool Reproject(GLuint leftColorTexture, GLuint leftDepthTexture, GLuint rightColorTexture, int width, int height);
+
+		// R32F window depth of every right pixel, negative where a hole is left
+		GLuint GetResolvedDepthTexture() const { return _resolvedDepth; }
+		// Counters of the previous Reproject, read back one frame late to avoid a stall
+		const ForwardReprojectionStats& GetStats() const { return _stats; }
+
+	private:
+		std::shared_ptr<Shader> _shader = nullptr;
+		GLuint _scatterDepth = 0;	// R32UI, float bits of the nearest scattered depth
+		GLuint _scatterColor = 0;
+		GLuint _resolvedDepth = 0;
+		GLuint _counterBuffer = 0;
+		GLsync _countersFence = nullptr;	// set once the dispatch writing the counters is submitted
+		int _width = 0;
+		int _height = 0;
+		int _fillRadius = 1;
+		ForwardReprojectionStats _stats;
+
+		bool CreateResources(int width, int height);
+		void DeleteResources();
+		void Dispatch(const char* stage, int width, int height);
+		void ReadCounters();
+	};
+}
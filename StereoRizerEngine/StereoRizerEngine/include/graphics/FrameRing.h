@@ -0,0 +1,41 @@
+#pragma once
+
+#include <GL/glew.h>
+
+namespace stereorizer::graphics
+{
+	// Bounds how many frames the CPU may queue ahead of the GPU. Every frame in flight owns a slot
+	// guarded by a fence, and the CPU only waits when it is about to reuse a slot whose frame the
+	// GPU has not finished yet. Per-frame resources (e.g. FrameUniformBuffer) are indexed by slot.
+	class FrameRing {
+	public:
+		static constexpr int MaxFramesInFlight = 3;
+
+		FrameRing() = default;
+		~FrameRing();
+
+		FrameRing(const FrameRing&) = delete;
+		FrameRing& operator=(const FrameRing&) = delete;
+
+		// Clamped to [1, MaxFramesInFlight]. Shrinking waits once for the slots that go away.
+		void SetFramesInFlight(int count);
+		int GetFramesInFlight() const { return _framesInFlight; }
+
+		// Moves to the next slot, waiting for its previous frame if it is still in flight
+		int BeginFrame();
+		// Fences the current slot, call once every command of the frame is submitted
+		void EndFrame();
+
+		int GetSlot() const { return _slot; }
+		// Time the CPU blocked in the last BeginFrame
+		double GetLastWaitMs() const { return _lastWaitMs; }
+
+	private:
+		GLsync _fences[MaxFramesInFlight] = { nullptr, nullptr, nullptr };
+		int _framesInFlight = 2;
+		int _slot = 0;
+		double _lastWaitMs = 0.0;
+
+		void WaitForSlot(int slot);
+	};
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Light.h"
+#include "FrameRing.h"
+
+namespace stereorizer::graphics
+{
+	// std140 mirror of the GLSL "FrameData" uniform block. Index 0 is the left eye, 1 the right eye.
+	struct FrameData {
+		glm::mat4 viewMatrix[2];
+		glm::mat4 projectionMatrix[2];
+		glm::mat4 inverseViewMatrix[2];
+		glm::mat4 inverseProjectionMatrix[2];
+		// Maps right-eye clip space straight to left-eye clip space for reprojection
+		glm::mat4 rightClipToLeftClip;
+		// Inverse of the above, for scattering left-eye pixels into the right view
+		glm::mat4 leftClipToRightClip;
+		LightBlock light;
+	};
+	static_assert(sizeof(FrameData) == 10 * sizeof(glm::mat4) + sizeof(LightBlock), "FrameData must match the std140 layout of the FrameData block");
+
+	// Per-frame camera/light data written once per frame into a persistently mapped
+	// buffer with one slot per frame in flight. The FrameRing fences guarantee a slot's
+	// previous frame has retired before it is written again.
+	class FrameUniformBuffer {
+	public:
+		static constexpr int RingSize = FrameRing::MaxFramesInFlight;
+		// Matches "layout(std140, binding = 0) uniform FrameData" in the shaders
+		static constexpr GLuint BindingPoint = 0;
+
+		FrameUniformBuffer();
+		~FrameUniformBuffer();
+
+		FrameUniformBuffer(const FrameUniformBuffer&) = delete;
+		FrameUniformBuffer& operator=(const FrameUniformBuffer&) = delete;
+
+		// Copies the data into the slot returned by FrameRing::BeginFrame and binds it to BindingPoint
+		void Update(const FrameData& data, int slot);
+
+	private:
+		GLuint _buffer = 0;
+		unsigned char* _mapped = nullptr;
+		GLsizeiptr _slotStride = 0;
+
+		void Create();
+	};
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <GL/glew.h>
+
+namespace stereorizer::graphics
+{
+	// Calls that reached the driver vs. calls dropped because the state was already set
+	struct GLStateStats {
+		uint64_t issued = 0;
+		uint64_t skipped = 0;
+	};
+
+	// Shadow copy of the state the engine binds most, restorable without touching the driver
+	struct GLStateSnapshot {
+		static constexpr int TextureUnits = 8;
+
+		GLuint program = 0;
+		GLuint vertexArray = 0;
+		GLuint readFramebuffer = 0;
+		GLuint drawFramebuffer = 0;
+		GLuint activeUnit = 0;
+		GLuint textures2D[TextureUnits] = {};
+		GLuint textures2DArray[TextureUnits] = {};
+		uint32_t enables = 0;
+		GLint viewport[4] = {};
+		GLint scissor[4] = {};
+	};
+
+	// Every program, VAO, framebuffer and texture bind, the common enables, viewport and scissor
+	// of the engine go through here so redundant calls never reach the driver and saving state
+	// never needs a glGet. The shadow is only right while nothing binds behind its back: code
+	// outside the engine (OpenXR, the surface) either restores what it changes, like the ImGui
+	// backend does, or is followed by Invalidate. Objects the cache may have bound are deleted
+	// through it too, GL names get reused and a stale shadow would skip the bind of the new one.
+	// One GL context, GL thread only.
+	class GLStateCache {
+	public:
+		static GLStateCache& Get();
+
+		// Re-reads the real state from the driver, once a context is current and after foreign code
+		void Invalidate();
+		// Rolls the counters, GetLastFrameStats then covers the frame that just ended
+		void BeginFrame();
+		const GLStateStats& GetLastFrameStats() const { return _lastFrame; }
+		const GLStateStats& GetFrameStats() const { return _frame; }
+
+		void UseProgram(GLuint program);
+		void BindVertexArray(GLuint vertexArray);
+		// GL_FRAMEBUFFER binds both the read and the draw framebuffer
+		void BindFramebuffer(GLenum target, GLuint framebuffer);
+		void ActiveTexture(GLuint unit);
+		// GL_TEXTURE_2D and GL_TEXTURE_2D_ARRAY on the first TextureUnits units are tracked, other
+		// targets and units are always issued
+		void BindTexture(GLuint unit, GLenum target, GLuint texture);
+		// On the active unit, for texture creation and uploads
+		void BindTexture(GLenum target, GLuint texture);
+		// GL_DEPTH_TEST, GL_STENCIL_TEST, GL_BLEND, GL_SCISSOR_TEST, GL_CULL_FACE and GL_CLIP_DISTANCE0 are tracked
+		void SetEnabled(GLenum capability, bool enabled);
+		void Enable(GLenum capability) { SetEnabled(capability, true); }
+		void Disable(GLenum capability) { SetEnabled(capability, false); }
+		void Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+		void Scissor(GLint x, GLint y, GLsizei width, GLsizei height);
+
+		GLuint GetProgram() const { return _state.program; }
+		GLuint GetVertexArray() const { return _state.vertexArray; }
+		GLuint GetReadFramebuffer() const { return _state.readFramebuffer; }
+		GLuint GetDrawFramebuffer() const { return _state.drawFramebuffer; }
+		GLuint GetActiveTexture() const { return _state.activeUnit; }
+		bool IsEnabled(GLenum capability) const;
+
+		GLStateSnapshot Save() const { return _state; }
+		// Issues only what differs from the current shadow
+		void Restore(const GLStateSnapshot& snapshot);
+
+		void DeleteTextures(GLsizei count, const GLuint* textures);
+		void DeleteFramebuffers(GLsizei count, const GLuint* framebuffers);
+		void DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays);
+
+	private:
+		GLStateSnapshot _state;
+		GLStateStats _frame;
+		GLStateStats _lastFrame;
+
+		GLStateCache() = default;
+
+		// Bit of a tracked capability in GLStateSnapshot::enables, -1 for untracked ones
+		static int EnableBit(GLenum capability);
+		GLuint* TextureSlot(GLuint unit, GLenum target);
+	};
+}
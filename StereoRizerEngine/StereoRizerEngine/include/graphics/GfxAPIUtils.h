@@ -27,7 +27,7 @@ inline const char* GetGraphicsAPIInstanceExtensionString(GraphicsAPI_Type apiTyp
 #if defined(_WIN32)
         return XR_KHR_OPENGL_ENABLE_EXTENSION_NAME;
 #elif defined(__linux__)
-        return XR_KHR_OPENGL_ENABLE_X11_EXTENSION_NAME; // Or XR_KHR_OPENGL_ENABLE_XCB_EXTENSION_NAME depending on window system
+        return XR_KHR_OPENGL_ENABLE_EXTENSION_NAME; // Same extension, the window system only changes the session binding
 #else
         throw std::runtime_error("OpenGL extension not supported on this platform.");
 #endif
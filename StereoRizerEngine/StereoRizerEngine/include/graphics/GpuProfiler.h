@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+namespace stereorizer::graphics
+{
+	// Rolling GPU time of one named scope, in milliseconds
+	struct GpuScopeStats {
+		std::string name;
+		int depth = 0;		// nesting level, 0 for the frame itself
+		int samples = 0;
+		double lastMs = 0.0;
+		double averageMs = 0.0;
+		double p50Ms = 0.0;
+		double p95Ms = 0.0;
+		double p99Ms = 0.0;
+		double maxMs = 0.0;
+	};
+
+	// Times named render passes with GL_TIMESTAMP queries. Timestamps rather than GL_TIME_ELAPSED
+	// so scopes can nest (and contain passes that run their own elapsed-time query, like the
+	// depth pyramid). Every frame owns a set of queries in a ring of FrameLatency frames; a frame's
+	// results are collected when its set is reused, and dropped rather than waited for if the GPU
+	// is still behind.
+	class GpuProfiler {
+	public:
+		static constexpr int FrameLatency = 4;
+		static constexpr int MaxScopesPerFrame = 32;
+		static constexpr int HistorySize = 240;
+
+		GpuProfiler();
+		~GpuProfiler();
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+		// Opens the implicit "Frame" scope, every other scope must sit between these two
+		void BeginFrame(uint64_t frameNumber);
+		void EndFrame();
+
+		// GPU time of the most recent frame whose results came back, false until there is one
+		bool GetLastFrameTime(uint64_t& frameNumber, double& ms) const;
+
+		// name must outlive the frame, string literals are expected
+		void BeginScope(const char* name);
+		void EndScope();
+
+		void SetEnabled(bool enabled) { _enabled = enabled; }
+		bool IsEnabled() const { return _enabled; }
+
+		// In order of first appearance, which follows the submission order of the passes
+		std::vector<GpuScopeStats> GetStats() const;
+		void ResetHistory() { _history.clear(); }
+		// One row per scope with the same figures as GetStats
+		bool ExportCsv(const std::string& path) const;
+
+	private:
+		struct PendingScope {
+			const char* name;
+			int depth;
+			int beginQuery;
+			int endQuery;
+		};
+
+		struct FrameQueries {
+			GLuint queries[2 * MaxScopesPerFrame] = {};
+			int usedQueries = 0;
+			uint64_t frameNumber = 0;
+			std::vector<PendingScope> scopes;
+		};
+
+		struct ScopeHistory {
+			std::string name;
+			int depth = 0;
+			std::vector<double> samples;	// ring of HistorySize
+			size_t next = 0;
+			double lastMs = 0.0;
+		};
+
+		FrameQueries _frames[FrameLatency];
+		int _frameIndex = 0;
+		bool _created = false;
+		bool _inFrame = false;
+		bool _enabled = true;
+		std::vector<int> _openScopes;	// indices into the current frame's scopes, -1 when the scope was dropped
+		std::vector<ScopeHistory> _history;
+		bool _hasFrameTime = false;
+		uint64_t _lastFrameNumber = 0;
+		double _lastFrameMs = 0.0;
+
+		void CreateQueries();
+		void Collect(FrameQueries& frame);
+		void AddSample(const PendingScope& scope, double ms);
+	};
+
+	// RAII helper, a null profiler makes it a no-op
+	class GpuScope {
+	public:
+		GpuScope(GpuProfiler* profiler, const char* name) : _profiler(profiler) {
+			if (_profiler) _profiler->BeginScope(name);
+		}
+		~GpuScope() {
+			if (_profiler) _profiler->EndScope();
+		}
+
+		GpuScope(const GpuScope&) = delete;
+		GpuScope& operator=(const GpuScope&) = delete;
+
+	private:
+		GpuProfiler* _profiler;
+	};
+}
@@ -2,9 +2,46 @@
 
 #include <glm/glm.hpp>
 #include <string>
+#include <cstdint>
+
+#include "Shader.h"
 
 namespace stereorizer::graphics
 {
+    // std140 mirror of the GLSL "struct Light" inside the FrameData uniform block
+    struct LightBlock {
+        int32_t type;
+        float _pad0[3];
+        glm::vec3 position;
+        float _pad1;
+        glm::vec3 direction;
+        float _pad2;
+        glm::vec3 color;
+        float intensity;
+        glm::vec3 attenuation;
+        float innerConeAngle;
+        float outerConeAngle;
+        float _pad3[3];
+    };
+    static_assert(sizeof(LightBlock) == 96, "LightBlock must match the std140 layout of struct Light");
+
+    // Uniform ids of the members of one "struct Light" uniform, hashed once per prefix
+    struct LightUniforms {
+        UniformId type, position, direction, color, intensity, attenuation, innerConeAngle, outerConeAngle;
+
+        constexpr explicit LightUniforms(const char* prefix)
+            : LightUniforms(UniformId(prefix)) {}
+
+    private:
+        constexpr explicit LightUniforms(UniformId prefix)
+            : type(prefix.Append(".type")), position(prefix.Append(".position")), direction(prefix.Append(".direction"))
+            , color(prefix.Append(".color")), intensity(prefix.Append(".intensity")), attenuation(prefix.Append(".attenuation"))
+            , innerConeAngle(prefix.Append(".innerConeAngle")), outerConeAngle(prefix.Append(".outerConeAngle")) {}
+    };
+
+    // The shaders' single light
+    inline constexpr LightUniforms DefaultLightUniforms("light");
+
     enum class LightType {
         Directional,
         Point,
@@ -39,7 +76,9 @@ namespace stereorizer::graphics
         float GetOuterConeAngle() const { return _outerConeAngle; }
         
         // Upload to shader uniforms
-        void UploadToShader(unsigned int shaderID, const std::string& uniformPrefix = "light") const;
+        void UploadToShader(const Shader& shader, const LightUniforms& uniforms = DefaultLightUniforms) const;
+        // Fill the light part of the per-frame uniform block
+        void WriteToBlock(LightBlock& block) const;
 
     private:
         LightType _type;
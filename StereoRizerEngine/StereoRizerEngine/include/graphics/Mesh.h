@@ -8,36 +8,138 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <iostream>
+#include <memory>
 #include <graphics/Vertex.h>
 #include <graphics/VertexArray.h>
+#include <graphics/MeshCache.h>
 
 namespace stereorizer::graphics
 {
+    class StagingBuffer;
+
+    // How the vertices of an imported mesh are stored on the GPU
+    enum class VertexFormat {
+        // Vertex as is: vec3 position, vec3 normal, 24 bytes
+        Float,
+        // 12 bytes: positions as 16-bit unorm within the mesh bounds, dequantized by
+        // Mesh::GetDequantization; normals as GL_INT_2_10_10_10_REV snorm
+        Compressed
+    };
+
+    // How a file is imported, part of the key of its MeshCache entry and of its MeshManager slot
+    struct MeshImportOptions {
+        // Assimp post-process steps, aiProcess_Triangulate is always added
+        unsigned int postProcess = aiProcess_Triangulate | aiProcess_JoinIdenticalVertices;
+        VertexFormat vertexFormat = VertexFormat::Compressed;
+
+        unsigned int GetImportFlags() const { return postProcess | aiProcess_Triangulate; }
+        // Everything that changes what the import produces
+        uint64_t GetCacheKey() const { return (uint64_t)vertexFormat << 32 | GetImportFlags(); }
+    };
+
+    // CPU side of a mesh, ready for upload. Filled on any thread, only the upload needs the GL
+    // thread. The blobs point into vertices/indices (or their packed copies) after an import or
+    // into the mapped cache entry after a cache hit; all of them survive a move of the MeshData.
+    struct MeshData {
+        VertexLayout layout;
+        const void* vertexData = nullptr;
+        size_t vertexSize = 0;
+        const void* indexData = nullptr;
+        size_t indexCount = 0;
+        uint32_t indexSize = sizeof(uint32_t);  // bytes per index, 2 whenever the vertex count allows
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
+        // Stored position * scale + offset is the mesh space position, identity unless quantized
+        glm::vec3 positionScale = glm::vec3(1.0f);
+        glm::vec3 positionOffset = glm::vec3(0.0f);
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<uint8_t> packedVertices;
+        std::vector<uint16_t> shortIndices;
+        MeshCacheEntry cacheEntry;
+
+        size_t GetIndexBytes() const { return indexCount * indexSize; }
+        GLenum GetIndexType() const { return indexSize == sizeof(uint16_t) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT; }
+    };
+
+    // Every mesh of a file, loaded from the MeshCache entry of the path when there is a valid one,
+    // imported with Assimp (and cached for the next load) otherwise. The import walks the node
+    // hierarchy and bakes each node's transform into the vertices of the meshes it references;
+    // all of them share one vertex and one index buffer and draw as one. A mesh referenced by
+    // several nodes is stored once per node, which keeps the whole file a single draw with a
+    // single model matrix at the cost of memory for instanced parts.
     class Mesh {
     public:
+        // CPU copies, only kept after an import, a load from the cache goes straight to the GPU
         std::vector<Vertex> vertices;
         std::vector<unsigned int> indices;
         //unsigned int VAO = 0;
 
-        Mesh(const std::string& path);
+        // Loads and uploads on the calling thread
+        Mesh(const std::string& path, const MeshImportOptions& options = {});
+        // Uploads data on the calling thread
+        explicit Mesh(const MeshData& data);
+        // Not uploaded yet: draws, bounds and counts are the placeholder's until Upload. A null
+        // placeholder draws nothing.
+        explicit Mesh(std::shared_ptr<const Mesh> placeholder);
         ~Mesh();
 
+        // Cache hit or import of path into data, false when the import failed. Any thread.
+        static bool Load(const std::string& path, const MeshImportOptions& options, MeshData& data);
+        // Creates the GL buffers from data and drops the placeholder. GL thread.
+        void Upload(const MeshData& data);
+        // Same, the bytes go through staging. False, and nothing created, while staging has no
+        // room for them; data larger than all of staging is uploaded directly.
+        bool Upload(const MeshData& data, StagingBuffer& staging);
+        // Gives up on the upload, the placeholder is dropped and nothing is drawn
+        void ClearPlaceholder() { _placeholder.reset(); }
+        bool IsPending() const { return _placeholder != nullptr; }
+
         Mesh(Mesh&& other) noexcept;
         Mesh& operator=(Mesh&& other) noexcept;
 
-        void Draw() const;
+        // instanceCount > 1 is used by the instanced stereo path (one instance per eye). Every part of
+        // the import shares buffers, program and transform, so the whole mesh is one draw.
+        void Draw(int instanceCount = 1) const;
+        // Draws with the command at commandOffset of the bound GL_DRAW_INDIRECT_BUFFER
+        void DrawIndirect(GLintptr commandOffset) const;
+
+        // Object-space bounding box, computed at load
+        const glm::vec3& GetBoundsMin() const { return _placeholder ? _placeholder->GetBoundsMin() : _boundsMin; }
+        const glm::vec3& GetBoundsMax() const { return _placeholder ? _placeholder->GetBoundsMax() : _boundsMax; }
+        GLuint GetIndexCount() const { return _placeholder ? _placeholder->GetIndexCount() : _indexCount; }
+        // Vertex to mesh space of quantized positions, to be applied before the model transform
+        const glm::mat4& GetDequantization() const { return _placeholder ? _placeholder->GetDequantization() : _dequantization; }
+        // Sort key of the mesh in the render queue
+        GLuint GetVertexArrayId() const { return _placeholder ? _placeholder->GetVertexArrayId() : (vtxArray ? vtxArray->getId() : 0); }
+
+        // Bytes of the mesh's own GL buffers, nothing while it draws a placeholder
+        size_t GetGpuBytes() const { return _gpuBytes; }
+        // Bytes of the CPU copies
+        size_t GetCpuBytes() const;
 
     protected:
-        void SetupMesh();
+        // Buffers of data's size, filled from data unless it is to be staged
+        void SetupMesh(const MeshData& data, bool fill);
 
-        VertexBuffer* vtxBuffer = nullptr;
-        VertexArray* vtxArray = nullptr;
-        ElementBuffer* elementBuffer = nullptr;
+        std::unique_ptr<VertexBuffer> vtxBuffer;
+        std::unique_ptr<VertexArray> vtxArray;
+        std::unique_ptr<ElementBuffer> elementBuffer;
 
     private:
         //unsigned int VBO = 0, EBO = 0;
         std::string _path;
-        void ProcessMesh();
-        void ProcessMeshInternally(aiMesh* mesh);
+        glm::vec3 _boundsMin = glm::vec3(0.0f);
+        glm::vec3 _boundsMax = glm::vec3(0.0f);
+        GLuint _indexCount = 0;
+        glm::mat4 _dequantization = glm::mat4(1.0f);
+        size_t _gpuBytes = 0;
+        std::shared_ptr<const Mesh> _placeholder;
+        static bool ProcessMesh(const std::string& path, unsigned int importFlags, MeshData& data);
+        // Appends the meshes of node and its children, parentTransform is the node's parent to mesh space
+        static void ProcessNode(const aiScene* scene, const aiNode* node, const glm::mat4& parentTransform, MeshData& data);
+        static void ProcessMeshInternally(const aiMesh* mesh, const glm::mat4& transform, MeshData& data);
+        // Packs vertices and indices of an import into the blobs of format
+        static void PackVertices(VertexFormat format, MeshData& data);
     };
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <glm/glm.hpp>
+
+#include "core/MappedFile.h"
+#include "VertexBuffer.h"
+
+namespace stereorizer::graphics
+{
+	struct MeshCacheAttribute {
+		uint32_t components;
+		uint32_t type;			// GLenum
+		uint32_t normalized;
+		uint32_t offset;		// bytes from the start of the vertex
+	};
+
+	// File layout: header, source path, then the vertex and index blobs at aligned offsets.
+	// Written and read in the engine's native (little) endianness, never shipped between machines.
+	struct MeshCacheHeader {
+		static constexpr int MaxAttributes = 8;
+
+		char magic[4];
+		uint32_t version;
+		int64_t sourceWriteTime;	// last write time of the source when it was imported
+		uint64_t importKey;			// MeshImportOptions::GetCacheKey of that import
+		uint32_t sourcePathSize;	// bytes of the path following the header, no terminator
+		uint32_t vertexCount;
+		uint32_t vertexStride;
+		uint32_t attributeCount;
+		MeshCacheAttribute attributes[MaxAttributes];
+		uint32_t indexCount;
+		uint32_t indexSize;			// bytes per index, 2 or 4
+		float boundsMin[3];
+		float boundsMax[3];
+		float positionScale[3];		// dequantization of the positions, mesh = stored * scale + offset
+		float positionOffset[3];
+		uint64_t vertexOffset;		// from the start of the file
+		uint64_t indexOffset;
+	};
+	static_assert(std::is_trivially_copyable_v<MeshCacheHeader> && sizeof(MeshCacheHeader) % 8 == 0, "MeshCacheHeader is written as raw bytes");
+
+	// A cache entry mapped into memory. The blobs point into the mapping and are only valid while
+	// this object lives, long enough to hand them to glBufferStorage.
+	struct MeshCacheEntry {
+		core::MappedFile file;
+		VertexLayout layout;
+		const void* vertexData = nullptr;
+		size_t vertexSize = 0;
+		const void* indexData = nullptr;
+		size_t indexCount = 0;
+		uint32_t indexSize = sizeof(uint32_t);
+		glm::vec3 boundsMin = glm::vec3(0.0f);
+		glm::vec3 boundsMax = glm::vec3(0.0f);
+		glm::vec3 positionScale = glm::vec3(1.0f);
+		glm::vec3 positionOffset = glm::vec3(0.0f);
+	};
+
+	// Imported meshes cached as binary files keyed by source path, source write time and import
+	// key. A changed source or import options, another format version or a damaged file all count
+	// as a miss and the next import overwrites the entry.
+	class MeshCache {
+	public:
+		static constexpr char Magic[4] = { 'S', 'R', 'M', 'C' };
+		// Bump whenever the file layout or what an import produces changes
+		static constexpr uint32_t Version = 4;
+		// Relative to the working directory, like the shaders
+		static constexpr const char* Directory = "cache/meshes";
+		static constexpr uint64_t BlobAlignment = 16;
+
+		// Absolute, so the same file reached through different relative paths shares one entry
+		static std::string NormalizeSourcePath(const std::string& sourcePath);
+		static std::string GetEntryPath(const std::string& sourcePath, uint64_t importKey);
+
+		// Maps the entry of sourcePath, false on a miss
+		static bool Load(const std::string& sourcePath, uint64_t importKey, MeshCacheEntry& entry);
+		// Writes the entry of sourcePath, false when it couldn't. Only costs the next load an import.
+		static bool Store(const std::string& sourcePath, uint64_t importKey, const VertexLayout& layout,
+			const void* vertexData, size_t vertexSize, const void* indexData, size_t indexCount, uint32_t indexSize,
+			const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+			const glm::vec3& positionScale, const glm::vec3& positionOffset);
+	};
+}
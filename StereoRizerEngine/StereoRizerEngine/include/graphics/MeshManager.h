@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "AssetLoader.h"
+
+namespace stereorizer::graphics
+{
+	struct MeshManagerStats {
+		size_t meshCount = 0;		// resident or loading
+		size_t referencedCount = 0;	// held by something besides the manager
+		size_t gpuBytes = 0;		// GL buffers of every resident mesh
+		size_t cpuBytes = 0;		// CPU copies of the vertices and indices
+		size_t gpuBudget = 0;		// 0 is unlimited
+		uint64_t hits = 0;			// Acquire served by a resident or loading mesh
+		uint64_t misses = 0;
+		uint64_t evictions = 0;
+	};
+
+	// One Mesh per file and import options. Acquire hands out the same shared mesh to every
+	// caller; the shared_ptr is the reference count. A mesh nobody but the manager holds any more
+	// stays resident, so loading it again is free, until the GPU bytes of all meshes exceed the
+	// budget: then the least recently referenced unreferenced meshes are released. Referenced
+	// meshes are never released, the budget is exceeded instead. GL thread only.
+	class MeshManager {
+	public:
+		explicit MeshManager(AssetLoader& loader);
+		~MeshManager();
+
+		MeshManager(const MeshManager&) = delete;
+		MeshManager& operator=(const MeshManager&) = delete;
+
+		// The shared mesh of path and options, loaded through the AssetLoader on a miss.
+		// A load that failed earlier is retried.
+		MeshHandle Acquire(const std::string& path, const MeshImportOptions& options = {});
+
+		// GPU bytes unreferenced meshes may take up together with the referenced ones, 0 is unlimited
+		void SetGpuBudget(size_t bytes) { _stats.gpuBudget = bytes; }
+		size_t GetGpuBudget() const { return _stats.gpuBudget; }
+
+		// Once per frame after the AssetLoader's: refreshes the accounting and evicts over budget
+		void Update();
+		// Releases every unreferenced mesh regardless of the budget
+		void ReleaseUnused();
+
+		const MeshManagerStats& GetStats() const { return _stats; }
+
+	private:
+		struct Entry {
+			MeshHandle handle;
+			uint64_t lastUsed = 0;	// Update count when it was last referenced or acquired
+		};
+
+		AssetLoader& _loader;
+		std::unordered_map<std::string, Entry> _entries;
+		uint64_t _updateCount = 0;
+		MeshManagerStats _stats;
+
+		static std::string MakeKey(const std::string& path, const MeshImportOptions& options);
+		static bool IsReferenced(const Entry& entry) { return entry.handle.mesh.use_count() > 1; }
+		void Account();
+	};
+}
@@ -23,7 +23,10 @@ namespace stereorizer::graphics
 		std::shared_ptr<Shader> GetShader() const noexcept { return _shader; }
 		void SetShader(std::shared_ptr<Shader> shader) noexcept;
 		const glm::mat4& GetTransformMatrix() const noexcept { return _transform; }
-		void Draw() const;
+		const glm::mat3& GetNormalMatrix() const noexcept { return _normalMatrix; }
+		void Draw(int instanceCount = 1) const;
+		// Same as Draw, the mesh command comes from the bound GL_DRAW_INDIRECT_BUFFER
+		void DrawIndirect(GLintptr commandOffset) const;
 
 		// Transformations
 		void Translate(const glm::vec3& offset);
@@ -35,6 +38,11 @@ namespace stereorizer::graphics
 		std::shared_ptr<Mesh> _mesh;
 		std::shared_ptr<Shader> _shader;
 		glm::mat4 _transform = glm::mat4(1.0f);
+		// transpose(inverse(mat3(_transform))), refreshed whenever the transform changes
+		glm::mat3 _normalMatrix = glm::mat3(1.0f);
 		glm::vec3 _color = glm::vec3(1.0f);
+
+		void UpdateNormalMatrix();
+		void UploadUniforms() const;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Shader.h"
+#include "Model.h"
+#include "DepthPyramid.h"
+
+namespace stereorizer::graphics
+{
+	// Hi-Z occlusion culling on the GPU: a compute pass tests every model's world bounds against a
+	// DepthPyramid and writes one indirect draw command per model with instanceCount 0 or 1, so
+	// culled draws cost nothing and the CPU never waits for the result.
+	class OcclusionCuller {
+	public:
+		OcclusionCuller();
+		~OcclusionCuller();
+
+		OcclusionCuller(const OcclusionCuller&) = delete;
+		OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+
+		// Tests the models as seen by eye (FrameData index) against the pyramid of that eye's depth
+		bool Cull(const std::vector<std::shared_ptr<Model>>& models, const DepthPyramid& pyramid, int eyeIndex);
+
+		// Binds the command buffer as GL_DRAW_INDIRECT_BUFFER for DrawModel
+		void BeginDraws() const;
+		// Draws models[index] of the last Cull through its command
+		void DrawModel(const Model& model, size_t index) const;
+		void EndDraws() const;
+
+		// Models that passed the test in the last Cull whose result is available, -1 until then
+		int GetVisibleCount() const { return _visibleCount; }
+		int GetTestedCount() const { return _testedCount; }
+
+	private:
+		// std430 mirror of the CullObject entries read by OcclusionCull.shader
+		struct CullObject {
+			glm::mat4 modelMatrix;
+			glm::vec3 boundsMin;
+			GLuint indexCount;		// an integer, a float count loses precision past 2^24
+			glm::vec3 boundsMax;
+			GLuint padding;
+		};
+		static_assert(sizeof(CullObject) == 96 && offsetof(CullObject, indexCount) == 76, "CullObject must match the std430 layout in OcclusionCull.shader");
+
+		// Layout fixed by glDrawElementsIndirect
+		struct DrawElementsIndirectCommand {
+			GLuint count;
+			GLuint instanceCount;
+			GLuint firstIndex;
+			GLint baseVertex;
+			GLuint baseInstance;
+		};
+
+		std::shared_ptr<Shader> _shader = nullptr;
+		GLuint _objectBuffer = 0;
+		GLuint _commandBuffer = 0;
+		GLuint _counterBuffer = 0;
+		size_t _capacity = 0;
+		GLsync _counterFence = nullptr;	// set once the dispatch writing the counter is submitted
+		int _visibleCount = -1;
+		int _testedCount = 0;
+		std::vector<CullObject> _objects;
+
+		bool CreateResources(size_t modelCount);
+		void DeleteBuffers();
+		void ReadVisibleCount();
+	};
+}
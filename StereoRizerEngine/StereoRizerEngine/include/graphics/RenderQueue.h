@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include "Model.h"
+#include "Camera.h"
+
+namespace stereorizer::graphics
+{
+	// Top field of the sort key, so every pass is one contiguous range of the sorted packets
+	enum class RenderPass : uint8_t {
+		DepthPrepass,	// depth-only draws of the reprojection paths, before shading
+		Opaque,
+		Count
+	};
+
+	// 64-bit sort key, most significant field first: pass, shader variant (linked program),
+	// mesh (VAO), view depth. Sorting groups program and VAO switches and draws front to back
+	// within a group, so early-z rejects what is hidden behind what came first.
+	struct DrawKey {
+		static constexpr int DepthBits = 28;
+		static constexpr int MeshBits = 16;
+		static constexpr int VariantBits = 16;
+		static constexpr int PassBits = 4;
+		static_assert(DepthBits + MeshBits + VariantBits + PassBits == 64, "DrawKey fields must fill 64 bits");
+
+		static constexpr int MeshShift = DepthBits;
+		static constexpr int VariantShift = MeshShift + MeshBits;
+		static constexpr int PassShift = VariantShift + VariantBits;
+
+		// GL names above 16 bits wrap, which only costs grouping, never correctness.
+		// Depth is clamped to >= 0, its float bits order like the values then.
+		static uint64_t Make(RenderPass pass, GLuint program, GLuint vertexArray, float depth);
+		static RenderPass GetPass(uint64_t key) { return (RenderPass)(key >> PassShift); }
+		static GLuint GetVariant(uint64_t key) { return (GLuint)((key >> VariantShift) & ((1u << VariantBits) - 1)); }
+		static GLuint GetMesh(uint64_t key) { return (GLuint)((key >> MeshShift) & ((1u << MeshBits) - 1)); }
+	};
+
+	struct DrawPacket {
+		uint64_t key = 0;
+		const Model* model = nullptr;
+		uint32_t modelIndex = 0;	// into the recorded model list, for per-model GPU data such as cull commands
+	};
+
+	struct RenderQueueStats {
+		size_t packetCount = 0;
+		unsigned bucketCount = 0;	// per-thread buckets that received packets
+		int variantChanges = 0;		// program switches submitting the sorted packets costs
+		int meshChanges = 0;		// VAO switches, same
+		double recordMs = 0.0;
+		double sortMs = 0.0;
+	};
+
+	// Draw packets of one frame, recorded once and submitted for both eyes. Recording only reads
+	// models and cameras, so it runs on the WorkerPool into one bucket per thread; the buckets are
+	// merged and radix sorted on the calling thread, submission stays on the GL thread.
+	class RenderQueue {
+	public:
+		// Fewer models than this are recorded on the calling thread. Recording costs about 50 ns a
+		// model and handing a chunk to a sleeping worker about 4 us (measured at -O1), so chunks
+		// under ~80 models lose time; the sample scenes are well below this and stay inline.
+		static constexpr size_t MinModelsPerThread = 128;
+
+		// Depth is measured from the midpoint of the eyes along their mean view direction, which
+		// orders the models front to back for both. The key takes each shader's active variant,
+		// so the caller selects the variants it draws with first.
+		void Record(const std::vector<std::shared_ptr<Model>>& models, const Camera& leftCamera, const Camera& rightCamera, bool depthPrepass);
+
+		// Sorted packets of one pass
+		std::span<const DrawPacket> GetPass(RenderPass pass) const;
+		// The list Record was given, valid as long as the caller keeps it
+		const std::vector<std::shared_ptr<Model>>& GetModels() const { return *_models; }
+		const RenderQueueStats& GetStats() const { return _stats; }
+
+	private:
+		static const std::vector<std::shared_ptr<Model>> NoModels;
+
+		const std::vector<std::shared_ptr<Model>>* _models = &NoModels;
+		std::vector<std::vector<DrawPacket>> _buckets;
+		std::vector<DrawPacket> _packets;
+		std::vector<DrawPacket> _sortScratch;
+		size_t _passBegin[(size_t)RenderPass::Count + 1] = {};
+		RenderQueueStats _stats;
+
+		// LSD radix sort of _packets by key, 8 bits per pass, skipping bytes all keys share
+		void SortPackets();
+	};
+}
@@ -9,6 +9,12 @@
 #include "Model.h"
 #include "Camera.h"
 #include "Light.h"
+#include "StereoRenderTarget.h"
+#include "TileClassifier.h"
+#include "ForwardReprojector.h"
+#include "DepthPyramid.h"
+#include "OcclusionCuller.h"
+#include "RenderQueue.h"
 
 namespace stereorizer::graphics
 {
@@ -26,14 +32,56 @@ namespace stereorizer::graphics
 		void SetLight(std::shared_ptr<Light> light);
 		std::shared_ptr<Light> GetLight() const { return _light; }
 
+		// Which eye of the per-frame uniform buffer this renderer draws (0 = left, 1 = right)
+		void SetEyeIndex(int eyeIndex) { _eyeIndex = eyeIndex; }
+		int GetEyeIndex() const { return _eyeIndex; }
+
 		// Depth texture support
 		void SetupDepthTexture(int width, int height, bool isRightViewport = false);
 		void BeginTextureRender();
 		void EndTextureRender();
-		void RenderToTextures(const std::vector<std::shared_ptr<Model>>& models);
+		void RenderToTextures(const RenderQueue& queue);
+		// Framebuffer EndTextureRender returns to for the visualization passes, 0 is the window
+		void SetPresentFramebuffer(GLuint framebuffer) { _presentFramebuffer = framebuffer; }
+
+		// Right eye built from the left eye's textures: a depth-only prepass, a full-screen pass that
+		// copies every pixel the left eye explains and leaves a stencil bit on the rest, then normal
+		// shading restricted by the stencil test to those (disoccluded) pixels.
+		void RenderToTexturesStencilMasked(const RenderQueue& queue, GLuint leftColorTexture, GLuint leftDepthTexture);
+
+		// Right eye built per tile: after the depth prepass a compute pass copies reprojectable pixels
+		// and lists the tiles that fail, only those are shaded in scissored sub-passes
+		void RenderToTexturesTiled(const RenderQueue& queue, GLuint leftColorTexture, GLuint leftDepthTexture);
+		TileClassifier& GetTileClassifier() { return _tileClassifier; }
+
+		// Right eye scattered from the left eye in compute, geometry is only drawn into the holes
+		// left after crack filling, and skipped entirely on the GPU when there are none
+		void RenderToTexturesForward(const RenderQueue& queue, GLuint leftColorTexture, GLuint leftDepthTexture);
+		ForwardReprojector& GetForwardReprojector() { return _forwardReprojector; }
+
+		// Fraction of this renderer's pixels the last RenderToTextures* call took from the other eye
+		// instead of shading them, 0 for a full render. The stencil and forward paths count on the
+		// GPU and report the previous frame's figure.
+		float GetPixelReuseRatio() const { return _pixelReuseRatio; }
+
+		// Min/max depth pyramid of this renderer's depth, rebuilt by EndTextureRender when enabled
+		void SetDepthPyramidEnabled(bool enabled) { _depthPyramidEnabled = enabled; }
+		const DepthPyramid& GetDepthPyramid() const { return _depthPyramid; }
+		// Left-eye pyramid the reprojection paths test whole blocks against, nullptr for none
+		void SetReprojectionPyramid(const DepthPyramid* pyramid) { _reprojectionPyramid = pyramid; }
+		const OcclusionCuller& GetOcclusionCuller() const { return _occlusionCuller; }
 		void RenderDepthVisualization(float nearPlane = 0.1f, float farPlane = 100.0f);
 		void RenderColorVisualization();
 
+		// Single-pass stereo: draws both eyes into the layers of the target at once, either
+		// through multiview or one instance per eye depending on the target layout.
+		// This renderer's camera is the left view, rightCamera the right view.
+		void RenderToStereoTarget(const RenderQueue& queue, StereoRenderTarget& target, const Camera& rightCamera);
+
+		// Visualization of an external texture (e.g. one layer of a StereoRenderTarget)
+		void RenderDepthVisualization(GLuint depthTexture, float nearPlane, float farPlane);
+		void RenderColorVisualization(GLuint colorTexture);
+
 		GLuint GetDepthTexture() const { return _depthTexture; }
 		GLuint GetColorTexture() const { return _colorTexture; }
 		bool IsDepthTextureEnabled() const { return _depthTexture != 0; }
@@ -41,23 +89,32 @@ namespace stereorizer::graphics
 	private:
 		std::shared_ptr<Camera> _camera;
 		std::shared_ptr<Light> _light;
-		
-		// OpenGL state management
-		struct OpenGLState {
-			GLint framebuffer;
-			GLint texture2D;
-			GLint activeTexture;
-		};
+		int _eyeIndex = 0;
 		
 		// Depth texture rendering
 		GLuint _framebuffer = 0;
 		GLuint _colorTexture = 0;
-		GLuint _depthTexture = 0;
+		GLuint _depthTexture = 0;	// GL_DEPTH24_STENCIL8, sampled as depth
 		int _textureWidth = 0;
 		int _textureHeight = 0;
 		bool _isRightViewport = false;
+		GLuint _presentFramebuffer = 0;
 
 		bool texturesReadyForReprojection = false;
+
+		// Depth prepass target for the stencil-masked path, sampled while the main depth is written
+		GLuint _prepassFramebuffer = 0;
+		GLuint _prepassDepthTexture = 0;
+		TileClassifier _tileClassifier;
+		ForwardReprojector _forwardReprojector;
+		GLuint _holeQuery = 0;	// Any sample passed while marking holes, gates the re-render
+		GLuint _reuseQuery = 0;	// Samples the stencil reprojection pass copied from the left eye
+		bool _reuseQueryPending = false;
+		float _pixelReuseRatio = 0.0f;
+		DepthPyramid _depthPyramid;
+		bool _depthPyramidEnabled = false;
+		const DepthPyramid* _reprojectionPyramid = nullptr;
+		OcclusionCuller _occlusionCuller;
 		
 		// Full-screen quad for texture visualization
 		GLuint _quadVAO = 0;
@@ -65,7 +122,16 @@ namespace stereorizer::graphics
 		std::shared_ptr<Shader> _depthShader = nullptr;
 		std::shared_ptr<Shader> _colorShader = nullptr;
 		std::shared_ptr<Shader> _reprojectionShader = nullptr;
+		std::shared_ptr<Shader> _stencilReprojectionShader = nullptr;
+		std::shared_ptr<Shader> _forwardHolesShader = nullptr;
 		
+		// Eye selection or legacy camera/light uploads for the model's shader
+		void UploadPerDraw(const Model& model);
+		// Draws the pass's packets in key order. Per-shader state (variant, eye, camera, light) is
+		// set when the packets switch shaders, with define enabled meanwhile when one is given.
+		// With a culler the draws go through the commands of its last Cull.
+		void Submit(const RenderQueue& queue, RenderPass pass, const char* define = nullptr, const OcclusionCuller* culler = nullptr);
+
 		void SetupFullScreenQuad();
 		void CleanupFullScreenQuad();
 		
@@ -73,9 +139,11 @@ namespace stereorizer::graphics
 		void CreateColorTexture();
 		void CreateDepthTexture();
 		void CreateFramebuffer();
-		
-		// OpenGL state management
-		OpenGLState SaveOpenGLState();
-		void RestoreOpenGLState(const OpenGLState& state);
+		bool CreatePrepassFramebuffer();
+		// Depth-only pass of the queue into the prepass target, leaves the main framebuffer bound
+		bool RenderDepthPrepass(const RenderQueue& queue);
+		void DeleteTextureResources();
+		// Picks up the stencil reuse count without waiting, false while the GPU is still on it
+		bool ReadReuseQuery();
 	};
 }
\ No newline at end of file
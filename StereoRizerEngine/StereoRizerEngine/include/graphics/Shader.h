@@ -18,6 +18,44 @@ namespace stereorizer::graphics
 	struct ShaderProgramSource {
 		std::string VertexSource;
 		std::string FragmentSource;
+		// A "#shader compute" section makes this a compute-only program
+		std::string ComputeSource;
+	};
+
+	// Precomputed FNV-1a hash of a uniform name. Declare call-site names as
+	// static constexpr so lookups never hash or allocate at runtime.
+	struct UniformId {
+		uint32_t hash;
+
+		constexpr UniformId(const char* name) : hash(Hash(name, 2166136261u)) {}
+
+		// Hash of this name followed by suffix, e.g. UniformId("light").Append(".color")
+		constexpr UniformId Append(const char* suffix) const { return UniformId(Hash(suffix, hash), 0); }
+
+		static constexpr uint32_t Hash(const char* str, uint32_t hash) {
+			while (*str) {
+				hash ^= static_cast<uint8_t>(*str++);
+				hash *= 16777619u;
+			}
+			return hash;
+		}
+
+	private:
+		constexpr UniformId(uint32_t precomputed, int) : hash(precomputed) {}
+	};
+
+	// Linked program of one define set plus its reflected uniform locations and blocks
+	struct ShaderVariant {
+		GLuint program = 0;
+		std::unordered_map<uint32_t, GLint> uniforms;
+		std::unordered_map<uint32_t, GLuint> uniformBlocks;
+	};
+
+	// Define set of a variant, sorted by name so insertion order doesn't matter
+	using ShaderVariantKey = std::vector<std::pair<std::string, std::string>>;
+
+	struct ShaderVariantKeyHash {
+		size_t operator()(const ShaderVariantKey& key) const noexcept;
 	};
 
 	class Shader {
@@ -34,6 +72,11 @@ namespace stereorizer::graphics
 		bool ReloadIfChanged();
 		GLuint GetID() const noexcept { return _rendererID; }
 
+		// Location from the table reflected at link time, -1 if the active variant doesn't use it
+		GLint GetUniformLocation(UniformId id) const;
+		// True when the active variant reads the named uniform block
+		bool HasUniformBlock(UniformId id) const;
+
 		// Define management methods
 		void EnableDefine(const std::string& name, const std::string& value = "");
 		void DisableDefine(const std::string& name);
@@ -41,17 +84,41 @@ namespace stereorizer::graphics
 		void ClearAllDefines();
 		bool RecompileWithDefines();
 
+		// Variant cache: every distinct set of defines is compiled once and
+		// kept alive, so switching defines only rebinds an already linked program.
+		bool ActivateVariant();
+		void InvalidateVariants();
+		size_t GetVariantCount() const noexcept { return _variants.size(); }
+
 	private:
 		GLuint _rendererID = 0;
 		std::string _filePath;
 		fs::file_time_type _lastWriteTime;
 		std::unordered_map<std::string, std::string> _defines;
+		// Sorted copy of _defines, rebuilt only when a define changes
+		ShaderVariantKey _variantKey;
+		// A define changed since the active variant was looked up
+		bool _variantKeyChanged = true;
+
+		// Parsed source is kept so new variants don't hit the disk
+		ShaderProgramSource _source;
+		// Keyed by the full define set, a hash collision can't hand out another variant's program
+		std::unordered_map<ShaderVariantKey, ShaderVariant, ShaderVariantKeyHash> _variants;
+		// Node pointers of unordered_map stay valid across rehashing
+		const ShaderVariant* _activeVariant = nullptr;
 
 		ShaderProgramSource ParseShader(const std::string& filepath);
 		fs::file_time_type GetLastWriteTime();
 		std::string InjectDefines(const std::string& source);
+		void UpdateVariantKey();
+		GLuint CompileVariant();
+		void ReflectUniforms(ShaderVariant& variant) const;
+		void SetActiveVariant(const ShaderVariant& variant);
 
 		GLuint CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
+		GLuint CreateComputeShader(const std::string& computeShader);
+		// Returns the program, or 0 (and deletes it) when linking failed
+		GLuint CheckLinkStatus(GLuint program);
 		GLuint CompileShader(const std::string& source, GLenum type);
 	};
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <GL/glew.h>
+
+namespace stereorizer::graphics
+{
+	// One copy of a staged block: size bytes of data into buffer at bufferOffset
+	struct StagingCopy {
+		GLuint buffer = 0;
+		GLintptr bufferOffset = 0;
+		const void* data = nullptr;
+		size_t size = 0;
+	};
+
+	// Ring of persistently mapped upload memory. Data is written into the mapping on the CPU and
+	// copied into its destination buffers on the GPU; every batch of copies is fenced, and its
+	// part of the ring is only written again once the fence signalled, so the CPU never waits on
+	// a copy still in flight and never overwrites bytes the GPU has yet to read. GL thread only.
+	class StagingBuffer {
+	public:
+		static constexpr size_t Alignment = 64;
+
+		StagingBuffer() = default;
+		~StagingBuffer();
+
+		StagingBuffer(const StagingBuffer&) = delete;
+		StagingBuffer& operator=(const StagingBuffer&) = delete;
+
+		bool Create(size_t size);
+		void Destroy();
+		bool IsValid() const { return _mapped != nullptr; }
+		size_t GetSize() const { return _size; }
+
+		// True when size bytes fit in one block right now. Retires the batches the GPU finished,
+		// with wait it also blocks on the oldest ones until they fit.
+		bool CanStage(size_t size, bool wait = false);
+		// Writes all copies into one block and issues them, false (and nothing issued) when the
+		// block doesn't fit, check CanStage with their total first
+		bool Stage(std::initializer_list<StagingCopy> copies);
+		// Closes the batch of everything staged since the last Fence
+		void Fence();
+
+		// Bytes staged since creation, for stats
+		uint64_t GetStagedBytes() const { return _stagedBytes; }
+
+	private:
+		struct Batch {
+			GLsync fence = nullptr;
+			size_t end = 0;		// ring offset right after the batch's last block
+		};
+
+		GLuint _buffer = 0;
+		uint8_t* _mapped = nullptr;
+		size_t _size = 0;
+		// Blocks in use are [_tail, _head), wrapping at _size. _head == _tail is empty or full.
+		size_t _head = 0;
+		size_t _tail = 0;
+		bool _empty = true;
+		bool _unfenced = false;
+		std::deque<Batch> _batches;
+		uint64_t _stagedBytes = 0;
+
+		// Offset of a free block of size bytes, or SIZE_MAX
+		size_t FindBlock(size_t size) const;
+		void Retire(bool wait);
+	};
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <GL/glew.h>
+
+namespace stereorizer::graphics
+{
+	// How both eyes are routed into the target during a single-pass stereo draw
+	enum class StereoLayout {
+		Multiview,		// GL_OVR_multiview2, layer picked by gl_ViewID_OVR
+		Layered,		// Instanced draw, layer picked by gl_Layer (ARB_shader_viewport_layer_array)
+		SideBySide		// Instanced draw into a double-wide target, copied into the layers afterwards
+	};
+
+	// Layered render target holding both eyes in a 2-layer GL_TEXTURE_2D_ARRAY.
+	// Used by the single-pass stereo paths, layer 0 is the left eye and layer 1 the right eye.
+	class StereoRenderTarget {
+	public:
+		static constexpr int ViewCount = 2;
+
+		StereoRenderTarget();
+		~StereoRenderTarget();
+
+		StereoRenderTarget(const StereoRenderTarget&) = delete;
+		StereoRenderTarget& operator=(const StereoRenderTarget&) = delete;
+
+		// True when the driver exposes GL_OVR_multiview2 (requires glewInit)
+		static bool IsMultiviewSupported();
+		// True when the vertex shader may write gl_Layer (requires glewInit)
+		static bool IsVertexLayerSupported();
+
+		// Stores the size, GL objects are created on first Begin()
+		void Setup(int width, int height);
+		void SetLayout(StereoLayout layout);
+		StereoLayout GetLayout() const noexcept { return _layout; }
+
+		// Number of instances each mesh has to be drawn with for this layout
+		int GetInstanceCount() const noexcept { return _layout == StereoLayout::Multiview ? 1 : ViewCount; }
+
+		// End() returns to whatever framebuffer was bound when Begin() was called
+		bool Begin();
+		void End();
+
+		int GetWidth() const noexcept { return _width; }
+		int GetHeight() const noexcept { return _height; }
+
+		GLuint GetColorArray() const noexcept { return _colorArray; }
+		GLuint GetDepthArray() const noexcept { return _depthArray; }
+
+		// GL_TEXTURE_2D views of a single layer, usable wherever a per-eye texture is expected
+		GLuint GetColorTexture(int view) const noexcept { return _colorViews[view]; }
+		GLuint GetDepthTexture(int view) const noexcept { return _depthViews[view]; }
+
+	private:
+		StereoLayout _layout = StereoLayout::Multiview;
+		GLuint _framebuffer = 0;
+		GLuint _previousFramebuffer = 0;
+		GLuint _colorArray = 0;
+		GLuint _depthArray = 0;
+		GLuint _colorViews[ViewCount] = { 0, 0 };
+		GLuint _depthViews[ViewCount] = { 0, 0 };
+		// Double-wide attachments, only allocated for StereoLayout::SideBySide
+		GLuint _sideBySideColor = 0;
+		GLuint _sideBySideDepth = 0;
+		int _width = 0;
+		int _height = 0;
+
+		void CreateTextures();
+		void CreateSideBySideTextures();
+		void CreateFramebuffer();
+		void Cleanup();
+	};
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+#include "Model.h"
+#include "Light.h"
+#include "Renderer.h"
+#include "StereoRenderTarget.h"
+#include "GpuProfiler.h"
+#include "RenderQueue.h"
+
+namespace stereorizer::graphics
+{
+	struct StereoScene {
+		const std::vector<std::shared_ptr<Model>>& models;
+		std::shared_ptr<Light> light;
+	};
+
+	// Shared targets a technique may render into, and where it leaves each eye for presentation
+	struct StereoTargets {
+		int eyeWidth = 0;
+		int eyeHeight = 0;
+		StereoRenderTarget* stereoTarget = nullptr;		// 2-layer target of the single-pass techniques
+
+		// Filled by Render: the GL_TEXTURE_2D holding each eye, 0 is left
+		GLuint colorTextures[2] = { 0, 0 };
+		GLuint depthTextures[2] = { 0, 0 };
+	};
+
+	struct StereoTechniqueStats {
+		double gpuMs = -1.0;		// GPU time of the last Render whose timing came back, negative before that
+		uint64_t gpuRender = 0;		// which Render call gpuMs belongs to, counted from 1
+		float pixelReuse = 0.0f;	// share of right-eye pixels taken from the left eye rather than shaded
+	};
+
+	// One way of producing a stereo pair. Window owns the eye targets and presents whatever the
+	// active technique leaves in StereoTargets; everything between the per-frame uniform upload
+	// and presentation (shader variants, passes, texture bindings) belongs to the technique.
+	// New techniques register a factory with StereoTechniqueRegistry and need no Window changes.
+	class IStereoTechnique {
+	public:
+		// Frames a GPU timing may take to come back before it is dropped
+		static constexpr int TimerLatency = 4;
+
+		virtual ~IStereoTechnique();
+
+		// Registry key, also the GPU profiler scope name, so it has to be a literal
+		virtual const char* GetName() const = 0;
+		// False when this GL lacks what the technique needs, it can't be selected then
+		virtual bool IsSupported() const { return true; }
+
+		// When the technique becomes active, and whenever the eye size changes while it is
+		virtual void Setup(int eyeWidth, int eyeHeight) { (void)eyeWidth; (void)eyeHeight; }
+		virtual void Resize(int eyeWidth, int eyeHeight) { (void)eyeWidth; (void)eyeHeight; }
+
+		// Renders both eyes, leftView/rightView carry the eye cameras and per-eye targets. The
+		// frame's uniform buffer is already bound. GPU time ends up in GetStats a few frames later.
+		// The scene is recorded into the render queue first, both eyes submit that one list.
+		void Render(const StereoScene& scene, Renderer& leftView, Renderer& rightView, StereoTargets& targets);
+
+		// Technique-specific controls and counters, called inside the open settings window
+		virtual void DrawSettings(Renderer& leftView, Renderer& rightView) { (void)leftView; (void)rightView; }
+
+		const StereoTechniqueStats& GetStats() const { return _stats; }
+		const RenderQueue& GetRenderQueue() const { return _queue; }
+		// Render calls so far, the next one is GetRenderCount() + 1
+		uint64_t GetRenderCount() const { return _renderCount; }
+
+		// Profiler the per-pass GPU scopes are recorded in, nullptr records none
+		void SetGpuProfiler(GpuProfiler* profiler) { _profiler = profiler; }
+
+	protected:
+		// Activates the shader variants the first pass draws with. Runs before the scene is
+		// recorded, so the draw keys group by the programs this frame actually binds.
+		virtual void SelectVariants(const std::vector<std::shared_ptr<Model>>& models) { (void)models; }
+		virtual void RenderViews(const StereoScene& scene, Renderer& leftView, Renderer& rightView, StereoTargets& targets) = 0;
+		// Records DepthPrepass packets next to the Opaque ones
+		virtual bool UsesDepthPrepass() const { return false; }
+
+		// RenderViews keeps pixelReuse current, gpuMs is managed here
+		StereoTechniqueStats _stats;
+		GpuProfiler* _profiler = nullptr;
+		// This frame's sorted draws of scene.models, what RenderViews hands to the renderers
+		RenderQueue _queue;
+
+	private:
+		GLuint _timerQueries[TimerLatency][2] = {};
+		uint64_t _timerRender[TimerLatency] = {};
+		bool _timerPending[TimerLatency] = {};
+		int _timerIndex = 0;
+		uint64_t _renderCount = 0;
+
+		void CollectTimer(int index);
+	};
+
+	using StereoTechniqueFactory = std::function<std::unique_ptr<IStereoTechnique>()>;
+
+	// Name -> factory of every technique the engine can switch to, in registration order.
+	// The built-in ones are registered on first use; research code adds its own with Register
+	// before the Window (or benchmark) looks them up.
+	class StereoTechniqueRegistry {
+	public:
+		struct Entry {
+			std::string name;
+			std::string description;
+			StereoTechniqueFactory factory;
+		};
+
+		static StereoTechniqueRegistry& Get();
+
+		// A second registration under the same name replaces the first
+		void Register(const std::string& name, const std::string& description, StereoTechniqueFactory factory);
+		bool Contains(const std::string& name) const;
+		std::unique_ptr<IStereoTechnique> Create(const std::string& name) const;
+		const std::vector<Entry>& GetEntries() const { return _entries; }
+
+	private:
+		StereoTechniqueRegistry() = default;
+
+		std::vector<Entry> _entries;
+	};
+
+	// Adds two-pass, reprojection-mask, the three reprojection paths and the single-pass modes
+	void RegisterBuiltInStereoTechniques(StereoTechniqueRegistry& registry);
+}
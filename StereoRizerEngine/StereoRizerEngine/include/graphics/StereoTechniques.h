@@ -0,0 +1,111 @@
+#pragma once
+
+#include "StereoTechnique.h"
+
+namespace stereorizer::graphics
+{
+	// Both eyes rendered in full, one Renderer pass each. Base of the techniques that only
+	// change how the right eye is produced from the finished left one.
+	class TwoPassTechnique : public IStereoTechnique {
+	public:
+		const char* GetName() const override { return "two-pass"; }
+
+	protected:
+		void SelectVariants(const std::vector<std::shared_ptr<Model>>& models) override;
+		void RenderViews(const StereoScene& scene, Renderer& leftView, Renderer& rightView, StereoTargets& targets) override;
+
+		// The left eye builds its depth pyramid only when the right eye tests blocks against it
+		virtual bool UsesLeftDepthPyramid() const { return false; }
+		// Called with the left eye's textures complete, leaves the right eye in rightView's
+		// targets and updates the reuse stat
+		virtual void RenderRightEye(Renderer& leftView, Renderer& rightView);
+	};
+
+	// Shades the right eye in full, but every fragment the left eye explains shows the left
+	// color, the rest the mismatch color. Counts both kinds on the GPU.
+	class ReprojectionMaskTechnique : public TwoPassTechnique {
+	public:
+		~ReprojectionMaskTechnique() override;
+
+		const char* GetName() const override { return "reprojection-mask"; }
+		void DrawSettings(Renderer& leftView, Renderer& rightView) override;
+
+	protected:
+		void RenderRightEye(Renderer& leftView, Renderer& rightView) override;
+
+	private:
+		GLuint _counterBuffer = 0;
+		GLsync _countersFence = nullptr;	// set once the pass writing the counters is submitted
+		GLuint _reprojectedFragments = 0;
+		GLuint _mismatchedFragments = 0;
+
+		// Picks up the previous frame's counts without waiting, dropped while the GPU is still on them
+		void ReadCounters();
+	};
+
+	// See Renderer::RenderToTexturesStencilMasked
+	class StencilReprojectionTechnique : public TwoPassTechnique {
+	public:
+		const char* GetName() const override { return "stencil-reprojection"; }
+		void DrawSettings(Renderer& leftView, Renderer& rightView) override;
+
+	protected:
+		bool UsesDepthPrepass() const override { return true; }
+		bool UsesLeftDepthPyramid() const override { return true; }
+		void RenderRightEye(Renderer& leftView, Renderer& rightView) override;
+	};
+
+	// See Renderer::RenderToTexturesTiled
+	class TileReprojectionTechnique : public TwoPassTechnique {
+	public:
+		const char* GetName() const override { return "tile-reprojection"; }
+		void DrawSettings(Renderer& leftView, Renderer& rightView) override;
+
+	protected:
+		bool UsesDepthPrepass() const override { return true; }
+		bool UsesLeftDepthPyramid() const override { return true; }
+		void RenderRightEye(Renderer& leftView, Renderer& rightView) override;
+	};
+
+	// See Renderer::RenderToTexturesForward
+	class ForwardReprojectionTechnique : public TwoPassTechnique {
+	public:
+		const char* GetName() const override { return "forward-reprojection"; }
+		void DrawSettings(Renderer& leftView, Renderer& rightView) override;
+
+	protected:
+		void RenderRightEye(Renderer& leftView, Renderer& rightView) override;
+	};
+
+	// Both eyes in one pass into the layers of the shared StereoRenderTarget, via
+	// GL_OVR_multiview2 or one instance per eye depending on the layout
+	class SinglePassTechnique : public IStereoTechnique {
+	public:
+		explicit SinglePassTechnique(StereoLayout layout) : _layout(layout) {}
+
+	protected:
+		void SelectVariants(const std::vector<std::shared_ptr<Model>>& models) override;
+		void RenderViews(const StereoScene& scene, Renderer& leftView, Renderer& rightView, StereoTargets& targets) override;
+
+	private:
+		StereoLayout _layout;
+	};
+
+	class MultiviewTechnique : public SinglePassTechnique {
+	public:
+		MultiviewTechnique() : SinglePassTechnique(StereoLayout::Multiview) {}
+
+		const char* GetName() const override { return "multiview"; }
+		bool IsSupported() const override { return StereoRenderTarget::IsMultiviewSupported(); }
+	};
+
+	// Routes instances with gl_Layer when the vertex shader may write it, else side-by-side
+	class InstancedTechnique : public SinglePassTechnique {
+	public:
+		InstancedTechnique()
+			: SinglePassTechnique(StereoRenderTarget::IsVertexLayerSupported() ? StereoLayout::Layered : StereoLayout::SideBySide) {}
+
+		const char* GetName() const override { return "instanced"; }
+		void DrawSettings(Renderer& leftView, Renderer& rightView) override;
+	};
+}
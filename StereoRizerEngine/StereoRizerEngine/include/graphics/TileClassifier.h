@@ -0,0 +1,79 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <GL/glew.h>
+
+#include "Shader.h"
+#include "DepthPyramid.h"
+
+namespace stereorizer::graphics
+{
+	// Screen rectangle of the right view, in pixels
+	struct TileRect {
+		int x = 0;
+		int y = 0;
+		int width = 0;
+		int height = 0;
+	};
+
+	struct TileStats {
+		int tileCount = 0;
+		int shadedTileCount = 0;
+		int scissorPassCount = 0;
+		float averageFailure = 0.0f;	// Mean fraction of pixels per tile that failed reprojection
+	};
+
+	// Splits the right view into TileSize x TileSize tiles and tests every pixel against the left eye
+	// in one compute dispatch. Reprojectable pixels are copied into the right color target on the way,
+	// tiles whose failure fraction exceeds the threshold end up in a compact list to be re-rendered.
+	class TileClassifier {
+	public:
+		// Matches the compute work group size, injected into the shader as TILE_SIZE
+		static constexpr int TileSize = 16;
+		// More re-render rectangles than this are collapsed into their bounding box
+		static constexpr int MaxScissorPasses = 32;
+
+		TileClassifier();
+		~TileClassifier();
+
+		TileClassifier(const TileClassifier&) = delete;
+		TileClassifier& operator=(const TileClassifier&) = delete;
+
+		// Tiles with a larger fraction of failing pixels are re-rendered, 0 re-renders any failure
+		void SetFailureThreshold(float threshold) { _failureThreshold = threshold; }
+		float GetFailureThreshold() const { return _failureThreshold; }
+
+		// Runs the classification and reads the tile list back. rightDepthTexture is the depth
+		// prepass of the right eye, rightColorTexture receives the reprojected pixels. A left depth
+		// pyramid, when given, settles whole blocks before the per-pixel test.
+		bool Classify(GLuint rightDepthTexture, GLuint leftDepthTexture, GLuint leftColorTexture,
+			GLuint rightColorTexture, int width, int height, const DepthPyramid* leftPyramid = nullptr);
+
+		// Merged rectangles covering every tile that needs real shading, valid after Classify
+		const std::vector<TileRect>& GetShadeRects() const { return _shadeRects; }
+		// Failing pixel fraction of every tile, row-major from the bottom left
+		const std::vector<float>& GetTileFailure() const { return _tileFailure; }
+		const TileStats& GetStats() const { return _stats; }
+		int GetTilesX() const { return _tilesX; }
+		int GetTilesY() const { return _tilesY; }
+
+	private:
+		std::shared_ptr<Shader> _shader = nullptr;
+		GLuint _failureBuffer = 0;	// Failed pixel count per tile
+		GLuint _listBuffer = 0;		// Counter followed by the indices of tiles to shade
+		int _tilesX = 0;
+		int _tilesY = 0;
+		int _width = 0;
+		int _height = 0;
+		float _failureThreshold = 0.0f;
+
+		std::vector<TileRect> _shadeRects;
+		std::vector<float> _tileFailure;
+		TileStats _stats;
+
+		bool CreateResources(int width, int height);
+		void DeleteBuffers();
+		void BuildShadeRects(std::vector<GLuint>& tiles);
+	};
+}
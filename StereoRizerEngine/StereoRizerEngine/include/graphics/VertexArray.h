@@ -18,7 +18,13 @@ namespace stereorizer::graphics
 		VertexArray();
 		~VertexArray();
 
+		GLuint getId() const { return id; }
+
 		void drawArray(const VertexBuffer& vertexBuffer, DrawType drawType);
 		void drawElements(const ElementBuffer& elementBuffer, DrawType drawType);
+		void drawArrayInstanced(const VertexBuffer& vertexBuffer, DrawType drawType, int instanceCount);
+		void drawElementsInstanced(const ElementBuffer& elementBuffer, DrawType drawType, int instanceCount);
+		// Command read from the bound GL_DRAW_INDIRECT_BUFFER at commandOffset, firstIndex in elements of elementBuffer
+		void drawElementsIndirect(const ElementBuffer& elementBuffer, DrawType drawType, GLintptr commandOffset);
 	};
 }
@@ -16,6 +16,24 @@ namespace stereorizer::graphics
 
 	};
 
+	// One vertex attribute, bound to the location of its index in the layout
+	struct VertexAttribute
+	{
+		GLint components = 0;
+		GLenum type = GL_FLOAT;
+		GLboolean normalized = GL_FALSE;
+		GLuint offset = 0;		// bytes from the start of the vertex
+	};
+
+	struct VertexLayout
+	{
+		std::vector<VertexAttribute> attributes;
+		GLsizei stride = 0;		// bytes per vertex
+
+		// Tightly packed float attributes of the given component counts
+		static VertexLayout fromFloatSizes(const std::vector<uint32_t>& attributeSizes);
+	};
+
 	class VertexArray;
 
 	class VertexBuffer
@@ -26,15 +44,23 @@ namespace stereorizer::graphics
 		const int vertexCount;
 
 		VertexBuffer(VertexArray& vertexArray, const std::vector<float>& vertices, const std::vector<uint32_t>& attributeSizes, BufferAccessType accessType, BufferCallType callType);
+		// Immutable storage filled straight from data, e.g. a mapped file, nothing is copied on the CPU.
+		// Null data leaves it undefined, to be filled by a buffer copy.
+		VertexBuffer(VertexArray& vertexArray, const void* data, size_t size, const VertexLayout& layout);
 
 		~VertexBuffer()
 		{
 			glDeleteBuffers(1, &id);
 		}
 
+		GLuint getId() const { return id; }
+
 		//offset of a attribute(not in bytes)
 		static const uint32_t attributeOffset(const std::vector<uint32_t>& attributeSizes, uint32_t index);
 		//total size of attributes(not in bytes)
 		static const uint32_t stride(const std::vector<uint32_t>& attributeSizes);
+
+	private:
+		static void setupAttributes(const VertexLayout& layout);
 	};
 }
\ No newline at end of file
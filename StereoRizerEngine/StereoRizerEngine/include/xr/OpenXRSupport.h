@@ -1,16 +1,20 @@
 #pragma once
 #define _CRT_SECURE_NO_WARNINGS
 
+#ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
 #include <unknwn.h>
+#define XR_USE_PLATFORM_WIN32
+#endif
 
 #define XR_USE_GRAPHICS_API_OPENGL
-#define XR_USE_PLATFORM_WIN32
 #include "openxr/openxr.h"
 #include "openxr/openxr_platform.h"
 
 #include <vector>
+#include <tuple>
+#include <cstring>
 #include <iostream>
 
 #include <GL/glew.h>
@@ -95,8 +99,10 @@ namespace stereorizer::xr
         // openxr rendering
         XrSwapchainData _swapchains[2];
 
+#ifdef _WIN32
         HGLRC xrSessionGLRC = nullptr;
         HDC xrSessionDC = nullptr;
+#endif
 
         // internal helpers
         std::tuple<uint32_t, uint32_t> CreateXRSwapchains();
@@ -0,0 +1,45 @@
+#shader compute
+#version 450 core
+
+// One dispatch per level. FIRST_LEVEL copies the depth texture, otherwise the previous level is reduced.
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(rg32f, binding = 0) uniform writeonly image2D dstLevel;   // r = nearest, g = farthest
+
+#ifdef FIRST_LEVEL
+uniform sampler2D depthTexture;
+#else
+layout(rg32f, binding = 1) uniform readonly image2D srcLevel;
+#endif
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 dstSize = imageSize(dstLevel);
+    if (any(greaterThanEqual(pixel, dstSize)))
+        return;
+
+#ifdef FIRST_LEVEL
+    float depth = texelFetch(depthTexture, pixel, 0).r;
+#ifdef HOLES_AS_FAR
+    // Forward reprojection holes can show anything, count them as far for culling
+    if (depth < 0.0)
+        depth = 1.0;
+#endif
+    imageStore(dstLevel, pixel, vec4(depth, depth, 0.0, 0.0));
+#else
+    ivec2 srcSize = imageSize(srcLevel);
+    ivec2 first = pixel * 2;
+    // Odd source sizes fold their last row/column into the last destination texel
+    ivec2 last = min(mix(first + 1, srcSize - 1, equal(pixel, dstSize - 1)), srcSize - 1);
+
+    vec2 range = vec2(1.0, 0.0);
+    for (int y = first.y; y <= last.y; y++) {
+        for (int x = first.x; x <= last.x; x++) {
+            vec2 texel = imageLoad(srcLevel, ivec2(x, y)).rg;
+            range = vec2(min(range.x, texel.x), max(range.y, texel.y));
+        }
+    }
+    imageStore(dstLevel, pixel, vec4(range, 0.0, 0.0));
+#endif
+}
@@ -0,0 +1,128 @@
+#shader compute
+#version 450 core
+
+// GROUP_SIZE is injected by ForwardReprojector, which also enables one stage define per dispatch:
+// SCATTER_DEPTH and RESOLVE_COLOR run over the left view, FILL_HOLES over the right view
+layout(local_size_x = GROUP_SIZE, local_size_y = GROUP_SIZE) in;
+
+// Written once per frame by FrameUniformBuffer, index 0 is the left eye, 1 the right eye
+layout(std140, binding = 0) uniform FrameData {
+    mat4 frameViewMatrix[2];
+    mat4 frameProjectionMatrix[2];
+    mat4 frameInverseViewMatrix[2];
+    mat4 frameInverseProjectionMatrix[2];
+    mat4 frameRightClipToLeftClip;
+    mat4 frameLeftClipToRightClip;
+};
+
+// Nothing scattered here yet, larger than the bits of any depth in [0,1]
+const uint EMPTY_DEPTH = 0xFFFFFFFFu;
+
+// Nearest scattered depth per right pixel, as float bits so atomicMin orders them
+layout(r32ui, binding = 0) uniform coherent uimage2D scatterDepthImage;
+layout(rgba8, binding = 1) uniform image2D scatterColorImage;
+
+#if defined(SCATTER_DEPTH) || defined(RESOLVE_COLOR)
+uniform sampler2D leftDepthTexture;    // Depth map from left renderer
+uniform sampler2D leftColorTexture;    // Color map from left renderer
+
+// Right pixel and window depth a left pixel lands on, false if it leaves the right frustum
+bool ScatterTarget(ivec2 leftPixel, out ivec2 rightPixel, out float rightDepth)
+{
+    ivec2 leftSize = textureSize(leftDepthTexture, 0);
+    ivec2 rightSize = imageSize(scatterDepthImage);
+
+    float leftDepthValue = texelFetch(leftDepthTexture, leftPixel, 0).r;
+    vec2 leftScreenCoord = (vec2(leftPixel) + 0.5) / vec2(leftSize);
+    vec4 clipPos = vec4(vec3(leftScreenCoord, leftDepthValue) * 2.0 - 1.0, 1.0);
+
+    // Left clip space straight to RIGHT camera clip space (precomputed on the CPU)
+    vec4 rightClipPos = frameLeftClipToRightClip * clipPos;
+    if (rightClipPos.w <= 0.0)
+        return false;
+
+    vec3 rightNdcPos = rightClipPos.xyz / rightClipPos.w;
+    rightPixel = ivec2(floor((rightNdcPos.xy * 0.5 + 0.5) * vec2(rightSize)));
+    rightDepth = clamp(rightNdcPos.z * 0.5 + 0.5, 0.0, 1.0);
+    return all(greaterThanEqual(rightPixel, ivec2(0))) && all(lessThan(rightPixel, rightSize));
+}
+#endif
+
+#ifdef FILL_HOLES
+uniform int fillRadius;                // Largest gap radius closed by dilation, wider holes are re-rendered
+
+layout(rgba8, binding = 2) uniform writeonly image2D rightColorImage;
+layout(r32f, binding = 3) uniform writeonly image2D resolvedDepthImage;   // Negative marks a hole
+
+layout(std430, binding = 1) buffer ReprojectionCounters {
+    uint filledPixels;
+    uint holePixels;
+};
+#endif
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+
+#if defined(SCATTER_DEPTH) || defined(RESOLVE_COLOR)
+    if (any(greaterThanEqual(pixel, textureSize(leftDepthTexture, 0))))
+        return;
+
+    ivec2 rightPixel;
+    float rightDepth;
+    if (!ScatterTarget(pixel, rightPixel, rightDepth))
+        return;
+
+#ifdef SCATTER_DEPTH
+    // Pass 1: nearest depth wins
+    imageAtomicMin(scatterDepthImage, rightPixel, floatBitsToUint(rightDepth));
+#else
+    // Pass 2: only the winner of pass 1 writes its color
+    if (imageLoad(scatterDepthImage, rightPixel).r == floatBitsToUint(rightDepth))
+        imageStore(scatterColorImage, rightPixel, texelFetch(leftColorTexture, pixel, 0));
+#endif
+#endif
+
+#ifdef FILL_HOLES
+    ivec2 size = imageSize(scatterDepthImage);
+    if (any(greaterThanEqual(pixel, size)))
+        return;
+
+    uint depthBits = imageLoad(scatterDepthImage, pixel).r;
+    vec4 color = vec4(0.0);
+    float depth = -1.0;
+    if (depthBits != EMPTY_DEPTH) {
+        color = imageLoad(scatterColorImage, pixel);
+        depth = uintBitsToFloat(depthBits);
+    }
+    else {
+        // Depth-aware dilation: gaps open up behind foreground edges, so fill from the farthest neighbour
+        uint farthest = 0u;
+        ivec2 farthestPixel = ivec2(-1);
+        for (int y = -fillRadius; y <= fillRadius; y++) {
+            for (int x = -fillRadius; x <= fillRadius; x++) {
+                ivec2 neighbour = pixel + ivec2(x, y);
+                if (any(lessThan(neighbour, ivec2(0))) || any(greaterThanEqual(neighbour, size)))
+                    continue;
+                uint neighbourBits = imageLoad(scatterDepthImage, neighbour).r;
+                if (neighbourBits != EMPTY_DEPTH && neighbourBits >= farthest) {
+                    farthest = neighbourBits;
+                    farthestPixel = neighbour;
+                }
+            }
+        }
+
+        if (farthestPixel.x >= 0) {
+            color = imageLoad(scatterColorImage, farthestPixel);
+            depth = uintBitsToFloat(farthest);
+            atomicAdd(filledPixels, 1u);
+        }
+        else {
+            atomicAdd(holePixels, 1u);
+        }
+    }
+
+    imageStore(rightColorImage, pixel, color);
+    imageStore(resolvedDepthImage, pixel, vec4(depth));
+#endif
+}
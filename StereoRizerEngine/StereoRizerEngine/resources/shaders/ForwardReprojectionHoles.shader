@@ -0,0 +1,35 @@
+#shader vertex
+#version 450 core
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoords;
+
+void main()
+{
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+
+#shader fragment
+#version 450 core
+
+layout(location = 0) out vec4 color;
+
+uniform sampler2D resolvedDepthTexture;   // Forward reprojection depth, negative on holes
+
+void main()
+{
+    float depth = texelFetch(resolvedDepthTexture, ivec2(gl_FragCoord.xy), 0).r;
+
+#ifdef MARK_HOLES
+    // Only holes pass, they get the stencil bit for the geometric re-render
+    if (depth >= 0.0)
+        discard;
+#else
+    // Reprojected pixels restore their depth, holes keep the cleared depth
+    if (depth < 0.0)
+        discard;
+    gl_FragDepth = depth;
+#endif
+
+    color = vec4(0.0);
+}
@@ -0,0 +1,106 @@
+#shader compute
+#version 450 core
+
+// One invocation per model, see OcclusionCuller
+layout(local_size_x = 64) in;
+
+// Written once per frame by FrameUniformBuffer, index 0 is the left eye, 1 the right eye
+layout(std140, binding = 0) uniform FrameData {
+    mat4 frameViewMatrix[2];
+    mat4 frameProjectionMatrix[2];
+};
+
+struct CullObject {
+    mat4 modelMatrix;
+    vec3 boundsMin;
+    uint indexCount;                   // packs into the vec3's last 4 bytes under std430
+    vec3 boundsMax;
+    uint padding;
+};
+
+struct DrawElementsIndirectCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout(std430, binding = 1) readonly buffer CullObjects {
+    CullObject objects[];
+};
+
+layout(std430, binding = 2) writeonly buffer DrawCommands {
+    DrawElementsIndirectCommand commands[];
+};
+
+layout(std430, binding = 3) buffer CullCounters {
+    uint visibleCount;
+};
+
+uniform sampler2D depthPyramid;        // r = nearest, g = farthest depth per block
+uniform int eyeIndex;
+uniform uint objectCount;
+
+bool IsVisible(CullObject object)
+{
+    mat4 viewProjection = frameProjectionMatrix[eyeIndex] * frameViewMatrix[eyeIndex] * object.modelMatrix;
+
+    vec2 screenMin = vec2(1.0);
+    vec2 screenMax = vec2(0.0);
+    float nearestDepth = 1.0;
+    for (int i = 0; i < 8; i++) {
+        vec3 corner = mix(object.boundsMin, object.boundsMax, vec3(i & 1, (i >> 1) & 1, (i >> 2) & 1));
+        vec4 clipPos = viewProjection * vec4(corner, 1.0);
+        // Crossing the near plane, nothing conservative to say
+        if (clipPos.w <= 0.0)
+            return true;
+        vec3 ndcPos = clipPos.xyz / clipPos.w;
+        screenMin = min(screenMin, ndcPos.xy * 0.5 + 0.5);
+        screenMax = max(screenMax, ndcPos.xy * 0.5 + 0.5);
+        nearestDepth = min(nearestDepth, ndcPos.z * 0.5 + 0.5);
+    }
+
+    screenMin = clamp(screenMin, 0.0, 1.0);
+    screenMax = clamp(screenMax, 0.0, 1.0);
+    if (any(greaterThanEqual(screenMin, screenMax)))
+        return false;              // Entirely off screen
+
+    // Level where the rectangle spans at most 2x2 texels, then the farthest depth under it
+    ivec2 baseSize = textureSize(depthPyramid, 0);
+    vec2 extent = (screenMax - screenMin) * vec2(baseSize);
+    int levelCount = textureQueryLevels(depthPyramid);
+    int level = clamp(int(ceil(log2(max(max(extent.x, extent.y), 1.0)))), 0, levelCount - 1);
+
+    ivec2 levelSize = textureSize(depthPyramid, level);
+    ivec2 texelMin = min(ivec2(screenMin * vec2(baseSize)) >> level, levelSize - 1);
+    ivec2 texelMax = min(ivec2(screenMax * vec2(baseSize)) >> level, levelSize - 1);
+
+    float farthestDepth = 0.0;
+    for (int y = texelMin.y; y <= texelMax.y; y++) {
+        for (int x = texelMin.x; x <= texelMax.x; x++) {
+            farthestDepth = max(farthestDepth, texelFetch(depthPyramid, ivec2(x, y), level).g);
+        }
+    }
+
+    return nearestDepth <= farthestDepth;
+}
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= objectCount)
+        return;
+
+    CullObject object = objects[index];
+    bool visible = object.indexCount > 0u && IsVisible(object);
+
+    commands[index].count = object.indexCount;
+    commands[index].instanceCount = visible ? 1u : 0u;
+    commands[index].firstIndex = 0u;
+    commands[index].baseVertex = 0;
+    commands[index].baseInstance = 0u;
+
+    if (visible)
+        atomicAdd(visibleCount, 1u);
+}
@@ -1,12 +1,54 @@
 #shader vertex
 #version 450 core
+#ifdef USE_MULTIVIEW
+#extension GL_OVR_multiview2 : require
+layout(num_views = 2) in;
+#endif
+#ifdef USE_STEREO_LAYER
+#extension GL_ARB_shader_viewport_layer_array : require
+#endif
 
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 
+// Must match the fragment stage and graphics::LightBlock
+struct Light {
+    int type;
+    vec3 position;
+    vec3 direction;
+    vec3 color;
+    float intensity;
+    vec3 attenuation;
+    float innerConeAngle;
+    float outerConeAngle;
+};
+
+// Written once per frame by FrameUniformBuffer, index 0 is the left eye, 1 the right eye
+layout(std140, binding = 0) uniform FrameData {
+    mat4 frameViewMatrix[2];
+    mat4 frameProjectionMatrix[2];
+    mat4 frameInverseViewMatrix[2];
+    mat4 frameInverseProjectionMatrix[2];
+    mat4 frameRightClipToLeftClip;
+    mat4 frameLeftClipToRightClip;
+    Light light;
+};
+
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
+uniform mat3 normalMatrix;   // transpose(inverse(modelMatrix)), computed per model on the CPU
+
+#if defined(USE_MULTIVIEW)
+#define VIEW_INDEX int(gl_ViewID_OVR)
+#elif defined(USE_INSTANCED_STEREO)
+// Instanced stereo: every mesh is drawn with two instances, even = left, odd = right
+#define VIEW_INDEX (gl_InstanceID & 1)
+#else
+// Two-pass: each renderer selects its eye
+uniform int eyeIndex;
+#define VIEW_INDEX eyeIndex
+#endif
+#define VIEW_MATRIX frameViewMatrix[VIEW_INDEX]
+#define PROJECTION_MATRIX frameProjectionMatrix[VIEW_INDEX]
 
 out vec3 Normal;
 out vec3 FragPos;
@@ -16,12 +58,24 @@ out vec4 ClipSpacePos;
 void main()
 {
     FragPos = vec3(modelMatrix * vec4(position, 1.0));
-    WorldNormal = mat3(transpose(inverse(modelMatrix))) * normal;
+    WorldNormal = normalMatrix * normal;
     Normal = WorldNormal;
     
-    gl_Position = projectionMatrix * viewMatrix * vec4(FragPos, 1.0);
+    gl_Position = PROJECTION_MATRIX * VIEW_MATRIX * vec4(FragPos, 1.0);
 
     ClipSpacePos = gl_Position;
+
+#ifdef USE_INSTANCED_STEREO
+#ifdef USE_STEREO_LAYER
+    gl_Layer = VIEW_INDEX;
+#else
+    // Side-by-side: squeeze the eye into its half of the double-wide target
+    // and clip against the seam so it can't bleed into the other eye
+    float eyeSign = VIEW_INDEX == 0 ? -1.0 : 1.0;
+    gl_ClipDistance[0] = gl_Position.w + eyeSign * gl_Position.x;
+    gl_Position.x = gl_Position.x * 0.5 + eyeSign * gl_Position.w * 0.5;
+#endif
+#endif
 }
 
 #shader fragment
@@ -41,7 +95,17 @@ struct Light {
     float outerConeAngle;  // Outer cone angle for spot lights (radians)
 };
 
-uniform Light light;
+// Written once per frame by FrameUniformBuffer, index 0 is the left eye, 1 the right eye
+layout(std140, binding = 0) uniform FrameData {
+    mat4 frameViewMatrix[2];
+    mat4 frameProjectionMatrix[2];
+    mat4 frameInverseViewMatrix[2];
+    mat4 frameInverseProjectionMatrix[2];
+    mat4 frameRightClipToLeftClip;
+    mat4 frameLeftClipToRightClip;
+    Light light;
+};
+
 uniform vec3 viewPos;      // Camera position in world space
 uniform vec3 materialColor; // Material diffuse color
 
@@ -54,13 +118,14 @@ in vec4 ClipSpacePos;
 uniform sampler2D leftDepthTexture;    // Depth map from left renderer
 uniform sampler2D leftColorTexture;    // Color map from left renderer  
 
-// Camera matrices for left renderer
-uniform mat4 leftViewMatrix;           // Left camera view matrix
-uniform mat4 leftProjectionMatrix;     // Left camera projection matrix
+// Only fragments that survive the depth test are counted
+layout(early_fragment_tests) in;
 
-uniform mat4 viewMatrix;               // Right camera view matrix
-uniform mat4 projectionMatrix;         // Right camera projection matrix
-uniform mat4 modelMatrix;
+// Cleared and read back by the reprojection-mask technique
+layout(std430, binding = 1) buffer ReprojectionMaskCounters {
+    uint reprojectedFragments;
+    uint mismatchedFragments;
+};
 #endif
 
 const vec3 MISMATCH_COLOR = vec3(1.0, 0.078, 0.576); // Pink color for mismatches
@@ -125,6 +190,11 @@ vec2 ProjectToScreen(vec3 worldPos, mat4 viewMatrix, mat4 projectionMatrix)
 
 void main()
 {
+#ifdef DEPTH_ONLY
+    // Depth prepass of the stencil-masked right eye, nothing to shade
+    color = vec4(0.0);
+    return;
+#endif
     vec3 norm = normalize(Normal);
     vec3 lightContribution;
     
@@ -159,32 +229,28 @@ void main()
     vec2 rightScreenCoord = ndcPos.xy * 0.5 + 0.5;
     float rightDepthValue = ndcPos.z * 0.5 + 0.5; // Convert Z from [-1,1] to [0,1]
     
-    // Step 4: Reconstruct world position using inverse matrices
-    mat4 invViewMatrix = inverse(viewMatrix);
-    mat4 invProjectionMatrix = inverse(projectionMatrix);
-    // Fragment shader
-    vec4 viewPos = inverse(projectionMatrix) * clipPos;
-    viewPos /= viewPos.w; // divide by w to go from clip to view space
+    // Step 4: Right clip space straight to LEFT camera clip space (precomputed on the CPU)
+    vec4 leftClipPos = frameRightClipToLeftClip * clipPos;
 
-    vec4 worldPos = inverse(viewMatrix) * viewPos;
-    vec3 worldPosition = worldPos.xyz / worldPos.w;
-    
-    // Step 5: Project world position to LEFT camera screen coordinates
-    vec2 leftScreenCoord = ProjectToScreen(worldPosition, leftViewMatrix, leftProjectionMatrix);
+    // Step 5: LEFT camera screen coordinates
+    vec2 leftScreenCoord = (leftClipPos.xy / leftClipPos.w) * 0.5 + 0.5;
 
     float leftDepthValue = texture(leftDepthTexture, leftScreenCoord).r;
     
     // Skip if no valid depth in left camera
     if (leftDepthValue >= 1.0) {
+        atomicAdd(mismatchedFragments, 1u);
         color = vec4(MISMATCH_COLOR, 1.0);
         return;
     }
 
     if (abs(leftDepthValue - rightDepthValue) <= 0.002) {
         vec4 leftColorValue = texture(leftColorTexture, leftScreenCoord);
+        atomicAdd(reprojectedFragments, 1u);
         color = leftColorValue;
     } else {
         // Depth mismatch - render pinkrightScreenCoord
+        atomicAdd(mismatchedFragments, 1u);
         color = vec4(MISMATCH_COLOR, 1.0);
     }
 #else
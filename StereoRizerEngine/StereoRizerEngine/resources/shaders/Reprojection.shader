@@ -3,9 +3,17 @@
 
 layout(location = 0) in vec4 position;
 
+// Written once per frame by FrameUniformBuffer, index 0 is the left eye, 1 the right eye
+layout(std140, binding = 0) uniform FrameData {
+    mat4 frameViewMatrix[2];
+    mat4 frameProjectionMatrix[2];
+    mat4 frameInverseViewMatrix[2];
+    mat4 frameInverseProjectionMatrix[2];
+    mat4 frameRightClipToLeftClip;
+    mat4 frameLeftClipToRightClip;
+};
+
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projectionMatrix;
 
 out vec4 ClipSpacePos;  // Save the position assigned to gl_Position
 
@@ -13,7 +21,7 @@ void main()
 {
     // Transform vertex to world space then to clip space
     vec4 worldPos = modelMatrix * position;
-    gl_Position = projectionMatrix * viewMatrix * worldPos;
+    gl_Position = frameProjectionMatrix[1] * frameViewMatrix[1] * worldPos;
     
     // Pass the clip space position (same as gl_Position) to fragment shader
     ClipSpacePos = gl_Position;
@@ -30,14 +38,15 @@ in vec4 ClipSpacePos;  // Clip space position from vertex shader (same as gl_Pos
 uniform sampler2D leftDepthTexture;    // Depth map from left renderer
 uniform sampler2D leftColorTexture;    // Color map from left renderer  
 
-// Camera matrices for left renderer
-uniform mat4 leftViewMatrix;           // Left camera view matrix
-uniform mat4 leftProjectionMatrix;     // Left camera projection matrix
-
-// Camera matrices for right renderer (current)
-uniform mat4 viewMatrix;               // Right camera view matrix
-uniform mat4 projectionMatrix;         // Right camera projection matrix
-uniform mat4 modelMatrix;
+// Camera matrices for both eyes, the right eye (index 1) is the one being rendered
+layout(std140, binding = 0) uniform FrameData {
+    mat4 frameViewMatrix[2];
+    mat4 frameProjectionMatrix[2];
+    mat4 frameInverseViewMatrix[2];
+    mat4 frameInverseProjectionMatrix[2];
+    mat4 frameRightClipToLeftClip;
+    mat4 frameLeftClipToRightClip;
+};
 
 // Camera parameters
 uniform float nearPlane;
@@ -97,18 +106,11 @@ void main()
     vec2 rightScreenCoord = ndcPos.xy * 0.5 + 0.5;
     float rightDepthValue = ndcPos.z * 0.5 + 0.5; // Convert Z from [-1,1] to [0,1]
     
-    // Step 4: Reconstruct world position using inverse matrices
-    mat4 invViewMatrix = inverse(viewMatrix);
-    mat4 invProjectionMatrix = inverse(projectionMatrix);
-    // Fragment shader
-    vec4 viewPos = inverse(projectionMatrix) * clipPos;
-    viewPos /= viewPos.w; // divide by w to go from clip to view space
-
-    vec4 worldPos = inverse(viewMatrix) * viewPos;
-    vec3 worldPosition = worldPos.xyz / worldPos.w;
-    
-    // Step 5: Project world position to LEFT camera screen coordinates
-    vec2 leftScreenCoord = ProjectToScreen(worldPosition, leftViewMatrix, leftProjectionMatrix);
+    // Step 4: Right clip space straight to LEFT camera clip space (precomputed on the CPU)
+    vec4 leftClipPos = frameRightClipToLeftClip * clipPos;
+
+    // Step 5: LEFT camera screen coordinates
+    vec2 leftScreenCoord = (leftClipPos.xy / leftClipPos.w) * 0.5 + 0.5;
     
     // Step 6: Check if projection is within left camera's view bounds [0,1]
     if (leftScreenCoord.x < 0.0 || leftScreenCoord.x > 1.0 || 
@@ -0,0 +1,95 @@
+#shader vertex
+#version 450 core
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoords;
+
+out vec2 TexCoords;
+
+void main()
+{
+    TexCoords = texCoords;
+    gl_Position = vec4(position, 0.0, 1.0);
+}
+
+#shader fragment
+#version 450 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 TexCoords;
+
+// Written once per frame by FrameUniformBuffer, index 0 is the left eye, 1 the right eye
+layout(std140, binding = 0) uniform FrameData {
+    mat4 frameViewMatrix[2];
+    mat4 frameProjectionMatrix[2];
+    mat4 frameInverseViewMatrix[2];
+    mat4 frameInverseProjectionMatrix[2];
+    mat4 frameRightClipToLeftClip;
+    mat4 frameLeftClipToRightClip;
+};
+
+uniform sampler2D rightDepthTexture;   // Depth prepass of the right eye
+uniform sampler2D leftDepthTexture;    // Depth map from left renderer
+uniform sampler2D leftColorTexture;    // Color map from left renderer
+
+// Same window-space tolerance as the reprojection mask
+const float DEPTH_TOLERANCE = 0.002;
+
+#ifdef USE_DEPTH_PYRAMID
+uniform sampler2D leftDepthPyramid;    // Min/max blocks of the left depth, see DepthPyramid
+uniform int pyramidLevel;
+
+// Whole-block decision from the pyramid before any full resolution fetch:
+// -1 when no left depth in the block can match, 1 when every one does, 0 when undecided
+int BlockDepthTest(ivec2 leftTexel, float expectedDepth)
+{
+    ivec2 blockSize = textureSize(leftDepthPyramid, pyramidLevel);
+    vec2 block = texelFetch(leftDepthPyramid, min(leftTexel >> pyramidLevel, blockSize - 1), pyramidLevel).rg;
+    if (expectedDepth < block.x - DEPTH_TOLERANCE || expectedDepth > block.y + DEPTH_TOLERANCE)
+        return -1;
+    if (block.x >= expectedDepth - DEPTH_TOLERANCE && block.y <= expectedDepth + DEPTH_TOLERANCE)
+        return 1;
+    return 0;
+}
+#endif
+
+void main()
+{
+    // Step 1: Right eye depth of this pixel, restored into the main depth buffer
+    float rightDepthValue = texelFetch(rightDepthTexture, ivec2(gl_FragCoord.xy), 0).r;
+    gl_FragDepth = rightDepthValue;
+
+    // Step 2: Right clip space straight to LEFT camera clip space (precomputed on the CPU)
+    vec4 clipPos = vec4(vec3(TexCoords, rightDepthValue) * 2.0 - 1.0, 1.0);
+    vec4 leftClipPos = frameRightClipToLeftClip * clipPos;
+    vec3 leftNdcPos = leftClipPos.xyz / leftClipPos.w;
+    vec2 leftScreenCoord = leftNdcPos.xy * 0.5 + 0.5;
+
+    // Step 3: Outside the left frustum, keep the stencil bit
+    if (leftScreenCoord.x < 0.0 || leftScreenCoord.x > 1.0 ||
+        leftScreenCoord.y < 0.0 || leftScreenCoord.y > 1.0) {
+        discard;
+    }
+
+    // Step 4: Left eye saw something else at this point (disocclusion), keep the stencil bit
+    ivec2 leftSize = textureSize(leftDepthTexture, 0);
+    ivec2 leftTexel = min(ivec2(leftScreenCoord * vec2(leftSize)), leftSize - 1);
+    float expectedLeftDepth = leftNdcPos.z * 0.5 + 0.5;
+#ifdef USE_DEPTH_PYRAMID
+    int blockResult = BlockDepthTest(leftTexel, expectedLeftDepth);
+    if (blockResult < 0) {
+        discard;
+    }
+    if (blockResult == 0)
+#endif
+    {
+        float leftDepthValue = texelFetch(leftDepthTexture, leftTexel, 0).r;
+        if (abs(leftDepthValue - expectedLeftDepth) > DEPTH_TOLERANCE) {
+            discard;
+        }
+    }
+
+    // Step 5: Reuse the left eye's shading
+    color = texelFetch(leftColorTexture, leftTexel, 0);
+}
@@ -0,0 +1,105 @@
+#shader compute
+#version 450 core
+
+// TILE_SIZE is injected by TileClassifier
+layout(local_size_x = TILE_SIZE, local_size_y = TILE_SIZE) in;
+
+// Written once per frame by FrameUniformBuffer, index 0 is the left eye, 1 the right eye
+layout(std140, binding = 0) uniform FrameData {
+    mat4 frameViewMatrix[2];
+    mat4 frameProjectionMatrix[2];
+    mat4 frameInverseViewMatrix[2];
+    mat4 frameInverseProjectionMatrix[2];
+    mat4 frameRightClipToLeftClip;
+    mat4 frameLeftClipToRightClip;
+};
+
+uniform sampler2D rightDepthTexture;   // Depth prepass of the right eye
+uniform sampler2D leftDepthTexture;    // Depth map from left renderer
+uniform sampler2D leftColorTexture;    // Color map from left renderer
+uniform float failureThreshold;        // Tiles failing on a larger fraction of pixels get shaded
+
+layout(rgba8, binding = 0) uniform writeonly image2D rightColorImage;
+
+layout(std430, binding = 1) buffer TileFailures {
+    uint tileFailures[];               // Failed pixel count per tile
+};
+
+layout(std430, binding = 2) buffer ShadeList {
+    uint shadeTileCount;
+    uint shadeTiles[];                 // Tile indices that need real shading
+};
+
+// Same window-space tolerance as the reprojection mask
+const float DEPTH_TOLERANCE = 0.002;
+
+#ifdef USE_DEPTH_PYRAMID
+uniform sampler2D leftDepthPyramid;    // Min/max blocks of the left depth, see DepthPyramid
+uniform int pyramidLevel;
+
+// Whole-block decision from the pyramid before any full resolution fetch:
+// -1 when no left depth in the block can match, 1 when every one does, 0 when undecided
+int BlockDepthTest(ivec2 leftTexel, float expectedDepth)
+{
+    ivec2 blockSize = textureSize(leftDepthPyramid, pyramidLevel);
+    vec2 block = texelFetch(leftDepthPyramid, min(leftTexel >> pyramidLevel, blockSize - 1), pyramidLevel).rg;
+    if (expectedDepth < block.x - DEPTH_TOLERANCE || expectedDepth > block.y + DEPTH_TOLERANCE)
+        return -1;
+    if (block.x >= expectedDepth - DEPTH_TOLERANCE && block.y <= expectedDepth + DEPTH_TOLERANCE)
+        return 1;
+    return 0;
+}
+#endif
+
+shared uint failedPixels;
+
+void main()
+{
+    if (gl_LocalInvocationIndex == 0)
+        failedPixels = 0;
+    barrier();
+
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = textureSize(rightDepthTexture, 0);
+    if (all(lessThan(pixel, size))) {
+        // Right clip space straight to LEFT camera clip space (precomputed on the CPU)
+        float rightDepthValue = texelFetch(rightDepthTexture, pixel, 0).r;
+        vec2 rightScreenCoord = (vec2(pixel) + 0.5) / vec2(size);
+        vec4 clipPos = vec4(vec3(rightScreenCoord, rightDepthValue) * 2.0 - 1.0, 1.0);
+        vec4 leftClipPos = frameRightClipToLeftClip * clipPos;
+        vec3 leftNdcPos = leftClipPos.xyz / leftClipPos.w;
+        vec2 leftScreenCoord = leftNdcPos.xy * 0.5 + 0.5;
+
+        bool reprojected = false;
+        if (all(greaterThanEqual(leftScreenCoord, vec2(0.0))) && all(lessThanEqual(leftScreenCoord, vec2(1.0)))) {
+            ivec2 leftSize = textureSize(leftDepthTexture, 0);
+            ivec2 leftTexel = min(ivec2(leftScreenCoord * vec2(leftSize)), leftSize - 1);
+            float expectedLeftDepth = leftNdcPos.z * 0.5 + 0.5;
+#ifdef USE_DEPTH_PYRAMID
+            int blockResult = BlockDepthTest(leftTexel, expectedLeftDepth);
+            if (blockResult != 0)
+                reprojected = blockResult > 0;
+            else
+#endif
+            reprojected = abs(texelFetch(leftDepthTexture, leftTexel, 0).r - expectedLeftDepth) <= DEPTH_TOLERANCE;
+
+            // Copy kernel, failed pixels included: in tiles that are skipped the left color is the
+            // closest guess there is, tiles that get shaded are cleared before they are rendered
+            imageStore(rightColorImage, pixel, texelFetch(leftColorTexture, leftTexel, 0));
+        }
+        if (!reprojected)
+            atomicAdd(failedPixels, 1u);
+    }
+    barrier();
+
+    if (gl_LocalInvocationIndex == 0) {
+        uint tileIndex = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+        ivec2 tileSize = min(size - ivec2(gl_WorkGroupID.xy) * TILE_SIZE, ivec2(TILE_SIZE));
+        tileFailures[tileIndex] = failedPixels;
+
+        if (float(failedPixels) > failureThreshold * float(tileSize.x * tileSize.y)) {
+            uint slot = atomicAdd(shadeTileCount, 1u);
+            shadeTiles[slot] = tileIndex;
+        }
+    }
+}
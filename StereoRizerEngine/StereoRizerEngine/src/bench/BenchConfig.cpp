@@ -0,0 +1,149 @@
+#include "bench/BenchConfig.h"
+#include "core/Common.h"
+#include "graphics/StereoTechnique.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace stereorizer::bench;
+using stereorizer::graphics::StereoTechniqueRegistry;
+
+bool BenchConfig::Load(const std::string& path) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		LOG_ERROR("Failed to open benchmark description: " + path);
+		return false;
+	}
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream stream(line);
+		std::string directive;
+		if (!(stream >> directive))
+			continue;
+
+		auto fail = [&](const std::string& message) {
+			LOG_ERROR(path + ":" + std::to_string(lineNumber) + ": " + message);
+			return false;
+		};
+		auto readVec3 = [&](glm::vec3& v) {
+			return (bool)(stream >> v.x >> v.y >> v.z);
+		};
+		BenchModel* model = models.empty() ? nullptr : &models.back();
+
+		if (directive == "model") {
+			BenchModel newModel;
+			if (!(stream >> newModel.meshPath >> newModel.shaderPath))
+				return fail("expected 'model <mesh> <shader>'");
+			models.push_back(newModel);
+		}
+		else if (directive == "position" || directive == "scale" || directive == "color") {
+			if (!model)
+				return fail(directive + " before any model");
+			glm::vec3& target = directive == "position" ? model->position : directive == "scale" ? model->scale : model->color;
+			if (!readVec3(target))
+				return fail("expected three values");
+		}
+		else if (directive == "rotation") {
+			if (!model)
+				return fail("rotation before any model");
+			if (!(stream >> model->rotationAngle) || !readVec3(model->rotationAxis))
+				return fail("expected 'rotation <degrees> <x> <y> <z>'");
+		}
+		else if (directive == "light") {
+			std::string type;
+			if (!(stream >> type) || (type != "directional" && type != "point") || !readVec3(light.vector))
+				return fail("expected 'light directional|point <x> <y> <z>'");
+			light.point = type == "point";
+		}
+		else if (directive == "light_color") {
+			if (!readVec3(light.color))
+				return fail("expected three values");
+		}
+		else if (directive == "light_intensity") {
+			if (!(stream >> light.intensity))
+				return fail("expected a value");
+		}
+		else if (directive == "path") {
+			if (!(stream >> cameraPath))
+				return fail("expected a file name");
+		}
+		else if (directive == "fov" || directive == "near" || directive == "far" || directive == "ipd" || directive == "timestep") {
+			float& target = directive == "fov" ? fov : directive == "near" ? nearPlane : directive == "far" ? farPlane
+				: directive == "ipd" ? ipd : timestep;
+			if (!(stream >> target) || target <= 0.0f)
+				return fail("expected a positive value");
+		}
+		else if (directive == "frames" || directive == "warmup" || directive == "frames_in_flight") {
+			int& target = directive == "frames" ? frames : directive == "warmup" ? warmupFrames : framesInFlight;
+			if (!(stream >> target) || target < 0)
+				return fail("expected a non-negative count");
+		}
+		else if (directive == "technique") {
+			std::string name;
+			while (stream >> name) {
+				if (!StereoTechniqueRegistry::Get().Contains(name))
+					return fail("unknown technique '" + name + "'");
+				techniques.push_back(name);
+			}
+		}
+		else if (directive == "resolution") {
+			std::string size;
+			while (stream >> size) {
+				BenchResolution resolution;
+				if (std::sscanf(size.c_str(), "%dx%d", &resolution.width, &resolution.height) != 2
+					|| resolution.width < 2 || resolution.height < 1)
+					return fail("expected <width>x<height>, got '" + size + "'");
+				resolutions.push_back(resolution);
+			}
+		}
+		else if (directive == "output") {
+			if (!(stream >> outputPath))
+				return fail("expected a path");
+		}
+		else {
+			return fail("unknown directive '" + directive + "'");
+		}
+	}
+
+	if (techniques.empty())
+		techniques = { StereoTechniqueRegistry::Get().GetEntries().front().name };
+	if (resolutions.empty())
+		resolutions = { { 1280, 720 } };
+	return Validate(path);
+}
+
+bool BenchConfig::Validate(const std::string& source) const {
+	if (models.empty()) {
+		LOG_ERROR(source + ": the scene has no models");
+		return false;
+	}
+	if (cameraPath.empty()) {
+		LOG_ERROR(source + ": no camera path");
+		return false;
+	}
+	if (frames < 1) {
+		LOG_ERROR(source + ": frames must be positive");
+		return false;
+	}
+	if (warmupFrames < 0) {
+		LOG_ERROR(source + ": warmup can't be negative");
+		return false;
+	}
+	if (framesInFlight < 1 || framesInFlight > 3) {
+		LOG_ERROR(source + ": frames_in_flight must be 1-3");
+		return false;
+	}
+	if (techniques.empty() || resolutions.empty()) {
+		LOG_ERROR(source + ": no technique or resolution to run");
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,55 @@
+#include "bench/BenchConfig.h"
+#include "bench/BenchRunner.h"
+#include "core/Common.h"
+#include "graphics/StereoTechnique.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace stereorizer::bench;
+
+namespace
+{
+	void PrintUsage() {
+		LOG_INFO("Usage: stereorizer_bench <benchmark file> [--frames N] [--output <path without extension>]");
+		std::string names;
+		for (const auto& entry : stereorizer::graphics::StereoTechniqueRegistry::Get().GetEntries())
+			names += " " + entry.name;
+		LOG_INFO("Techniques:" + names);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2 || std::strcmp(argv[1], "--help") == 0) {
+		PrintUsage();
+		return argc < 2 ? 1 : 0;
+	}
+
+	BenchConfig config;
+	if (!config.Load(argv[1]))
+		return 1;
+
+	// Command line overrides the file, handy for quick smoke runs of a full matrix
+	for (int i = 2; i < argc; ++i) {
+		if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			config.frames = std::atoi(argv[++i]);
+		else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+			config.outputPath = argv[++i];
+		else {
+			LOG_ERROR(std::string("Unknown argument: ") + argv[i]);
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	BenchRunner runner(config);
+	if (!runner.Run())
+		return 1;
+
+	bool written = runner.WriteCsv(config.outputPath + ".csv");
+	written = runner.WriteJson(config.outputPath + ".json") && written;
+	if (written)
+		LOG_INFO("Results written to " + config.outputPath + ".csv and " + config.outputPath + ".json");
+	return written ? 0 : 1;
+}
@@ -0,0 +1,317 @@
+#include "bench/BenchRunner.h"
+#include "core/Common.h"
+#include "graphics/AssetLoader.h"
+#include "graphics/Mesh.h"
+#include "graphics/Model.h"
+#include "graphics/Shader.h"
+#include "graphics/Light.h"
+#include "graphics/GpuProfiler.h"
+#include "graphics/GLStateCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <utility>
+
+using namespace stereorizer::bench;
+using namespace stereorizer::core;
+using namespace stereorizer::graphics;
+
+namespace
+{
+	struct Summary {
+		size_t samples = 0;
+		double mean = 0.0;
+		double p50 = 0.0;
+		double p95 = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+	};
+
+	// Exact nearest-rank percentiles, runs are a few hundred frames
+	Summary Summarize(std::vector<double> values) {
+		Summary summary;
+		if (values.empty())
+			return summary;
+
+		std::sort(values.begin(), values.end());
+		auto percentile = [&](double fraction) {
+			size_t rank = (size_t)std::ceil(fraction * values.size());
+			return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+		};
+		summary.samples = values.size();
+		for (double value : values)
+			summary.mean += value;
+		summary.mean /= (double)values.size();
+		summary.p50 = percentile(0.50);
+		summary.p95 = percentile(0.95);
+		summary.p99 = percentile(0.99);
+		summary.max = values.back();
+		return summary;
+	}
+
+	void WriteSummary(std::ostream& out, const char* name, const Summary& summary) {
+		out << "\"" << name << "\": { \"samples\": " << summary.samples
+			<< ", \"mean\": " << summary.mean << ", \"p50\": " << summary.p50
+			<< ", \"p95\": " << summary.p95 << ", \"p99\": " << summary.p99
+			<< ", \"max\": " << summary.max << " }";
+	}
+}
+
+BenchRunner::BenchRunner(BenchConfig config)
+	: _config(std::move(config)) {
+}
+
+BenchRunner::~BenchRunner() {
+	// Meshes own GL buffers, they go before the context does
+	if (_window) {
+		for (const auto& model : _models)
+			_window->RemoveModel(model);
+	}
+	_models.clear();
+	_window.reset();
+}
+
+bool BenchRunner::LoadScene() {
+	if (!_path.Load(_config.cameraPath))
+		return false;
+
+	// All meshes load in parallel on the worker pool, measuring starts once every one is uploaded.
+	// Models sharing a file share its mesh.
+	AssetLoader& loader = *_window->GetAssetLoader();
+	std::vector<MeshHandle> meshes;
+	for (const auto& description : _config.models) {
+		try {
+			MeshHandle mesh = _window->GetMeshManager()->Acquire(description.meshPath);
+			meshes.push_back(mesh);
+			auto shader = std::make_shared<Shader>(description.shaderPath);
+			auto model = std::make_shared<Model>(mesh.mesh, shader);
+			model->Translate(description.position);
+			if (description.rotationAngle != 0.0f)
+				model->Rotate(description.rotationAngle, description.rotationAxis);
+			model->Scale(description.scale);
+			model->SetColor(description.color);
+			_models.push_back(model);
+			_window->AddModel(model);
+		} catch (const std::exception& e) {
+			LOG_ERROR("Failed to load " + description.meshPath + ": " + e.what());
+			return false;
+		}
+	}
+	loader.Finish();
+	for (size_t i = 0; i < meshes.size(); i++) {
+		if (!meshes[i].uploaded.get()) {
+			LOG_ERROR("Failed to load " + _config.models[i].meshPath);
+			return false;
+		}
+	}
+
+	const BenchLight& description = _config.light;
+	auto light = std::make_shared<Light>(description.point ? LightType::Point : LightType::Directional);
+	if (description.point)
+		light->SetPosition(description.vector);
+	else
+		light->SetDirection(description.vector);
+	light->SetColor(description.color);
+	light->SetIntensity(description.intensity);
+	_window->SetLight(light);
+	return true;
+}
+
+bool BenchRunner::Run() {
+	if (!_config.Validate("benchmark config"))
+		return false;
+
+	const BenchResolution& first = _config.resolutions.front();
+	_window = std::make_unique<Window>(first.width, first.height, "StereoRizer Bench", SurfaceBackend::Headless);
+	if (!_window->IsReady()) {
+		LOG_ERROR("No headless GL context, can't benchmark");
+		return false;
+	}
+
+	// Deterministic frames: time comes from the frame index and nothing waits on the clock
+	_window->SetFixedTimestep(_config.timestep);
+	_window->SetTargetFPS(0.0f);
+	_window->SetFramesInFlight(_config.framesInFlight);
+	_window->SetIPD(_config.ipd);
+
+	if (!LoadScene())
+		return false;
+
+	_runs.clear();
+	_frames.clear();
+	for (const auto& resolution : _config.resolutions) {
+		for (const auto& technique : _config.techniques)
+			RunTechnique(technique, resolution);
+	}
+	return true;
+}
+
+void BenchRunner::ApplyCameras(uint64_t frame, const BenchResolution& resolution) {
+	glm::mat4 leftView, rightView;
+	CameraPath::GetEyeViews(_path.Sample(frame, _config.timestep), _config.ipd, leftView, rightView);
+
+	// Each eye gets half of the window
+	float aspect = (float)(resolution.width / 2) / (float)resolution.height;
+	glm::mat4 projection = glm::perspective(glm::radians(_config.fov), aspect, _config.nearPlane, _config.farPlane);
+
+	auto left = _window->GetLeftCamera();
+	auto right = _window->GetRightCamera();
+	left->SetViewMatrix(leftView);
+	left->SetProjectionMatrix(projection);
+	right->SetViewMatrix(rightView);
+	right->SetProjectionMatrix(projection);
+}
+
+void BenchRunner::RunTechnique(const std::string& technique, const BenchResolution& resolution) {
+	BenchRunResult run;
+	run.technique = technique;
+	run.width = resolution.width;
+	run.height = resolution.height;
+	run.firstFrame = _frames.size();
+
+	if (!_window->SetStereoTechnique(technique)) {
+		LOG_ERROR("Skipping " + technique + ", not supported here");
+		run.skipped = true;
+		_runs.push_back(run);
+		return;
+	}
+	_window->SetLeftViewDisplayMode(ViewDisplayMode::Color);
+	_window->SetRightViewDisplayMode(ViewDisplayMode::Color);
+	_window->SetSize(resolution.width, resolution.height);
+
+	LOG_INFO("Running " + technique + " at " + std::to_string(resolution.width) + "x" + std::to_string(resolution.height));
+
+	// Warmup holds the first pose while targets are created and shader variants compiled, the
+	// drain frames only exist to bring back the GPU timings of the last measured ones
+	GpuProfiler* profiler = _window->GetGpuProfiler();
+	uint64_t warmup = (uint64_t)_config.warmupFrames;
+	uint64_t measured = (uint64_t)_config.frames;
+	uint64_t total = warmup + measured + GpuProfiler::FrameLatency;
+	uint64_t measuredStart = _window->GetFrameNumber() + warmup;
+	size_t runIndex = _runs.size();
+	// The technique counts its own renders, one per frame
+	IStereoTechnique* stereoTechnique = _window->GetStereoTechnique();
+	uint64_t measuredRenderStart = stereoTechnique->GetRenderCount() + 1 + warmup;
+
+	for (uint64_t i = 0; i < total; i++) {
+		uint64_t pathFrame = i < warmup ? 0 : std::min(i - warmup, measured - 1);
+		ApplyCameras(pathFrame, resolution);
+
+		auto start = std::chrono::steady_clock::now();
+		_window->RenderFrame();
+		double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		// Blocking on an old frame's fence is GPU time showing up on the CPU, keep it out of the submission cost
+		double fenceWaitMs = _window->GetLastFenceWaitMs();
+		double cpuMs = std::max(frameMs - fenceWaitMs, 0.0);
+
+		if (i >= warmup && i < warmup + measured) {
+			BenchFrameResult result;
+			result.run = runIndex;
+			result.frame = i - warmup;
+			result.cpuMs = cpuMs;
+			result.fenceWaitMs = fenceWaitMs;
+			result.pixelReuse = _window->GetPixelReuseRatio();
+			const GLStateStats& glCalls = GLStateCache::Get().GetFrameStats();
+			result.glCallsIssued = glCalls.issued;
+			result.glCallsSkipped = glCalls.skipped;
+			_frames.push_back(result);
+		}
+
+		uint64_t gpuFrame;
+		double gpuMs;
+		if (profiler->GetLastFrameTime(gpuFrame, gpuMs) && gpuFrame >= measuredStart && gpuFrame < measuredStart + measured)
+			_frames[run.firstFrame + (size_t)(gpuFrame - measuredStart)].gpuMs = gpuMs;
+
+		const StereoTechniqueStats& stats = stereoTechnique->GetStats();
+		if (stats.gpuRender >= measuredRenderStart && stats.gpuRender < measuredRenderStart + measured)
+			_frames[run.firstFrame + (size_t)(stats.gpuRender - measuredRenderStart)].techniqueGpuMs = stats.gpuMs;
+	}
+
+	run.frameCount = _frames.size() - run.firstFrame;
+	_runs.push_back(run);
+}
+
+bool BenchRunner::WriteCsv(const std::string& path) const {
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		LOG_ERROR("Failed to write " + path);
+		return false;
+	}
+
+	file << std::fixed << std::setprecision(4);
+	file << "technique,width,height,frame,cpu_ms,fence_wait_ms,gpu_ms,technique_gpu_ms,pixel_reuse,gl_calls_issued,gl_calls_skipped\n";
+	for (const auto& frame : _frames) {
+		const BenchRunResult& run = _runs[frame.run];
+		file << run.technique << "," << run.width << "," << run.height << "," << frame.frame << ","
+			<< frame.cpuMs << "," << frame.fenceWaitMs << ",";
+		if (frame.gpuMs >= 0.0)
+			file << frame.gpuMs;
+		file << ",";
+		if (frame.techniqueGpuMs >= 0.0)
+			file << frame.techniqueGpuMs;
+		file << "," << frame.pixelReuse << "," << frame.glCallsIssued << "," << frame.glCallsSkipped << "\n";
+	}
+	return true;
+}
+
+bool BenchRunner::WriteJson(const std::string& path) const {
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		LOG_ERROR("Failed to write " + path);
+		return false;
+	}
+
+	file << std::fixed << std::setprecision(4);
+	file << "{\n  \"frames\": " << _config.frames << ",\n  \"warmup\": " << _config.warmupFrames
+		<< ",\n  \"timestep\": " << std::setprecision(7) << _config.timestep << std::setprecision(4) << ",\n  \"framesInFlight\": " << _config.framesInFlight
+		<< ",\n  \"runs\": [";
+	for (size_t i = 0; i < _runs.size(); i++) {
+		const BenchRunResult& run = _runs[i];
+		std::vector<double> cpu, fenceWait, gpu, techniqueGpu, reuse, glIssued, glSkipped;
+		for (size_t f = run.firstFrame; f < run.firstFrame + run.frameCount; f++) {
+			cpu.push_back(_frames[f].cpuMs);
+			fenceWait.push_back(_frames[f].fenceWaitMs);
+			if (_frames[f].gpuMs >= 0.0)
+				gpu.push_back(_frames[f].gpuMs);
+			if (_frames[f].techniqueGpuMs >= 0.0)
+				techniqueGpu.push_back(_frames[f].techniqueGpuMs);
+			reuse.push_back(_frames[f].pixelReuse);
+			glIssued.push_back((double)_frames[f].glCallsIssued);
+			glSkipped.push_back((double)_frames[f].glCallsSkipped);
+		}
+
+		file << (i > 0 ? ",\n" : "\n") << "    { \"technique\": \"" << run.technique << "\", \"width\": " << run.width
+			<< ", \"height\": " << run.height << ", \"skipped\": " << (run.skipped ? "true" : "false") << ",\n      ";
+		WriteSummary(file, "cpuMs", Summarize(cpu));
+		file << ",\n      ";
+		WriteSummary(file, "fenceWaitMs", Summarize(fenceWait));
+		file << ",\n      ";
+		WriteSummary(file, "gpuMs", Summarize(gpu));
+		file << ",\n      ";
+		WriteSummary(file, "techniqueGpuMs", Summarize(techniqueGpu));
+		file << ",\n      \"meanPixelReuse\": " << Summarize(reuse).mean
+			<< ",\n      \"meanGlCallsIssued\": " << Summarize(glIssued).mean
+			<< ",\n      \"meanGlCallsSkipped\": " << Summarize(glSkipped).mean
+			<< ",\n      \"perFrameColumns\": [\"cpuMs\", \"fenceWaitMs\", \"gpuMs\", \"techniqueGpuMs\", \"pixelReuse\", \"glCallsIssued\", \"glCallsSkipped\"],\n      \"perFrame\": [";
+		for (size_t f = run.firstFrame; f < run.firstFrame + run.frameCount; f++) {
+			const BenchFrameResult& frame = _frames[f];
+			file << (f > run.firstFrame ? ", " : "") << "[" << frame.cpuMs << ", " << frame.fenceWaitMs << ", ";
+			if (frame.gpuMs >= 0.0)
+				file << frame.gpuMs;
+			else
+				file << "null";
+			file << ", ";
+			if (frame.techniqueGpuMs >= 0.0)
+				file << frame.techniqueGpuMs;
+			else
+				file << "null";
+			file << ", " << frame.pixelReuse << ", " << frame.glCallsIssued << ", " << frame.glCallsSkipped << "]";
+		}
+		file << "] }";
+	}
+	file << "\n  ]\n}\n";
+	return true;
+}
@@ -0,0 +1,133 @@
+#include "bench/CameraPath.h"
+#include "core/Common.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <glm/gtc/matrix_transform.hpp>
+
+using namespace stereorizer::bench;
+
+bool CameraPath::Load(const std::string& path) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		LOG_ERROR("Failed to open camera path: " + path);
+		return false;
+	}
+
+	_keys.clear();
+	_trace.clear();
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+			line.erase(comment);
+
+		std::istringstream stream(line);
+		std::string kind;
+		if (!(stream >> kind))
+			continue;
+
+		HeadPose pose;
+		if (kind == "key") {
+			float time;
+			if (stream >> time >> pose.position.x >> pose.position.y >> pose.position.z >> pose.yaw >> pose.pitch) {
+				if (!_keys.empty() && time <= _keys.back().time) {
+					LOG_ERROR(path + ":" + std::to_string(lineNumber) + ": keyframe times must increase");
+					return false;
+				}
+				AddKeyframe(time, pose);
+				continue;
+			}
+		}
+		else if (kind == "pose") {
+			if (stream >> pose.position.x >> pose.position.y >> pose.position.z >> pose.yaw >> pose.pitch) {
+				AddTraceSample(pose);
+				continue;
+			}
+		}
+
+		LOG_ERROR(path + ":" + std::to_string(lineNumber) + ": expected 'key t x y z yaw pitch' or 'pose x y z yaw pitch'");
+		return false;
+	}
+
+	if (!_keys.empty() && !_trace.empty()) {
+		LOG_ERROR(path + ": keyframes and trace samples can't be mixed");
+		return false;
+	}
+	if (IsEmpty()) {
+		LOG_ERROR(path + ": no poses");
+		return false;
+	}
+	return true;
+}
+
+void CameraPath::AddKeyframe(float time, const HeadPose& pose) {
+	_keys.push_back({ time, pose });
+}
+
+void CameraPath::AddTraceSample(const HeadPose& pose) {
+	_trace.push_back(pose);
+}
+
+HeadPose CameraPath::Sample(uint64_t frame, float timestep) const {
+	if (!_trace.empty())
+		return _trace[std::min<size_t>((size_t)frame, _trace.size() - 1)];
+	if (_keys.empty())
+		return HeadPose();
+
+	// Frame times come from the index, so every run sees the same poses whatever its frame rate
+	return SampleKeyframes((float)((double)frame * timestep));
+}
+
+HeadPose CameraPath::SampleKeyframes(float time) const {
+	if (time <= _keys.front().time)
+		return _keys.front().pose;
+	if (time >= _keys.back().time)
+		return _keys.back().pose;
+
+	auto next = std::upper_bound(_keys.begin(), _keys.end(), time,
+		[](float t, const Keyframe& key) { return t < key.time; });
+	size_t i1 = (size_t)(next - _keys.begin());
+	size_t i0 = i1 - 1;
+	size_t iPrev = i0 > 0 ? i0 - 1 : i0;
+	size_t iNext = std::min(i1 + 1, _keys.size() - 1);
+
+	const Keyframe& k0 = _keys[i0];
+	const Keyframe& k1 = _keys[i1];
+	float t = (time - k0.time) / (k1.time - k0.time);
+
+	// Uniform Catmull-Rom through the neighbouring keys, the end keys are repeated
+	const glm::vec3& p0 = _keys[iPrev].pose.position;
+	const glm::vec3& p1 = k0.pose.position;
+	const glm::vec3& p2 = k1.pose.position;
+	const glm::vec3& p3 = _keys[iNext].pose.position;
+	float t2 = t * t;
+	float t3 = t2 * t;
+
+	HeadPose pose;
+	pose.position = 0.5f * ((2.0f * p1) + (p2 - p0) * t
+		+ (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2
+		+ (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+	pose.yaw = glm::mix(k0.pose.yaw, k1.pose.yaw, t);
+	pose.pitch = glm::mix(k0.pose.pitch, k1.pose.pitch, t);
+	return pose;
+}
+
+void CameraPath::GetEyeViews(const HeadPose& head, float ipd, glm::mat4& leftView, glm::mat4& rightView) {
+	float pitch = glm::clamp(head.pitch, -89.0f, 89.0f);
+	glm::vec3 front;
+	front.x = cos(glm::radians(head.yaw)) * cos(glm::radians(pitch));
+	front.y = sin(glm::radians(pitch));
+	front.z = sin(glm::radians(head.yaw)) * cos(glm::radians(pitch));
+	front = glm::normalize(front);
+	glm::vec3 right = glm::normalize(glm::cross(front, glm::vec3(0.0f, 1.0f, 0.0f)));
+	glm::vec3 up = glm::normalize(glm::cross(right, front));
+
+	glm::vec3 offset = right * (ipd * 0.5f);
+	leftView = glm::lookAt(head.position - offset, head.position - offset + front, up);
+	rightView = glm::lookAt(head.position + offset, head.position + offset + front, up);
+}
@@ -0,0 +1,124 @@
+#include "core/CpuProfiler.h"
+#include "core/Common.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+using namespace stereorizer::core;
+
+namespace
+{
+	void WriteJsonString(std::ofstream& file, const char* text) {
+		file << '"';
+		for (const char* c = text; *c; c++) {
+			if (*c == '"' || *c == '\\') file << '\\';
+			file << *c;
+		}
+		file << '"';
+	}
+}
+
+CpuProfiler& CpuProfiler::Get() {
+	static CpuProfiler profiler;
+	return profiler;
+}
+
+uint64_t CpuProfiler::NowNs() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+CpuProfiler::ThreadBuffer& CpuProfiler::GetThreadBuffer() {
+	thread_local ThreadBuffer* buffer = nullptr;
+	if (!buffer) {
+		std::lock_guard<std::mutex> lock(_buffersMutex);
+		_buffers.push_back(std::make_unique<ThreadBuffer>());
+		buffer = _buffers.back().get();
+		buffer->threadId = (uint32_t)_buffers.size();
+	}
+	return *buffer;
+}
+
+void CpuProfiler::BeginCapture(int frameCount, const std::string& path) {
+	if (frameCount <= 0 || IsCapturing())
+		return;
+
+	_capturePath = path;
+	_remainingFrames = frameCount;
+	_captureStartNs = NowNs();
+	// Buffers notice the new generation on their next Record and start over
+	_generation.fetch_add(1, std::memory_order_relaxed);
+	_capturing.store(true, std::memory_order_release);
+	LOG_INFO("CPU trace capture started: " + std::to_string(frameCount) + " frames");
+}
+
+void CpuProfiler::Record(const char* name, uint64_t startNs, uint64_t endNs) {
+	ThreadBuffer& buffer = GetThreadBuffer();
+
+	uint32_t generation = _generation.load(std::memory_order_relaxed);
+	if (buffer.generation.load(std::memory_order_relaxed) != generation) {
+		buffer.generation.store(generation, std::memory_order_relaxed);
+		buffer.count.store(0, std::memory_order_relaxed);
+		buffer.dropped.store(0, std::memory_order_relaxed);
+	}
+
+	size_t index = buffer.count.load(std::memory_order_relaxed);
+	if (index >= EventsPerThread) {
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	buffer.events[index] = { name, startNs, endNs };
+	buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void CpuProfiler::EndFrame() {
+	if (!IsCapturing() || --_remainingFrames > 0)
+		return;
+
+	_capturing.store(false, std::memory_order_release);
+	WriteTrace(_capturePath);
+}
+
+bool CpuProfiler::WriteTrace(const std::string& path) {
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		LOG_ERROR("Failed to open CPU trace file: " + path);
+		return false;
+	}
+
+	uint32_t generation = _generation.load(std::memory_order_relaxed);
+	size_t written = 0, dropped = 0;
+	bool first = true;
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+	std::lock_guard<std::mutex> lock(_buffersMutex);
+	for (const auto& buffer : _buffers) {
+		// A thread that recorded nothing during this capture still holds an older one
+		if (buffer->generation.load(std::memory_order_relaxed) != generation)
+			continue;
+
+		size_t count = buffer->count.load(std::memory_order_acquire);
+		dropped += buffer->dropped.load(std::memory_order_relaxed);
+		for (size_t i = 0; i < count; i++) {
+			const Event& event = buffer->events[i];
+			if (event.startNs < _captureStartNs)
+				continue;
+
+			// Chrome traces count in microseconds, keep the nanoseconds as decimals
+			file << (first ? "" : ",") << "\n{\"name\":";
+			WriteJsonString(file, event.name);
+			file << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+				<< ",\"ts\":" << (double)(event.startNs - _captureStartNs) / 1000.0
+				<< ",\"dur\":" << (double)(event.endNs - event.startNs) / 1000.0 << "}";
+			first = false;
+			written++;
+		}
+	}
+	file << "\n]}\n";
+
+	LOG_INFO("CPU trace written to " + path + ": " + std::to_string(written) + " events, " + std::to_string(dropped) + " dropped");
+	return true;
+}
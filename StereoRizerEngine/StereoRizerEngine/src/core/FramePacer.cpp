@@ -0,0 +1,141 @@
+#include "core/FramePacer.h"
+
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <timeapi.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#else
+#include <cerrno>
+#include <time.h>
+#endif
+
+using namespace stereorizer::core;
+
+namespace
+{
+#ifdef _WIN32
+	// Sleep and sleep_for round up to the system timer resolution, 15.6 ms unless something raised
+	// it, far above MaxSleepSlack. A high resolution waitable timer (Windows 10 1803+) wakes within
+	// about half a millisecond; without one the system timer is raised to 1 ms for the thread's life.
+	class WaitableTimer {
+	public:
+		WaitableTimer() {
+			_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+			if (_timer == nullptr) {
+				_raisedResolution = timeBeginPeriod(1) == TIMERR_NOERROR;
+				_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+			}
+		}
+
+		~WaitableTimer() {
+			if (_timer != nullptr)
+				CloseHandle(_timer);
+			if (_raisedResolution)
+				timeEndPeriod(1);
+		}
+
+		WaitableTimer(const WaitableTimer&) = delete;
+		WaitableTimer& operator=(const WaitableTimer&) = delete;
+
+		void Wait(std::chrono::nanoseconds duration) {
+			// Negative due time is relative, in 100 ns units
+			LARGE_INTEGER dueTime;
+			dueTime.QuadPart = -(LONGLONG)(duration.count() / 100);
+			if (_timer == nullptr || !SetWaitableTimer(_timer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+				std::this_thread::sleep_for(duration);
+				return;
+			}
+			WaitForSingleObject(_timer, INFINITE);
+		}
+
+	private:
+		HANDLE _timer = nullptr;
+		bool _raisedResolution = false;
+	};
+#endif
+
+	// Coarse sleep, may overshoot by a scheduler quantum
+	void SleepFor(std::chrono::nanoseconds duration) {
+		if (duration <= std::chrono::nanoseconds::zero())
+			return;
+#ifdef _WIN32
+		thread_local WaitableTimer timer;
+		timer.Wait(duration);
+#else
+		timespec request;
+		request.tv_sec = (time_t)(duration.count() / 1000000000);
+		request.tv_nsec = (long)(duration.count() % 1000000000);
+		timespec remaining;
+		while (nanosleep(&request, &remaining) == -1 && errno == EINTR)
+			request = remaining;
+#endif
+	}
+}
+
+void FramePacer::SetTargetFPS(float fps) {
+	_targetFPS = fps;
+	_period = fps > 0.0f
+		? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps))
+		: Clock::duration::zero();
+	Reset();
+}
+
+void FramePacer::Reset() {
+	_scheduled = false;
+}
+
+void FramePacer::SleepUntil(Clock::time_point deadline) {
+	Clock::time_point now = Clock::now();
+	Clock::time_point wakeTarget = deadline - _sleepSlack;
+	if (wakeTarget > now) {
+		SleepFor(wakeTarget - now);
+
+		// Grow the margin right away when the OS overslept, shrink it slowly otherwise
+		Clock::duration overshoot = Clock::now() - wakeTarget;
+		if (overshoot > _sleepSlack)
+			_sleepSlack = std::min<Clock::duration>(overshoot + overshoot / 4, MaxSleepSlack);
+		else
+			_sleepSlack = std::max<Clock::duration>(_sleepSlack - _sleepSlack / 64, MinSleepSlack);
+	}
+
+	while (Clock::now() < deadline)
+		std::this_thread::yield();
+}
+
+void FramePacer::RecordError(Clock::duration error) {
+	double errorUs = std::chrono::duration<double, std::micro>(error).count();
+	_stats.frames++;
+	_stats.lastErrorUs = errorUs;
+	_stats.meanErrorUs += (errorUs - _stats.meanErrorUs) / (double)_stats.frames;
+	_stats.maxErrorUs = std::max(_stats.maxErrorUs, errorUs);
+}
+
+void FramePacer::WaitForNextFrame() {
+	if (_period <= Clock::duration::zero())
+		return;
+
+	Clock::time_point now = Clock::now();
+	if (!_scheduled) {
+		_nextDeadline = now + _period;
+		_scheduled = true;
+		return;
+	}
+
+	// A frame that blew a whole period doesn't get to burst-catch-up, the schedule restarts from now
+	if (now > _nextDeadline + _period) {
+		_stats.missedDeadlines++;
+		_nextDeadline = now + _period;
+		return;
+	}
+
+	SleepUntil(_nextDeadline);
+	RecordError(Clock::now() - _nextDeadline);
+	_nextDeadline += _period;
+}
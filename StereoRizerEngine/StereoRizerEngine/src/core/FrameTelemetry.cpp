@@ -0,0 +1,163 @@
+#include "core/FrameTelemetry.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <thread>
+
+using namespace stereorizer::core;
+
+int LatencyHistogram::BucketIndex(uint64_t us) {
+	if (us < 2 * SubBucketCount)
+		return (int)us;
+
+	int msb = (int)std::bit_width(us) - 1;
+	int shift = msb - SubBucketBits;
+	int index = shift * SubBucketCount + (int)(us >> shift);
+	return std::min(index, BucketCount - 1);
+}
+
+uint64_t LatencyHistogram::BucketUpperEdge(int index) {
+	if (index < 2 * SubBucketCount)
+		return (uint64_t)index;
+
+	int shift = index / SubBucketCount - 1;
+	uint64_t mantissa = (uint64_t)(index % SubBucketCount + SubBucketCount);
+	return ((mantissa + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(double ms) {
+	uint64_t us = (uint64_t)std::llround(std::max(ms, 0.0) * 1000.0);
+	_buckets[BucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_sumUs.fetch_add(us, std::memory_order_relaxed);
+
+	uint64_t max = _maxUs.load(std::memory_order_relaxed);
+	while (us > max && !_maxUs.compare_exchange_weak(max, us, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::Reset() {
+	for (auto& bucket : _buckets)
+		bucket.store(0, std::memory_order_relaxed);
+	_count.store(0, std::memory_order_relaxed);
+	_sumUs.store(0, std::memory_order_relaxed);
+	_maxUs.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::GetMeanMs() const {
+	uint64_t count = GetCount();
+	return count == 0 ? 0.0 : (double)_sumUs.load(std::memory_order_relaxed) / (double)count / 1000.0;
+}
+
+double LatencyHistogram::GetPercentileMs(double fraction) const {
+	// Sum the buckets instead of trusting _count, a concurrent Record may be half done
+	uint64_t total = 0;
+	for (const auto& bucket : _buckets)
+		total += bucket.load(std::memory_order_relaxed);
+	if (total == 0)
+		return 0.0;
+
+	uint64_t target = std::max<uint64_t>(1, (uint64_t)std::ceil(std::clamp(fraction, 0.0, 1.0) * (double)total));
+	uint64_t seen = 0;
+	for (int i = 0; i < BucketCount; i++) {
+		seen += _buckets[i].load(std::memory_order_relaxed);
+		if (seen >= target)
+			return std::min((double)BucketUpperEdge(i) / 1000.0, GetMaxMs());
+	}
+	return GetMaxMs();
+}
+
+void FrameTelemetry::BeginWrite(Slot& slot) {
+	slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	// The odd sequence is visible before any of the field stores
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+void FrameTelemetry::EndWrite(Slot& slot) {
+	slot.sequence.store(slot.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool FrameTelemetry::ReadSlot(const Slot& slot, FrameSample& sample) {
+	for (;;) {
+		uint32_t before = slot.sequence.load(std::memory_order_acquire);
+		if (before & 1) {
+			std::this_thread::yield();
+			continue;
+		}
+		sample.frame = slot.frame.load(std::memory_order_relaxed);
+		sample.cpuMs = slot.cpuMs.load(std::memory_order_relaxed);
+		sample.gpuMs = slot.gpuMs.load(std::memory_order_relaxed);
+		sample.intervalMs = slot.intervalMs.load(std::memory_order_relaxed);
+		// The field loads complete before the sequence is checked again
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (slot.sequence.load(std::memory_order_relaxed) == before)
+			return sample.frame != UINT64_MAX;
+	}
+}
+
+void FrameTelemetry::RecordFrame(uint64_t frame, double cpuMs, double intervalMs) {
+	Slot& slot = _history[frame % HistorySize];
+	BeginWrite(slot);
+	slot.frame.store(frame, std::memory_order_relaxed);
+	slot.cpuMs.store((float)cpuMs, std::memory_order_relaxed);
+	slot.gpuMs.store(-1.0f, std::memory_order_relaxed);
+	slot.intervalMs.store((float)intervalMs, std::memory_order_relaxed);
+	EndWrite(slot);
+
+	_cpu.Record(cpuMs);
+	if (intervalMs > 0.0) {
+		_interval.Record(intervalMs);
+		double target = GetTargetIntervalMs();
+		if (target > 0.0 && intervalMs > target * MissedIntervalFactor)
+			_missedFrames.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void FrameTelemetry::RecordGpuTime(uint64_t frame, double gpuMs) {
+	_gpu.Record(gpuMs);
+
+	// Only the writer changes frame, no sequence needed to read it here
+	Slot& slot = _history[frame % HistorySize];
+	if (slot.frame.load(std::memory_order_relaxed) == frame) {
+		BeginWrite(slot);
+		slot.gpuMs.store((float)gpuMs, std::memory_order_relaxed);
+		EndWrite(slot);
+	}
+}
+
+void FrameTelemetry::Reset() {
+	for (auto& slot : _history) {
+		BeginWrite(slot);
+		slot.frame.store(UINT64_MAX, std::memory_order_relaxed);
+		EndWrite(slot);
+	}
+	_missedFrames.store(0, std::memory_order_relaxed);
+	_cpu.Reset();
+	_gpu.Reset();
+	_interval.Reset();
+}
+
+FrameTimeSummary FrameTelemetry::Summarize(const LatencyHistogram& histogram) {
+	FrameTimeSummary summary;
+	summary.frames = histogram.GetCount();
+	summary.meanMs = histogram.GetMeanMs();
+	summary.p50Ms = histogram.GetPercentileMs(0.50);
+	summary.p95Ms = histogram.GetPercentileMs(0.95);
+	summary.p99Ms = histogram.GetPercentileMs(0.99);
+	summary.maxMs = histogram.GetMaxMs();
+	return summary;
+}
+
+std::vector<FrameSample> FrameTelemetry::GetHistory() const {
+	std::vector<FrameSample> history;
+	history.reserve(HistorySize);
+
+	for (const auto& slot : _history) {
+		FrameSample sample;
+		if (ReadSlot(slot, sample))
+			history.push_back(sample);
+	}
+
+	std::sort(history.begin(), history.end(), [](const FrameSample& a, const FrameSample& b) { return a.frame < b.frame; });
+	return history;
+}
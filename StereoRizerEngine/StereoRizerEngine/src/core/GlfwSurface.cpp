@@ -0,0 +1,70 @@
+#include "core/GlfwSurface.h"
+#include "core/Common.h"
+
+#include <GLFW/glfw3.h>
+
+using namespace stereorizer::core;
+
+GlfwSurface::~GlfwSurface() {
+	if (_window) {
+		glfwDestroyWindow(_window);
+		_window = nullptr;
+		glfwTerminate();
+	}
+}
+
+bool GlfwSurface::Init(int width, int height, const char* title) {
+	if (!glfwInit()) {
+		LOG_ERROR("Failed to initialize GLFW");
+		return false;
+	}
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+	_window = glfwCreateWindow(width, height, title, NULL, NULL);
+	if (!_window) {
+		LOG_ERROR("Failed to create GLFW window");
+		glfwTerminate();
+		return false;
+	}
+	glfwMakeContextCurrent(_window);
+
+	// Needed for GLEW to resolve extension entry points (e.g. OVR_multiview) on a core profile
+	glewExperimental = GL_TRUE;
+	GLenum status = glewInit();
+	if (status != GLEW_OK) {
+		LOG_ERROR(std::string("Failed to initialize GLEW: ") + reinterpret_cast<const char*>(glewGetErrorString(status)));
+		return false;
+	}
+	return true;
+}
+
+void GlfwSurface::MakeCurrent() {
+	glfwMakeContextCurrent(_window);
+}
+
+void GlfwSurface::PollEvents() {
+	glfwPollEvents();
+}
+
+void GlfwSurface::SwapBuffers() {
+	glfwSwapBuffers(_window);
+}
+
+bool GlfwSurface::ShouldClose() const {
+	return !_window || glfwWindowShouldClose(_window);
+}
+
+void GlfwSurface::RequestClose() {
+	if (_window)
+		glfwSetWindowShouldClose(_window, true);
+}
+
+void GlfwSurface::GetFramebufferSize(int& width, int& height) const {
+	glfwGetFramebufferSize(_window, &width, &height);
+}
+
+void GlfwSurface::SetSize(int width, int height) {
+	glfwSetWindowSize(_window, width, height);
+}
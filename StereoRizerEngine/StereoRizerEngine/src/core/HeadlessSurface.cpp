@@ -0,0 +1,242 @@
+#include "core/HeadlessSurface.h"
+#include "core/Common.h"
+#include "graphics/GLStateCache.h"
+
+#include <cstring>
+#include <sstream>
+
+#if defined(__linux__)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#else
+#include <GLFW/glfw3.h>
+#endif
+
+using namespace stereorizer::core;
+using namespace stereorizer::graphics;
+
+#if defined(__linux__)
+namespace
+{
+	std::string EglErrorString() {
+		std::ostringstream stream;
+		stream << "0x" << std::hex << eglGetError();
+		return stream.str();
+	}
+}
+#endif
+
+HeadlessSurface::~HeadlessSurface() {
+#if defined(__linux__)
+	if (_context) {
+		DeleteFramebuffer();
+		eglMakeCurrent((EGLDisplay)_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext((EGLDisplay)_display, (EGLContext)_context);
+		_context = nullptr;
+	}
+	if (_display) {
+		eglTerminate((EGLDisplay)_display);
+		_display = nullptr;
+	}
+#else
+	if (_context) {
+		DeleteFramebuffer();
+		glfwDestroyWindow((GLFWwindow*)_context);
+		_context = nullptr;
+		glfwTerminate();
+	}
+#endif
+}
+
+bool HeadlessSurface::CreateContext() {
+#if defined(__linux__)
+	// The surfaceless platform needs neither a display server nor a GPU; fall back to the
+	// default display when the loader doesn't know it
+	EGLDisplay display = EGL_NO_DISPLAY;
+	auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major = 0, minor = 0;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+		LOG_ERROR("Failed to initialize an EGL display: " + EglErrorString());
+		return false;
+	}
+	_display = display;
+
+	const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+	if (!extensions || !std::strstr(extensions, "EGL_KHR_surfaceless_context")) {
+		LOG_ERROR("EGL display doesn't support surfaceless contexts");
+		return false;
+	}
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		LOG_ERROR("EGL display doesn't support desktop OpenGL: " + EglErrorString());
+		return false;
+	}
+
+	// The context never gets a surface, so any config that can render GL will do
+	EGLConfig config = EGL_NO_CONFIG_KHR;
+	if (!std::strstr(extensions, "EGL_KHR_no_config_context")) {
+		const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+		EGLint configCount = 0;
+		if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+			LOG_ERROR("No EGL config renders desktop OpenGL: " + EglErrorString());
+			return false;
+		}
+	}
+
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 4,
+		EGL_CONTEXT_MINOR_VERSION, 5,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (context == EGL_NO_CONTEXT) {
+		LOG_ERROR("Failed to create a GL 4.5 core EGL context: " + EglErrorString());
+		return false;
+	}
+	_context = context;
+
+	if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+		LOG_ERROR("Failed to make the EGL context current: " + EglErrorString());
+		return false;
+	}
+
+	LOG_INFO("EGL " + std::to_string(major) + "." + std::to_string(minor) + " surfaceless context created");
+	return true;
+#else
+	// No surfaceless EGL here, a window that is never shown provides the context instead
+	if (!glfwInit()) {
+		LOG_ERROR("Failed to initialize GLFW");
+		return false;
+	}
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+	GLFWwindow* window = glfwCreateWindow(1, 1, "StereoRizer headless", nullptr, nullptr);
+	if (!window) {
+		LOG_ERROR("Failed to create a hidden GLFW window for the headless context");
+		glfwTerminate();
+		return false;
+	}
+	_context = window;
+	glfwMakeContextCurrent(window);
+	return true;
+#endif
+}
+
+bool HeadlessSurface::Init(int width, int height, const char* title) {
+	(void)title;
+	_width = width;
+	_height = height;
+
+	if (!CreateContext())
+		return false;
+
+	glewExperimental = GL_TRUE;
+	GLenum status = glewInit();
+	// A GLX build of GLEW loads every GL entry point before it fails to find an X display
+	if (status != GLEW_OK && status != GLEW_ERROR_NO_GLX_DISPLAY) {
+		LOG_ERROR(std::string("Failed to initialize GLEW: ") + reinterpret_cast<const char*>(glewGetErrorString(status)));
+		return false;
+	}
+
+	CreateFramebuffer();
+	return _framebuffer != 0;
+}
+
+void HeadlessSurface::MakeCurrent() {
+#if defined(__linux__)
+	if (_context)
+		eglMakeCurrent((EGLDisplay)_display, EGL_NO_SURFACE, EGL_NO_SURFACE, (EGLContext)_context);
+#else
+	if (_context)
+		glfwMakeContextCurrent((GLFWwindow*)_context);
+#endif
+}
+
+void HeadlessSurface::CreateFramebuffer() {
+	DeleteFramebuffer();
+	if (_width <= 0 || _height <= 0)
+		return;
+
+	glGenRenderbuffers(1, &_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, _colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, _width, _height);
+	glGenRenderbuffers(1, &_depthStencilBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, _depthStencilBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, _width, _height);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &_framebuffer);
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depthStencilBuffer);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		LOG_ERROR("Headless framebuffer not complete! Status: " + std::to_string(status));
+		GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
+		DeleteFramebuffer();
+		return;
+	}
+
+	LOG_INFO("Headless framebuffer created: " + std::to_string(_width) + "x" + std::to_string(_height));
+}
+
+void HeadlessSurface::DeleteFramebuffer() {
+	if (_framebuffer != 0) {
+		GLStateCache::Get().DeleteFramebuffers(1, &_framebuffer);
+		_framebuffer = 0;
+	}
+	GLuint renderbuffers[] = { _colorBuffer, _depthStencilBuffer };
+	for (GLuint renderbuffer : renderbuffers) {
+		if (renderbuffer != 0)
+			glDeleteRenderbuffers(1, &renderbuffer);
+	}
+	_colorBuffer = _depthStencilBuffer = 0;
+}
+
+void HeadlessSurface::SwapBuffers() {
+	glFlush();
+}
+
+void HeadlessSurface::GetFramebufferSize(int& width, int& height) const {
+	width = _width;
+	height = _height;
+}
+
+void HeadlessSurface::SetSize(int width, int height) {
+	if (width == _width && height == _height)
+		return;
+	_width = width;
+	_height = height;
+	if (_context) {
+		CreateFramebuffer();
+		GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	}
+}
+
+bool HeadlessSurface::ReadPixels(std::vector<unsigned char>& pixels) const {
+	if (_framebuffer == 0)
+		return false;
+
+	GLStateCache& state = GLStateCache::Get();
+	GLuint previousFramebuffer = state.GetReadFramebuffer();
+	GLint previousAlignment;
+	glGetIntegerv(GL_PACK_ALIGNMENT, &previousAlignment);
+
+	pixels.resize((size_t)_width * _height * 4);
+	state.BindFramebuffer(GL_READ_FRAMEBUFFER, _framebuffer);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, _width, _height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+	glPixelStorei(GL_PACK_ALIGNMENT, previousAlignment);
+	state.BindFramebuffer(GL_READ_FRAMEBUFFER, previousFramebuffer);
+	return true;
+}
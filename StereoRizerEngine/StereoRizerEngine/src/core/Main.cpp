@@ -6,13 +6,33 @@
 
 #include <iostream>
 #include <memory>
+#include <cstdlib>
+#include <cstring>
 #include <glm/glm.hpp>
 
-int main()
+int main(int argc, char** argv)
 {
-    stereorizer::core::Window window(600, 400, "StereoRizer Engine");
+    // --headless renders offscreen through EGL (e.g. llvmpipe on CI), --frames N stops after N frames
+    bool headless = false;
+    uint64_t frameLimit = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0)
+            headless = true;
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frameLimit = std::strtoull(argv[++i], nullptr, 10);
+    }
+    if (headless && frameLimit == 0)
+        frameLimit = 300;
 
-	std::shared_ptr<stereorizer::graphics::Mesh> mesh = std::make_shared<stereorizer::graphics::Mesh>("../models/Suzanne.obj");
+    stereorizer::core::Window window(600, 400, "StereoRizer Engine",
+        headless ? stereorizer::core::SurfaceBackend::Headless : stereorizer::core::SurfaceBackend::Glfw);
+    window.SetFrameLimit(frameLimit);
+
+    if (!window.IsReady())
+        return 1;
+
+    // Streams in on a worker, the placeholder box is drawn until the upload on the render thread completes
+	std::shared_ptr<stereorizer::graphics::Mesh> mesh = window.GetMeshManager()->Acquire("../models/Suzanne.obj").mesh;
 	std::shared_ptr<stereorizer::graphics::Shader> shader = std::make_shared<stereorizer::graphics::Shader>("resources/shaders/PhongDiffuseOnly.shader");
 
     auto model = std::make_shared<stereorizer::graphics::Model>(mesh, shader);
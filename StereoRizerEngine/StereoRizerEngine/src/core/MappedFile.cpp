@@ -0,0 +1,115 @@
+#include "core/MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace stereorizer::core;
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		Close();
+		std::swap(_data, other._data);
+		std::swap(_size, other._size);
+#ifdef _WIN32
+		std::swap(_file, other._file);
+		std::swap(_mapping, other._mapping);
+#endif
+	}
+	return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path) {
+	Close();
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	_file = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		Close();
+		return false;
+	}
+
+	_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!_mapping) {
+		Close();
+		return false;
+	}
+	_data = (const uint8_t*)MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!_data) {
+		Close();
+		return false;
+	}
+	_size = (size_t)size.QuadPart;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (_data)
+		UnmapViewOfFile(_data);
+	if (_mapping)
+		CloseHandle(_mapping);
+	if (_file)
+		CloseHandle(_file);
+	_data = nullptr;
+	_size = 0;
+	_mapping = nullptr;
+	_file = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path) {
+	Close();
+
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0) {
+		close(file);
+		return false;
+	}
+
+	// The mapping keeps its own reference to the file
+	void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+		return false;
+
+	_data = (const uint8_t*)data;
+	_size = (size_t)info.st_size;
+	return true;
+}
+
+void MappedFile::Close() {
+	if (_data)
+		munmap((void*)_data, _size);
+	_data = nullptr;
+	_size = 0;
+}
+
+#endif
@@ -0,0 +1,15 @@
+#include "core/Surface.h"
+#include "core/GlfwSurface.h"
+#include "core/HeadlessSurface.h"
+
+using namespace stereorizer::core;
+
+std::unique_ptr<Surface> Surface::Create(SurfaceBackend backend) {
+	switch (backend) {
+	case SurfaceBackend::Headless:
+		return std::make_unique<HeadlessSurface>();
+	case SurfaceBackend::Glfw:
+	default:
+		return std::make_unique<GlfwSurface>();
+	}
+}
@@ -1,28 +1,49 @@
 #include "core/Window.h"
 #include "graphics/Shader.h"
+#include "graphics/GLStateCache.h"
 #include "graphics/Model.h"
 #include "core/Common.h"
+#include "core/CpuProfiler.h"
 #include "graphics/Renderer.h"
 #include "graphics/Light.h"
 #include "xr/OpenXRSupport.h"
 #include <glm/glm.hpp>
 #include <cmath>
 
+#include <GLFW/glfw3.h>
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_opengl3.h>
+
 using namespace stereorizer::core;
 using namespace stereorizer::graphics;
 
-Window::Window(int width, int height, const char* title)
+Window::Window(int width, int height, const char* title, SurfaceBackend backend)
 {
 	_width = width;
 	_height = height;
 	_title = title;
 
-	// initialize unique_ptr with nullptr and custom deleter
-	_window = std::unique_ptr<GLFWwindow, std::function<void(GLFWwindow*)>>(nullptr, [](GLFWwindow* w){ if (w) glfwDestroyWindow(w); });
+	_surface = Surface::Create(backend);
+	_xrSupport = std::make_unique<stereorizer::xr::OpenXRSupport>();
 
 	InitResources();
+	if (!_surfaceReady)
+		return;
+	// The surface and ImGui set up GL behind the cache's back
+	GLStateCache::Get().Invalidate();
+
 	_leftRenderer = std::make_unique<Renderer>();
 	_rightRenderer = std::make_unique<Renderer>();
+	_leftRenderer->SetEyeIndex(0);
+	_rightRenderer->SetEyeIndex(1);
+	_frameUniforms = std::make_unique<FrameUniformBuffer>();
+	_frameRing = std::make_unique<FrameRing>();
+	_framePacer.SetTargetFPS(60.0f);
+	_gpuProfiler = std::make_unique<GpuProfiler>();
+	_assetLoader = std::make_unique<AssetLoader>();
+	_meshManager = std::make_unique<MeshManager>(*_assetLoader);
+	GLStateCache::Get().Enable(GL_DEPTH_TEST);
 
 	// Create a shared light for both renderers
 	_sceneLight = std::make_shared<Light>(LightType::Directional);
@@ -40,6 +61,13 @@ Window::Window(int width, int height, const char* title)
 	_leftRenderer->SetupDepthTexture(textureWidth, textureHeight, false);  // Left viewport (starts at x=0)
 	_rightRenderer->SetupDepthTexture(textureWidth, textureHeight, true);  // Right viewport (starts at x=textureWidth)
 
+	_stereoTarget = std::make_unique<StereoRenderTarget>();
+	_stereoTarget->Setup(textureWidth, textureHeight);
+	_stereoTargets.eyeWidth = textureWidth;
+	_stereoTargets.eyeHeight = textureHeight;
+	_stereoTargets.stereoTarget = _stereoTarget.get();
+	SetStereoTechnique("two-pass");
+
 	// Position the stereo camera pair using IPD (left/right offset around origin)
 	// Calculate middle look-at point and set both cameras to look at it
 	{
@@ -81,25 +109,40 @@ Window::~Window()
 
 void Window::Destroy()
 {
-	if (_window)
+	if (_surface)
 	{
-		ImGui_ImplOpenGL3_Shutdown();
-		ImGui_ImplGlfw_Shutdown();
-		ImGui::DestroyContext();
+		if (_surfaceReady && !_surface->IsHeadless()) {
+			ImGui_ImplOpenGL3_Shutdown();
+			ImGui_ImplGlfw_Shutdown();
+			ImGui::DestroyContext();
+		}
 
-		_window.reset();
-		glfwTerminate();
+		// GL objects go while their context is still alive, meshes with the last model holding them
+		_models.clear();
+		_stereoTechnique = nullptr;
+		_stereoTechniques.clear();
+		_leftRenderer.reset();
+		_rightRenderer.reset();
+		_stereoTarget.reset();
+		_frameUniforms.reset();
+		_meshManager.reset();
+		_assetLoader.reset();
+		_frameRing.reset();
+		_gpuProfiler.reset();
+
+		_surface.reset();
+		_surfaceReady = false;
 	}
 }
 
 void Window::PollEvents()
 {
-	glfwPollEvents();
+	_surface->PollEvents();
 }
 
 void Window::SwapBuffers()
 {
-	glfwSwapBuffers(_window.get());
+	_surface->SwapBuffers();
 }
 
 void Window::AddModel(std::shared_ptr<Model> model)
@@ -107,8 +150,6 @@ void Window::AddModel(std::shared_ptr<Model> model)
 	if (!model) return;
 	if (std::find(_models.begin(), _models.end(), model) == _models.end())
 		_models.push_back(model);
-
-	_standardShader = model->GetShader();
 }
 
 void Window::RemoveModel(std::shared_ptr<Model> model)
@@ -136,203 +177,269 @@ bool Window::UpdateXRViews()
 	if (!_xrInitialized)
 		return false;
 
-	_xrSupport.PollEvents();
+	_xrSupport->PollEvents();
 	if (_xrInitialized)
-		_xrInitialized = _xrSupport.WaitFrame();
+		_xrInitialized = _xrSupport->WaitFrame();
 	else
 		return false;
 
 	if (_xrInitialized)
-		_xrInitialized = _xrSupport.BeginFrame();
+		_xrInitialized = _xrSupport->BeginFrame();
 	else
 		return false;
 
 	if (_xrInitialized)
-		_xrInitialized = _xrSupport.LocateViews();
+		_xrInitialized = _xrSupport->LocateViews();
 	else
 		return false;
 
-	glm::mat4 leftView = _xrSupport.ConvertXrPoseToMat4(0);
-	glm::mat4 leftProj = _xrSupport.ConvertXrFovToProj(0, 0.1f, 100.0f);
+	glm::mat4 leftView = _xrSupport->ConvertXrPoseToMat4(0);
+	glm::mat4 leftProj = _xrSupport->ConvertXrFovToProj(0, 0.1f, 100.0f);
 	_leftRenderer->GetCamera()->SetViewMatrix(leftView);
 	_leftRenderer->GetCamera()->SetProjectionMatrix(leftProj);
 
-	glm::mat4 rightView = _xrSupport.ConvertXrPoseToMat4(1);
-	glm::mat4 rightProj = _xrSupport.ConvertXrFovToProj(1, 0.1f, 100.0f);
+	glm::mat4 rightView = _xrSupport->ConvertXrPoseToMat4(1);
+	glm::mat4 rightProj = _xrSupport->ConvertXrFovToProj(1, 0.1f, 100.0f);
 	_rightRenderer->GetCamera()->SetViewMatrix(rightView);
 	_rightRenderer->GetCamera()->SetProjectionMatrix(rightProj);
 
 	return true;
 }
 
-void Window::RenderModelsLeft()
+void Window::UpdateFrameData()
 {
-	if (!_leftRenderer) return;
-
-	for (const auto& model : _models) {
-		if (model) {
-			model->GetShader()->DisableDefine("USE_REPROJECTION");
-			model->GetShader()->RecompileWithDefines();
-		}
+	if (!_frameUniforms || !_frameRing) return;
+
+	FrameData data;
+	Renderer* renderers[2] = { _leftRenderer.get(), _rightRenderer.get() };
+	for (int eye = 0; eye < 2; eye++) {
+		auto camera = renderers[eye]->GetCamera();
+		data.viewMatrix[eye] = camera->GetViewMatrix();
+		data.projectionMatrix[eye] = camera->GetProjectionMatrix();
+		data.inverseViewMatrix[eye] = glm::inverse(data.viewMatrix[eye]);
+		data.inverseProjectionMatrix[eye] = glm::inverse(data.projectionMatrix[eye]);
 	}
-	
-	_leftRenderer->RenderToTextures(_models);
-	
-	if (_leftViewDisplayMode == ViewDisplayMode::Color) {
-		_leftRenderer->RenderColorVisualization();
-	} 
-	else if (_leftViewDisplayMode == ViewDisplayMode::Depth && _leftRenderer->IsDepthTextureEnabled()) {
-		auto camera = _leftRenderer->GetCamera();
-		float nearPlane = camera ? camera->GetNearPlane() : 0.1f;
-		float farPlane = camera ? camera->GetFarPlane() : 100.0f;
+	// Right clip -> right view -> world -> left view -> left clip, so reprojection is one multiply per fragment
+	data.rightClipToLeftClip = data.projectionMatrix[0] * data.viewMatrix[0] * data.inverseViewMatrix[1] * data.inverseProjectionMatrix[1];
+	data.leftClipToRightClip = data.projectionMatrix[1] * data.viewMatrix[1] * data.inverseViewMatrix[0] * data.inverseProjectionMatrix[0];
+
+	if (_sceneLight)
+		_sceneLight->WriteToBlock(data.light);
+	else
+		data.light = {};
+
+	_frameUniforms->Update(data, _frameRing->GetSlot());
+}
 
-		_leftRenderer->RenderDepthVisualization(nearPlane, farPlane);
+void Window::PresentViews()
+{
+	PROFILE_SCOPE("Present");
+	Renderer* renderers[2] = { _leftRenderer.get(), _rightRenderer.get() };
+	ViewDisplayMode modes[2] = { _leftViewDisplayMode, _rightViewDisplayMode };
+	const char* colorScopes[2] = { "Left RenderColorVisualization", "Right RenderColorVisualization" };
+	const char* depthScopes[2] = { "Left RenderDepthVisualization", "Right RenderDepthVisualization" };
+
+	// Each eye in its half of the window, whichever textures the technique left it in
+	for (int eye = 0; eye < 2; eye++) {
+		GLStateCache::Get().Viewport(eye * (_width / 2), 0, _width / 2, _height);
+		if (modes[eye] == ViewDisplayMode::Depth && _stereoTargets.depthTextures[eye] != 0) {
+			auto camera = renderers[eye]->GetCamera();
+			float nearPlane = camera ? camera->GetNearPlane() : 0.1f;
+			float farPlane = camera ? camera->GetFarPlane() : 100.0f;
+
+			GpuScope scope(_gpuProfiler.get(), depthScopes[eye]);
+			renderers[eye]->RenderDepthVisualization(_stereoTargets.depthTextures[eye], nearPlane, farPlane);
+		}
+		else if (_stereoTargets.colorTextures[eye] != 0) {
+			GpuScope scope(_gpuProfiler.get(), colorScopes[eye]);
+			renderers[eye]->RenderColorVisualization(_stereoTargets.colorTextures[eye]);
+		}
 	}
 }
 
-void Window::RenderModelsRight()
+void Window::Run()
 {
-	if (!_rightRenderer) return;
+	if (!_surfaceReady) {
+		LOG_ERROR("No GL surface, nothing to run");
+		return;
+	}
 
-	if (_rightViewDisplayMode == ViewDisplayMode::ReprojectionMask) {
-		std::shared_ptr<Shader> reprojectionShader;
+	if (_xrInitialized) {
+		_xrSupport->InitCopyFrameBuffer(_width, _height);
+		GLStateCache::Get().Invalidate();
+	}
 
-		_models[0]->GetShader()->EnableDefine("USE_REPROJECTION");
-		_models[0]->GetShader()->RecompileWithDefines();
+	uint64_t firstFrame = _frameNumber;
+	while (!_surface->ShouldClose() && (_frameLimit == 0 || _frameNumber - firstFrame < _frameLimit))
+		RenderFrame();
 
-		//// Upload camera matrices
-		auto leftCamera = _leftRenderer->GetCamera();
+	if (_xrInitialized)
+		_xrSupport->EndLoop();
+}
 
-		if (leftCamera) {
-			leftCamera->UploadToReprojectionShader(_models[0]->GetShader());
-		}
+void Window::RenderFrame()
+{
+	if (!_surfaceReady)
+		return;
 
-		//// Bind left renderer textures
-		GLuint depthTexture = _leftRenderer->GetDepthTexture();
-		GLuint colorTexture = _leftRenderer->GetColorTexture();
+	if (_fixedTimestep > 0.0f)
+		currentFrame = lastFrame + _fixedTimestep;
+	else
+		currentFrame = std::chrono::duration<float>(std::chrono::steady_clock::now() - _startTime).count();
+	deltaTime = currentFrame - lastFrame;
+	lastFrame = currentFrame;
+
+	// Calculate current FPS
+	_frameCount++;
+	_frameTimeAccumulator += deltaTime;
+	if (_frameTimeAccumulator >= 1.0f) {
+		_currentFPS = _frameCount / _frameTimeAccumulator;
+		_frameCount = 0;
+		_frameTimeAccumulator = 0.0f;
+	}
 
-		if (depthTexture != 0 && colorTexture != 0) {
-			// Left depth texture (texture unit 0)
-			glActiveTexture(GL_TEXTURE0);
-			glBindTexture(GL_TEXTURE_2D, depthTexture);
-			glUniform1i(glGetUniformLocation(_models[0]->GetShader()->GetID(), "leftDepthTexture"), 0);
+	auto frameStart = std::chrono::steady_clock::now();
+	{
+		PROFILE_SCOPE("Poll");
+		PollEvents();
+	}
 
-			// Left color texture (texture unit 1)
-			glActiveTexture(GL_TEXTURE1);
-			glBindTexture(GL_TEXTURE_2D, colorTexture);
-			glUniform1i(glGetUniformLocation(_models[0]->GetShader()->GetID(), "leftColorTexture"), 1);
-		}
+	_surface->MakeCurrent();
 
+	int newWidth, newHeight;
+	_surface->GetFramebufferSize(newWidth, newHeight);
+	
+	// Update depth texture if window size changed
+	if (newWidth != _width || newHeight != _height) {
+		_width = newWidth;
+		_height = newHeight;
+		int textureWidth = _width / 2; // Each view takes half the screen width
+		int textureHeight = _height;
+		if (_leftRenderer)
+			_leftRenderer->SetupDepthTexture(textureWidth, textureHeight, false);  // Left viewport
+		if (_rightRenderer)
+			_rightRenderer->SetupDepthTexture(textureWidth, textureHeight, true);   // Right viewport
+		if (_stereoTarget)
+			_stereoTarget->Setup(textureWidth, textureHeight);
+		_stereoTargets.eyeWidth = textureWidth;
+		_stereoTargets.eyeHeight = textureHeight;
+		if (_stereoTechnique)
+			_stereoTechnique->Resize(textureWidth, textureHeight);
 	}
 
-	_rightRenderer->RenderToTextures(_models);
+	if (_xrInitialized)
+		_xrSupport->SetFrameSize(_width, _height);
 
-	if (_rightViewDisplayMode == ViewDisplayMode::Color || _rightViewDisplayMode == ViewDisplayMode::ReprojectionMask) {
-		_rightRenderer->RenderColorVisualization();
-	} 
-	else if (_rightViewDisplayMode == ViewDisplayMode::Depth && _rightRenderer->IsDepthTextureEnabled()) {
-		auto camera = _rightRenderer->GetCamera();
-		float nearPlane = camera ? camera->GetNearPlane() : 0.1f;
-		float farPlane = camera ? camera->GetFarPlane() : 100.0f;
+	// Eyes are presented into the window, or the offscreen framebuffer when headless
+	GLuint presentFramebuffer = _surface->GetPresentFramebuffer();
+	_leftRenderer->SetPresentFramebuffer(presentFramebuffer);
+	_rightRenderer->SetPresentFramebuffer(presentFramebuffer);
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, presentFramebuffer);
+	GLStateCache::Get().Viewport(0, 0, _width, _height);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		_rightRenderer->RenderDepthVisualization(nearPlane, farPlane);
+	if (_xrInitialized)
+		_xrInitialized = UpdateXRViews();
+	else if (!_surface->IsHeadless()) {
+		processInput(_surface->GetGlfwWindow());
+		handleMouseInput();
 	}
-}
 
-void Window::Run()
-{
-	if (_xrInitialized)
-		_xrSupport.InitCopyFrameBuffer(_width, _height);
+	// Only blocks when the slot we're about to reuse still belongs to a frame on the GPU
+	{
+		PROFILE_SCOPE("Frame fence wait");
+		_frameRing->BeginFrame();
+	}
+	_gpuProfiler->BeginFrame(_frameNumber);
+	GLStateCache::Get().BeginFrame();
 
-	glEnable(GL_DEPTH_TEST);
+	// Loads that finished since the last frame replace their placeholders before anything is recorded
+	if (!_assetLoader->IsIdle()) {
+		GpuScope scope(_gpuProfiler.get(), "Asset uploads");
+		_assetLoader->Update();
+	}
+	_meshManager->Update();
+
+	// GPU times come back a few frames late, hand each one to the telemetry once
+	uint64_t gpuFrame;
+	double gpuFrameMs;
+	if (_gpuProfiler->GetLastFrameTime(gpuFrame, gpuFrameMs) && gpuFrame != _lastGpuFrameReported) {
+		_frameTelemetry.RecordGpuTime(gpuFrame, gpuFrameMs);
+		_lastGpuFrameReported = gpuFrame;
+	}
 
-	while (!glfwWindowShouldClose(_window.get()))
-	{
-		currentFrame = (float)glfwGetTime();
-		deltaTime = currentFrame - lastFrame;
-		lastFrame = currentFrame;
-
-		// Calculate current FPS
-		_frameCount++;
-		_frameTimeAccumulator += deltaTime;
-		if (_frameTimeAccumulator >= 1.0f) {
-			_currentFPS = _frameCount / _frameTimeAccumulator;
-			_frameCount = 0;
-			_frameTimeAccumulator = 0.0f;
-		}
+	// Cameras are final for this frame, upload both eyes and the light once
+	UpdateFrameData();
 
-		PollEvents();
+	// The technique times itself (GetStats().gpuMs), a profiler scope here would only nest a second query pair
+	if (_stereoTechnique) {
+		StereoScene scene{ _models, _sceneLight };
+		_stereoTechnique->Render(scene, *_leftRenderer, *_rightRenderer, _stereoTargets);
+	}
 
-		glfwMakeContextCurrent(_window.get());
-
-		int newWidth, newHeight;
-		glfwGetFramebufferSize(_window.get(), &newWidth, &newHeight);
-		
-		// Update depth texture if window size changed
-		if (newWidth != _width || newHeight != _height) {
-			_width = newWidth;
-			_height = newHeight;
-			int textureWidth = _width / 2; // Each view takes half the screen width
-			int textureHeight = _height;
-			if (_leftRenderer)
-				_leftRenderer->SetupDepthTexture(textureWidth, textureHeight, false);  // Left viewport
-			if (_rightRenderer)
-				_rightRenderer->SetupDepthTexture(textureWidth, textureHeight, true);   // Right viewport
-		}
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, presentFramebuffer);
+	PresentViews();
 
-		if (_xrInitialized)
-			_xrSupport.SetFrameSize(_width, _height);
+	if (!_xrInitialized && !_surface->IsHeadless())
+	{
+		GLStateCache::Get().Viewport(0, 0, _width, _height);
+		GpuScope scope(_gpuProfiler.get(), "ImGui");
+		RenderImGui();
+	}
 
-		//glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		glViewport(0, 0, _width, _height);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	if (_xrInitialized) {
+		PROFILE_SCOPE("Copy");
+		GpuScope scope(_gpuProfiler.get(), "OpenXR CopyFrameBuffer");
+		_xrInitialized = _xrSupport->CopyFrameBuffer();
+	}
 
-		if (_xrInitialized)
-			_xrInitialized = UpdateXRViews();
-		else {
-			processInput(_window.get());
-			handleMouseInput();
-		}
+	_gpuProfiler->EndFrame();
+	{
+		PROFILE_SCOPE("Swap");
+		SwapBuffers();
+	}
 
-		glViewport(0, 0, _width / 2, _height);
-		RenderModelsLeft();
+	_frameRing->EndFrame();
 
-		GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
-		glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+	auto cpuEnd = std::chrono::steady_clock::now();
 
-		glViewport(_width / 2, 0, _width / 2, _height);
-		RenderModelsRight();
+	// xrWaitFrame already paces the loop to the headset
+	if (!_xrInitialized) {
+		PROFILE_SCOPE("Sleep");
+		_framePacer.WaitForNextFrame();
+	}
 
-		glFlush();
-		glFinish();
+	auto frameEnd = std::chrono::steady_clock::now();
+	double cpuMs = std::chrono::duration<double, std::milli>(cpuEnd - frameStart).count();
+	double intervalMs = _frameNumber > 0 ? std::chrono::duration<double, std::milli>(frameEnd - _lastFrameEnd).count() : 0.0;
+	float targetFPS = GetTargetFPS();
+	_frameTelemetry.SetTargetIntervalMs(!_xrInitialized && targetFPS > 0.0f ? 1000.0 / targetFPS : 0.0);
+	_frameTelemetry.RecordFrame(_frameNumber, cpuMs, intervalMs);
+	_lastFrameEnd = frameEnd;
+	_frameNumber++;
 
-		if (!_xrInitialized)
-		{
-			glViewport(0, 0, _width, _height);
-			RenderImGui();
-		}
+	PROFILE_FRAME_END();
+}
 
-		if (_xrInitialized)
-			_xrInitialized = _xrSupport.CopyFrameBuffer();
-        
-		SwapBuffers();
+void Window::SetSize(int width, int height)
+{
+	if (_surface)
+		_surface->SetSize(width, height);
+}
 
-		// FPS limiting
-		if (_targetFPS > 0.0f) {
-			float targetFrameTime = 1.0f / _targetFPS;
-			float frameEnd = (float)glfwGetTime();
-			float frameDuration = frameEnd - currentFrame;
-			
-			if (frameDuration < targetFrameTime) {
-				float sleepTime = targetFrameTime - frameDuration;
-				// Use Windows Sleep for more precise timing
-				Sleep((DWORD)(sleepTime * 1000.0f));
-			}
-		}
-	}
+float Window::GetPixelReuseRatio() const
+{
+	return _stereoTechnique ? _stereoTechnique->GetStats().pixelReuse : 0.0f;
+}
 
-	if (_xrInitialized)
-		_xrSupport.EndLoop();
+std::shared_ptr<Camera> Window::GetLeftCamera() const
+{
+	return _leftRenderer ? _leftRenderer->GetCamera() : nullptr;
+}
+
+std::shared_ptr<Camera> Window::GetRightCamera() const
+{
+	return _rightRenderer ? _rightRenderer->GetCamera() : nullptr;
 }
 
 int Window::GetWidth() const
@@ -347,40 +454,39 @@ int Window::GetHeight() const
 
 void Window::InitResources()
 {
-	glfwInit();
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
-	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	_surfaceReady = _surface->Init(_width, _height, _title);
+	if (!_surfaceReady) {
+		LOG_ERROR("Failed to create the GL surface");
+		return;
+	}
 
-	_window = std::unique_ptr<GLFWwindow, void(*)(GLFWwindow*)>(nullptr, [](GLFWwindow* w){ if (w) glfwDestroyWindow(w); });
-	GLFWwindow* raw = glfwCreateWindow(_width, _height, _title, NULL, NULL);
-	_window.reset(raw);
-	glfwMakeContextCurrent(_window.get());
-	glewInit();
+	LOG_INFO(std::string("GL Renderer: ") + reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+	// Nothing to interact with or present to a headset without a window
+	if (_surface->IsHeadless())
+		return;
 
 	// Setup Dear ImGui context
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
 	ImGuiIO& io = ImGui::GetIO(); (void)io;
 	ImGui::StyleColorsDark();
-	glfwSetWindowUserPointer(_window.get(), this);
+	glfwSetWindowUserPointer(_surface->GetGlfwWindow(), this);
 	
-	ImGui_ImplGlfw_InitForOpenGL(_window.get(), true);
+	ImGui_ImplGlfw_InitForOpenGL(_surface->GetGlfwWindow(), true);
 	ImGui_ImplOpenGL3_Init("#version 450");
 
 	unsigned char* tex_pixels = nullptr;
 	int tex_w, tex_h;
 	io.Fonts->GetTexDataAsRGBA32(&tex_pixels, &tex_w, &tex_h);
 
-	LOG_INFO(std::string("GL Renderer: ") + reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
-
-	_xrInitialized = _xrSupport.Init(m_apiType);
+	_xrInitialized = _xrSupport->Init(GraphicsAPI_Type::OpenGL);
 	if (_xrInitialized)
 	{
-		auto [recommendedWidth, recommendedHeight] = _xrSupport.GetRecommendedTargetSize();
+		auto [recommendedWidth, recommendedHeight] = _xrSupport->GetRecommendedTargetSize();
 		_width = static_cast<int>(recommendedWidth) * 2;
 		_height = static_cast<int>(recommendedHeight);
-		glfwSetWindowSize(_window.get(), _width, _height);
+		_surface->SetSize(_width, _height);
 	}
 }
 
@@ -443,7 +549,7 @@ void stereorizer::core::Window::OnMouseMove(double xpos, double ypos)
 	lastX = (float)xpos;
 	lastY = (float)ypos;
 
-	if (glfwGetMouseButton(_window.get(), GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS)
+	if (glfwGetMouseButton(_surface->GetGlfwWindow(), GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS)
 	{
 		const float sensitivity = 0.1f;
 		xoffset *= sensitivity;
@@ -506,6 +612,7 @@ void Window::SetIPD(float ipd) {
 }
 
 void stereorizer::core::Window::RenderImGui() {
+	PROFILE_SCOPE("ImGui");
 	ImGui_ImplOpenGL3_NewFrame();
 	ImGui_ImplGlfw_NewFrame();
 	ImGui::NewFrame();
@@ -546,7 +653,6 @@ void stereorizer::core::Window::RenderImGui() {
 	ImGui::Text("Right View Display Mode:");
 	bool rightShowColor = (GetRightViewDisplayMode() == ViewDisplayMode::Color);
 	bool rightShowDepth = (GetRightViewDisplayMode() == ViewDisplayMode::Depth);
-	bool rightShowReprojection = (GetRightViewDisplayMode() == ViewDisplayMode::ReprojectionMask);
 	
 	if (ImGui::RadioButton("Color##Right", rightShowColor)) {
 		SetRightViewDisplayMode(ViewDisplayMode::Color);
@@ -554,13 +660,36 @@ void stereorizer::core::Window::RenderImGui() {
 	if (ImGui::RadioButton("Depth##Right", rightShowDepth)) {
 		SetRightViewDisplayMode(ViewDisplayMode::Depth);
 	}
-	if (ImGui::RadioButton("Reprojection Mask##Right", rightShowReprojection)) {
-		SetRightViewDisplayMode(ViewDisplayMode::ReprojectionMask);
-	}
 
 	// End columns
 	ImGui::Columns(1);
 	
+	ImGui::Separator();
+
+	// Stereo technique, anything registered shows up here
+	ImGui::Text("Stereo Technique");
+	for (const auto& entry : StereoTechniqueRegistry::Get().GetEntries()) {
+		IStereoTechnique* technique = FindStereoTechnique(entry.name);
+		if (!technique || !technique->IsSupported()) {
+			ImGui::TextDisabled("%s (not supported)", entry.name.c_str());
+			continue;
+		}
+		if (ImGui::RadioButton(entry.name.c_str(), entry.name == _stereoTechniqueName)) {
+			SetStereoTechnique(entry.name);
+		}
+		if (ImGui::IsItemHovered()) {
+			ImGui::SetTooltip("%s", entry.description.c_str());
+		}
+	}
+	if (_stereoTechnique) {
+		const StereoTechniqueStats& stats = _stereoTechnique->GetStats();
+		ImGui::Text("Technique GPU: %.3f ms, pixel reuse: %.1f %%", std::max(stats.gpuMs, 0.0), stats.pixelReuse * 100.0f);
+		const RenderQueueStats& queueStats = _stereoTechnique->GetRenderQueue().GetStats();
+		ImGui::Text("Render queue: %zu packets from %u threads, %d program / %d VAO switches", queueStats.packetCount, queueStats.bucketCount, queueStats.variantChanges, queueStats.meshChanges);
+		ImGui::Text("Record %.3f ms, sort %.3f ms", queueStats.recordMs, queueStats.sortMs);
+		_stereoTechnique->DrawSettings(*_leftRenderer, *_rightRenderer);
+	}
+
 	ImGui::Separator();
 	
 	// FPS Controls
@@ -570,7 +699,110 @@ void stereorizer::core::Window::RenderImGui() {
 		SetTargetFPS(currentTargetFPS);
 	}
 	ImGui::Text("Current FPS: %.1f", GetCurrentFPS());
+	const FramePacingStats& pacing = _framePacer.GetStats();
+	ImGui::Text("Pacing error: last %.1f us, mean %.1f us, max %.1f us", pacing.lastErrorUs, pacing.meanErrorUs, pacing.maxErrorUs);
+	ImGui::Text("Missed deadlines: %llu / %llu frames", (unsigned long long)pacing.missedDeadlines, (unsigned long long)(pacing.frames + pacing.missedDeadlines));
+	if (ImGui::Button("Reset pacing stats")) {
+		_framePacer.ResetStats();
+	}
+
+	if (ImGui::CollapsingHeader("Frame Times")) {
+		FrameTimeSummary cpu = _frameTelemetry.GetCpuSummary();
+		FrameTimeSummary gpu = _frameTelemetry.GetGpuSummary();
+		FrameTimeSummary interval = _frameTelemetry.GetIntervalSummary();
+		ImGui::Text("CPU      p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", cpu.p50Ms, cpu.p95Ms, cpu.p99Ms, cpu.maxMs);
+		ImGui::Text("GPU      p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", gpu.p50Ms, gpu.p95Ms, gpu.p99Ms, gpu.maxMs);
+		ImGui::Text("Interval p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", interval.p50Ms, interval.p95Ms, interval.p99Ms, interval.maxMs);
+		ImGui::Text("Missed frames: %llu / %llu", (unsigned long long)_frameTelemetry.GetMissedFrames(), (unsigned long long)interval.frames);
+
+		std::vector<FrameSample> history = _frameTelemetry.GetHistory();
+		std::vector<float> intervals, cpuTimes, gpuTimes;
+		for (const auto& sample : history) {
+			intervals.push_back(sample.intervalMs);
+			cpuTimes.push_back(sample.cpuMs);
+			gpuTimes.push_back(std::max(sample.gpuMs, 0.0f));
+		}
+		// Same scale for all graphs, twice the target interval keeps a missed frame visible
+		double target = _frameTelemetry.GetTargetIntervalMs();
+		float scaleMax = (float)std::max(target > 0.0 ? 2.0 * target : 0.0, interval.p99Ms * 1.2);
+		ImGui::PlotLines("Interval", intervals.data(), (int)intervals.size(), 0, nullptr, 0.0f, scaleMax, ImVec2(0, 60));
+		ImGui::PlotLines("CPU", cpuTimes.data(), (int)cpuTimes.size(), 0, nullptr, 0.0f, scaleMax, ImVec2(0, 60));
+		ImGui::PlotLines("GPU", gpuTimes.data(), (int)gpuTimes.size(), 0, nullptr, 0.0f, scaleMax, ImVec2(0, 60));
+		if (ImGui::Button("Reset frame times")) {
+			_frameTelemetry.Reset();
+		}
+	}
+	int framesInFlight = GetFramesInFlight();
+	if (ImGui::SliderInt("Frames in flight", &framesInFlight, 1, FrameRing::MaxFramesInFlight)) {
+		SetFramesInFlight(framesInFlight);
+	}
+	ImGui::Text("CPU wait on frame fence: %.3f ms", _frameRing->GetLastWaitMs());
+	const GLStateStats& glCalls = GLStateCache::Get().GetLastFrameStats();
+	ImGui::Text("GL state calls: %llu issued, %llu skipped", (unsigned long long)glCalls.issued, (unsigned long long)glCalls.skipped);
+	const AssetLoaderStats& assets = _assetLoader->GetStats();
+	ImGui::Text("Assets: %zu loading, %zu waiting for upload, %zu uploaded, %zu failed, %.1f MB staged",
+		assets.loading, assets.waitingUpload, assets.uploaded, assets.failed, assets.stagedBytes / (1024.0 * 1024.0));
+	const MeshManagerStats& meshes = _meshManager->GetStats();
+	ImGui::Text("Meshes: %zu (%zu referenced), GPU %.1f MB, CPU %.1f MB, %llu evicted",
+		meshes.meshCount, meshes.referencedCount, meshes.gpuBytes / (1024.0 * 1024.0), meshes.cpuBytes / (1024.0 * 1024.0), (unsigned long long)meshes.evictions);
+	int meshBudgetMB = (int)(meshes.gpuBudget >> 20);
+	if (ImGui::SliderInt("Mesh GPU budget (MB, 0 = unlimited)", &meshBudgetMB, 0, 4096)) {
+		_meshManager->SetGpuBudget((size_t)meshBudgetMB << 20);
+	}
 	
+	ImGui::Separator();
+	if (ImGui::CollapsingHeader("GPU Timings")) {
+		bool profiling = _gpuProfiler->IsEnabled();
+		if (ImGui::Checkbox("Enable GPU timer queries", &profiling)) {
+			_gpuProfiler->SetEnabled(profiling);
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Reset")) {
+			_gpuProfiler->ResetHistory();
+		}
+		ImGui::SameLine();
+		if (ImGui::Button("Export CSV")) {
+			_gpuProfiler->ExportCsv("gpu_timings.csv");
+		}
+
+		if (ImGui::BeginTable("GpuTimings", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+			ImGui::TableSetupColumn("Scope");
+			ImGui::TableSetupColumn("avg ms");
+			ImGui::TableSetupColumn("p50 ms");
+			ImGui::TableSetupColumn("p95 ms");
+			ImGui::TableSetupColumn("p99 ms");
+			ImGui::TableHeadersRow();
+			for (const auto& scope : _gpuProfiler->GetStats()) {
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				// Indent(0) would fall back to the default spacing
+				if (scope.depth > 0) ImGui::Indent(scope.depth * 10.0f);
+				ImGui::TextUnformatted(scope.name.c_str());
+				if (scope.depth > 0) ImGui::Unindent(scope.depth * 10.0f);
+				ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.averageMs);
+				ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.p50Ms);
+				ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.p95Ms);
+				ImGui::TableNextColumn(); ImGui::Text("%.3f", scope.p99Ms);
+			}
+			ImGui::EndTable();
+		}
+	}
+
+	if (ImGui::CollapsingHeader("CPU Trace")) {
+		if (!CpuProfiler::IsCompiledIn()) {
+			ImGui::TextWrapped("Build with STEREORIZER_ENABLE_PROFILING to record CPU scopes.");
+		}
+		else if (CpuProfiler::Get().IsCapturing()) {
+			ImGui::Text("Capturing, %d frames left", CpuProfiler::Get().GetRemainingFrames());
+		}
+		else {
+			ImGui::SliderInt("Frames", &_traceFrameCount, 1, 600);
+			if (ImGui::Button("Capture to cpu_trace.json")) {
+				CpuProfiler::Get().BeginCapture(_traceFrameCount, "cpu_trace.json");
+			}
+		}
+	}
+
 	ImGui::Separator();
 	ImGui::Text("Inter-Pupillary Distance");
 	ImGui::TextWrapped("Adjust the distance between the left and right eye cameras for comfortable stereo viewing.");
@@ -588,7 +820,7 @@ void stereorizer::core::Window::handleMouseInput() {
 	}
 
 	double xpos, ypos;
-	glfwGetCursorPos(_window.get(), &xpos, &ypos);
+	glfwGetCursorPos(_surface->GetGlfwWindow(), &xpos, &ypos);
 
 	if (firstMouse) {
 		lastX = (float)xpos;
@@ -601,7 +833,7 @@ void stereorizer::core::Window::handleMouseInput() {
 	lastX = (float)xpos;
 	lastY = (float)ypos;
 
-	if (glfwGetMouseButton(_window.get(), GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) {
+	if (glfwGetMouseButton(_surface->GetGlfwWindow(), GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) {
 		const float sensitivity = 0.1f;
 		xoffset *= sensitivity;
 		yoffset *= sensitivity;
@@ -635,37 +867,55 @@ ViewDisplayMode Window::GetRightViewDisplayMode() const {
 }
 
 GLuint Window::GetLeftViewDepthTexture() const {
-	if (_leftRenderer && _leftRenderer->IsDepthTextureEnabled()) {
-		return _leftRenderer->GetDepthTexture();
-	}
-	return 0;
+	return _stereoTargets.depthTextures[0];
 }
 
 GLuint Window::GetRightViewDepthTexture() const {
-	if (_rightRenderer && _rightRenderer->IsDepthTextureEnabled()) {
-		return _rightRenderer->GetDepthTexture();
-	}
-	return 0;
+	return _stereoTargets.depthTextures[1];
 }
 
 GLuint Window::GetLeftViewColorTexture() const {
-	if (_leftRenderer && _leftRenderer->IsDepthTextureEnabled()) {
-		return _leftRenderer->GetColorTexture();
-	}
-	return 0;
+	return _stereoTargets.colorTextures[0];
 }
 
 GLuint Window::GetRightViewColorTexture() const {
-	if (_rightRenderer && _rightRenderer->IsDepthTextureEnabled()) {
-		return _rightRenderer->GetColorTexture();
-	}
-	return 0;
+	return _stereoTargets.colorTextures[1];
 }
 
+IStereoTechnique* Window::FindStereoTechnique(const std::string& name) {
+	auto it = _stereoTechniques.find(name);
+	if (it != _stereoTechniques.end())
+		return it->second.get();
+
+	auto technique = StereoTechniqueRegistry::Get().Create(name);
+	if (!technique)
+		return nullptr;
+	technique->SetGpuProfiler(_gpuProfiler.get());
+	return _stereoTechniques.emplace(name, std::move(technique)).first->second.get();
+}
+
+bool Window::SetStereoTechnique(const std::string& name) {
+	if (!_leftRenderer)
+		return false;
+
+	IStereoTechnique* technique = FindStereoTechnique(name);
+	if (!technique)
+		return false;
+	if (!technique->IsSupported()) {
+		LOG_ERROR("Stereo technique " + name + " is not supported here, keeping " + _stereoTechniqueName);
+		return false;
+	}
+	if (technique != _stereoTechnique) {
+		technique->Setup(_stereoTargets.eyeWidth, _stereoTargets.eyeHeight);
+		_stereoTechnique = technique;
+		_stereoTechniqueName = name;
+	}
+	return true;
+}
 
 float stereorizer::core::Window::GetTargetFPS() const
 {
-	return _targetFPS;
+	return _framePacer.GetTargetFPS();
 }
 float stereorizer::core::Window::GetCurrentFPS() const
 {
@@ -673,5 +923,21 @@ float stereorizer::core::Window::GetCurrentFPS() const
 }
 void stereorizer::core::Window::SetTargetFPS(float targetFPS)
 {
-	_targetFPS = targetFPS;
+	_framePacer.SetTargetFPS(targetFPS);
+}
+
+const FrameTelemetry& Window::GetFrameTelemetry() const {
+	return _frameTelemetry;
+}
+
+int Window::GetFramesInFlight() const {
+	return _frameRing->GetFramesInFlight();
+}
+
+double Window::GetLastFenceWaitMs() const {
+	return _frameRing->GetLastWaitMs();
+}
+
+void Window::SetFramesInFlight(int count) {
+	_frameRing->SetFramesInFlight(count);
 }
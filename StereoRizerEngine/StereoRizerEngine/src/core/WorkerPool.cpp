@@ -0,0 +1,114 @@
+#include "core/WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+using namespace stereorizer::core;
+
+namespace
+{
+	// Shared by the caller and the helpers of one ParallelFor. Helpers that only get scheduled
+	// after the caller returned find no chunk left, the shared_ptr keeps this alive for them.
+	struct RangeState {
+		WorkerPool::RangeJob job;
+		size_t count = 0;
+		size_t chunkSize = 0;
+		size_t chunkCount = 0;
+		std::atomic<size_t> nextChunk{ 0 };
+		std::atomic<size_t> doneChunks{ 0 };
+		std::mutex mutex;
+		std::condition_variable done;
+
+		void RunChunks(unsigned slot) {
+			size_t chunk;
+			while ((chunk = nextChunk.fetch_add(1)) < chunkCount) {
+				size_t begin = chunk * chunkSize;
+				job(begin, std::min(count, begin + chunkSize), slot);
+				if (doneChunks.fetch_add(1) + 1 == chunkCount) {
+					std::lock_guard<std::mutex> lock(mutex);
+					done.notify_all();
+				}
+			}
+		}
+	};
+}
+
+WorkerPool& WorkerPool::Get() {
+	static WorkerPool pool;
+	return pool;
+}
+
+WorkerPool::WorkerPool(unsigned threadCount) {
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+	for (unsigned i = 0; i < threadCount; i++)
+		_threads.emplace_back(&WorkerPool::WorkerLoop, this, i + 1);
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_wake.notify_all();
+	for (auto& thread : _threads)
+		thread.join();
+}
+
+void WorkerPool::WorkerLoop(unsigned slot) {
+	for (;;) {
+		std::function<void(unsigned)> task;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+			if (_tasks.empty())
+				return;
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+		}
+		task(slot);
+	}
+}
+
+void WorkerPool::Submit(std::function<void()> task) {
+	if (_threads.empty()) {
+		task();
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_tasks.push_back([task = std::move(task)](unsigned) { task(); });
+	}
+	_wake.notify_one();
+}
+
+void WorkerPool::ParallelFor(size_t count, size_t minChunk, const RangeJob& job) {
+	if (count == 0)
+		return;
+
+	size_t chunkSize = std::max<size_t>(minChunk, (count + GetSlotCount() - 1) / GetSlotCount());
+	size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+	if (chunkCount == 1 || _threads.empty()) {
+		job(0, count, 0);
+		return;
+	}
+
+	auto state = std::make_shared<RangeState>();
+	state->job = job;
+	state->count = count;
+	state->chunkSize = chunkSize;
+	state->chunkCount = chunkCount;
+
+	size_t helpers = std::min(chunkCount - 1, _threads.size());
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (size_t i = 0; i < helpers; i++)
+			_tasks.push_back([state](unsigned slot) { state->RunChunks(slot); });
+	}
+	_wake.notify_all();
+
+	state->RunChunks(0);
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->done.wait(lock, [&] { return state->doneChunks.load() == chunkCount; });
+}
@@ -0,0 +1,162 @@
+#include "graphics/AssetLoader.h"
+#include "core/Common.h"
+#include "core/CpuProfiler.h"
+#include "core/WorkerPool.h"
+
+#include <chrono>
+
+using namespace stereorizer::core;
+using namespace stereorizer::graphics;
+
+namespace
+{
+	// Unit box centred on the origin, one quad per face so every face has its own normal
+	MeshData BuildPlaceholderBox() {
+		MeshData data;
+		const glm::vec3 normals[6] = {
+			{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+		};
+		for (const glm::vec3& normal : normals) {
+			// Two axes spanning the face, ordered so the quad winds counter-clockwise seen from outside
+			glm::vec3 u = glm::vec3(normal.y, normal.z, normal.x);
+			glm::vec3 v = glm::cross(normal, u);
+			uint32_t first = (uint32_t)data.vertices.size();
+			const float corners[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+			for (const auto& corner : corners)
+				data.vertices.push_back({ 0.5f * (normal + corner[0] * u + corner[1] * v), normal });
+			for (uint32_t index : { 0u, 1u, 2u, 0u, 2u, 3u })
+				data.indices.push_back(first + index);
+		}
+
+		data.layout = VertexLayout::fromFloatSizes({ 3, 3 });
+		data.vertexData = data.vertices.data();
+		data.vertexSize = data.vertices.size() * sizeof(Vertex);
+		data.indexData = data.indices.data();
+		data.indexCount = data.indices.size();
+		data.boundsMin = glm::vec3(-0.5f);
+		data.boundsMax = glm::vec3(0.5f);
+		return data;
+	}
+}
+
+AssetLoader::AssetLoader()
+	: _completions(std::make_shared<Completions>()) {
+	_staging.Create(StagingSize);
+	_placeholder = std::make_shared<Mesh>(BuildPlaceholderBox());
+}
+
+AssetLoader::~AssetLoader() {
+	// Loads still on a worker finish into _completions and are dropped with it. Meshes that never
+	// got their data draw nothing once the placeholder is gone.
+	auto abandon = [](Request& request) {
+		request.mesh->ClearPlaceholder();
+		request.uploaded.set_value(false);
+	};
+	for (auto& [job, request] : _loading)
+		abandon(request);
+	for (auto& request : _uploads)
+		abandon(request);
+}
+
+MeshHandle AssetLoader::LoadMesh(const std::string& path, const MeshImportOptions& options) {
+	auto job = std::make_shared<LoadJob>();
+	job->path = path;
+	job->options = options;
+
+	Request request;
+	request.job = job;
+	request.mesh = std::make_shared<Mesh>(std::shared_ptr<const Mesh>(_placeholder));
+	MeshHandle handle{ request.mesh, request.uploaded.get_future().share() };
+	_loading.emplace(job.get(), std::move(request));
+	_stats.loading = _loading.size();
+
+	std::weak_ptr<Completions> completions = _completions;
+	WorkerPool::Get().Submit([job, completions] {
+		job->loaded = Mesh::Load(job->path, job->options, job->data);
+		if (auto target = completions.lock()) {
+			{
+				std::lock_guard<std::mutex> lock(target->mutex);
+				target->jobs.push_back(job);
+			}
+			target->ready.notify_one();
+		}
+	});
+	return handle;
+}
+
+void AssetLoader::CollectCompleted(bool wait) {
+	std::deque<std::shared_ptr<LoadJob>> completed;
+	{
+		std::unique_lock<std::mutex> lock(_completions->mutex);
+		if (wait)
+			_completions->ready.wait(lock, [this] { return !_completions->jobs.empty(); });
+		completed.swap(_completions->jobs);
+	}
+
+	for (auto& job : completed) {
+		auto found = _loading.find(job.get());
+		if (found == _loading.end())
+			continue;
+		Request request = std::move(found->second);
+		_loading.erase(found);
+
+		if (job->loaded) {
+			_uploads.push_back(std::move(request));
+			continue;
+		}
+		LOG_ERROR("Failed to load " + job->path);
+		request.mesh->ClearPlaceholder();
+		request.uploaded.set_value(false);
+		_stats.failed++;
+	}
+	_stats.loading = _loading.size();
+}
+
+void AssetLoader::UploadQueued(bool wait) {
+	size_t budget = 0;
+	while (!_uploads.empty()) {
+		Request& request = _uploads.front();
+		const MeshData& data = request.job->data;
+		size_t size = data.vertexSize + data.GetIndexBytes();
+		if (!wait && budget > 0 && budget + size > UploadBudget)
+			break;
+		if (!request.mesh->Upload(data, _staging)) {
+			// In order, a smaller load behind this one waits too
+			if (!wait)
+				break;
+			// Finish blocks on the oldest copies instead, staged ones need their fence for that
+			_staging.Fence();
+			if (!_staging.CanStage(size + 2 * StagingBuffer::Alignment, true) || !request.mesh->Upload(data, _staging))
+				request.mesh->Upload(data);
+		}
+
+		budget += size;
+		request.uploaded.set_value(true);
+		_stats.uploaded++;
+		// Drops the CPU copy or the mapping of the cache entry
+		_uploads.pop_front();
+	}
+	_staging.Fence();
+	_stats.stagedBytes = _staging.GetStagedBytes();
+}
+
+void AssetLoader::Update() {
+	if (IsIdle())
+		return;
+
+	PROFILE_SCOPE("AssetLoader::Update");
+	auto start = std::chrono::steady_clock::now();
+	CollectCompleted(false);
+	UploadQueued(false);
+	_stats.waitingUpload = _uploads.size();
+	_stats.lastUploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void AssetLoader::Finish() {
+	PROFILE_SCOPE("AssetLoader::Finish");
+	while (!IsIdle()) {
+		CollectCompleted(_uploads.empty());
+		UploadQueued(true);
+	}
+	_stats.waitingUpload = 0;
+}
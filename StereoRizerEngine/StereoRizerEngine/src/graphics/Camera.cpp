@@ -4,6 +4,14 @@
 
 using namespace stereorizer::graphics;
 
+namespace
+{
+	constexpr UniformId ProjectionMatrixUniform("projectionMatrix");
+	constexpr UniformId ViewMatrixUniform("viewMatrix");
+	constexpr UniformId LeftProjectionMatrixUniform("leftProjectionMatrix");
+	constexpr UniformId LeftViewMatrixUniform("leftViewMatrix");
+}
+
 Camera::Camera(float fov, float aspectRatio, float nearPlane, float farPlane)
 	: _FOV(fov), _AspectRatio(aspectRatio), _NearPlane(nearPlane), _FarPlane(farPlane), _yaw(-90.0f), _pitch(0.0f)
 {
@@ -96,15 +104,25 @@ const glm::mat4& Camera::GetProjectionMatrix() const noexcept {
 }
 
 void Camera::UploadToShader(std::shared_ptr<Shader> shader) const {
-	unsigned int projLoc = glGetUniformLocation(shader->GetID(), "projectionMatrix");
+	GLint projLoc = shader->GetUniformLocation(ProjectionMatrixUniform);
 	glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(_projectionMatrix));
-	unsigned int viewLoc = glGetUniformLocation(shader->GetID(), "viewMatrix");
+	GLint viewLoc = shader->GetUniformLocation(ViewMatrixUniform);
 	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(_viewMatrix));
 }
 
+void Camera::UploadStereoToShader(std::shared_ptr<Shader> shader, const Camera& left, const Camera& right) {
+	glm::mat4 projections[2] = { left._projectionMatrix, right._projectionMatrix };
+	glm::mat4 views[2] = { left._viewMatrix, right._viewMatrix };
+
+	GLint projLoc = shader->GetUniformLocation(ProjectionMatrixUniform);
+	glUniformMatrix4fv(projLoc, 2, GL_FALSE, glm::value_ptr(projections[0]));
+	GLint viewLoc = shader->GetUniformLocation(ViewMatrixUniform);
+	glUniformMatrix4fv(viewLoc, 2, GL_FALSE, glm::value_ptr(views[0]));
+}
+
 void Camera::UploadToReprojectionShader(std::shared_ptr<Shader> shader) const {
-	unsigned int projLoc = glGetUniformLocation(shader->GetID(), "leftProjectionMatrix");
+	GLint projLoc = shader->GetUniformLocation(LeftProjectionMatrixUniform);
 	glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(_projectionMatrix));
-	unsigned int viewLoc = glGetUniformLocation(shader->GetID(), "leftViewMatrix");
+	GLint viewLoc = shader->GetUniformLocation(LeftViewMatrixUniform);
 	glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(_viewMatrix));
 }
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "graphics/DepthPyramid.h"
+#include "graphics/GLStateCache.h"
+#include "core/Common.h"
+
+#include <algorithm>
+
+using namespace stereorizer::graphics;
+
+namespace
+{
+	constexpr UniformId DepthTextureUniform("depthTexture");
+
+	// Match the "binding =" qualifiers and the work group size in DepthPyramid.shader
+	constexpr GLuint DstLevelImageUnit = 0;
+	constexpr GLuint SrcLevelImageUnit = 1;
+	constexpr int GroupSize = 8;
+
+	GLuint GroupCount(int size) {
+		return (GLuint)((size + GroupSize - 1) / GroupSize);
+	}
+}
+
+DepthPyramid::DepthPyramid() {
+	// Shader and texture are created on the first Build(), the context might not be ready yet
+}
+
+DepthPyramid::~DepthPyramid() {
+	DeleteResources();
+	for (GLuint& query : _timerQueries) {
+		if (query != 0) {
+			glDeleteQueries(1, &query);
+			query = 0;
+		}
+	}
+}
+
+void DepthPyramid::DeleteResources() {
+	if (_texture != 0) {
+		GLStateCache::Get().DeleteTextures(1, &_texture);
+		_texture = 0;
+	}
+	_levelCount = 0;
+	_built = false;
+}
+
+bool DepthPyramid::CreateResources(int width, int height) {
+	if (!_shader) {
+		try {
+			_shader = std::make_shared<Shader>("resources/shaders/DepthPyramid.shader");
+		} catch (const std::exception& e) {
+			LOG_ERROR(std::string("Failed to load depth pyramid shader: ") + e.what());
+			return false;
+		}
+		glGenQueries(2, _timerQueries);
+	}
+	if (_shader->GetID() == 0)
+		return false;
+
+	if (_texture != 0 && width == _width && height == _height)
+		return true;
+
+	DeleteResources();
+	_width = width;
+	_height = height;
+	_levelCount = 1;
+	while ((std::max(width, height) >> _levelCount) > 0)
+		_levelCount++;
+
+	GLStateSnapshot savedState = GLStateCache::Get().Save();
+	glGenTextures(1, &_texture);
+	GLStateCache::Get().BindTexture(GL_TEXTURE_2D, _texture);
+	glTexStorage2D(GL_TEXTURE_2D, _levelCount, GL_RG32F, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	GLStateCache::Get().Restore(savedState);
+
+	LOG_INFO("Depth pyramid created: " + std::to_string(width) + "x" + std::to_string(height) + ", " + std::to_string(_levelCount) + " levels");
+	return true;
+}
+
+void DepthPyramid::ReadBuildTime(int index) {
+	if (!_timerPending[index])
+		return;
+
+	GLint available = GL_FALSE;
+	glGetQueryObjectiv(_timerQueries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return;
+
+	GLuint64 elapsed = 0;
+	glGetQueryObjectui64v(_timerQueries[index], GL_QUERY_RESULT, &elapsed);
+	_timerPending[index] = false;
+	_lastBuildTimeMs = (double)elapsed / 1.0e6;
+	if (_lastBuildTimeMs > BuildBudgetMs)
+		_skipBuilds = OverBudgetSkipBuilds;
+}
+
+bool DepthPyramid::Build(GLuint depthTexture, int width, int height, bool holesAsFar) {
+	if (depthTexture == 0 || width <= 0 || height <= 0 || !CreateResources(width, height))
+		return false;
+
+	ReadBuildTime(0);
+	ReadBuildTime(1);
+	if (_skipBuilds > 0) {
+		// Last frame's levels would be stale, the consumers fall back to not using any
+		_skipBuilds--;
+		_built = false;
+		return false;
+	}
+	// Skip timing this build rather than overwrite a result nobody has read yet
+	bool timed = !_timerPending[_timerIndex];
+	if (timed)
+		glBeginQuery(GL_TIME_ELAPSED, _timerQueries[_timerIndex]);
+
+	GLStateCache& state = GLStateCache::Get();
+	GLStateSnapshot savedState = state.Save();
+
+	_shader->ReloadIfChanged();
+
+	// Level 0: copy of the depth, min == max
+	_shader->EnableDefine("FIRST_LEVEL");
+	if (holesAsFar)
+		_shader->EnableDefine("HOLES_AS_FAR");
+	_shader->ActivateVariant();
+	state.BindTexture(0, GL_TEXTURE_2D, depthTexture);
+	glUniform1i(_shader->GetUniformLocation(DepthTextureUniform), 0);
+	glBindImageTexture(DstLevelImageUnit, _texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+	glDispatchCompute(GroupCount(width), GroupCount(height), 1);
+	_shader->DisableDefine("FIRST_LEVEL");
+	_shader->DisableDefine("HOLES_AS_FAR");
+
+	// Every further level reduces the one below it
+	_shader->ActivateVariant();
+	for (int level = 1; level < _levelCount; level++) {
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+		glBindImageTexture(SrcLevelImageUnit, _texture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_RG32F);
+		glBindImageTexture(DstLevelImageUnit, _texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG32F);
+		glDispatchCompute(GroupCount(std::max(1, width >> level)), GroupCount(std::max(1, height >> level)), 1);
+	}
+
+	// Sampled by reprojection and culling next
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	state.Restore(savedState);
+
+	if (timed) {
+		glEndQuery(GL_TIME_ELAPSED);
+		_timerPending[_timerIndex] = true;
+		_timerIndex = 1 - _timerIndex;
+	}
+
+	_built = true;
+	return true;
+}
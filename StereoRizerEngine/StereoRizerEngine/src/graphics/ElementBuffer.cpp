@@ -1,12 +1,40 @@
 #include <graphics/ElementBuffer.h>
+#include <algorithm>
 
 using namespace stereorizer::graphics;
 
-ElementBuffer::ElementBuffer(const std::vector<uint32_t>& indices, BufferAccessType accessType, BufferCallType callType) : indicesSize(indices.size())
+namespace
+{
+	GLenum indexTypeOf(const std::vector<uint32_t>& indices)
+	{
+		uint32_t maxIndex = indices.empty() ? 0 : *std::max_element(indices.begin(), indices.end());
+		return ElementBuffer::indexTypeFor((size_t)maxIndex + 1);
+	}
+}
+
+ElementBuffer::ElementBuffer(const std::vector<uint32_t>& indices, BufferAccessType accessType, BufferCallType callType) : indicesSize(indices.size()), indexType(indexTypeOf(indices))
+{
+	glGenBuffers(1, &id);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+	GLenum usage = GL_STREAM_DRAW + (int32_t)accessType + (int32_t)callType;
+	if (indexType == GL_UNSIGNED_SHORT)
+	{
+		std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), usage);
+		return;
+	}
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), usage);
+}
+
+ElementBuffer::ElementBuffer(const uint32_t* indices, size_t count) : ElementBuffer(indices, count, GL_UNSIGNED_INT)
+{
+}
+
+ElementBuffer::ElementBuffer(const void* indices, size_t count, GLenum indexType) : indicesSize((int)count), indexType(indexType)
 {
 	glGenBuffers(1, &id);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STREAM_DRAW + (int32_t)accessType + (int32_t)callType);
+	glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, count * indexBytes(), indices, 0);
 }
 
 ElementBuffer::~ElementBuffer()
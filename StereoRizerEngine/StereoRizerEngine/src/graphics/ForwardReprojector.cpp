@@ -0,0 +1,173 @@
+#include "graphics/ForwardReprojector.h"
+#include "graphics/GLStateCache.h"
+#include "core/Common.h"
+
+#include <algorithm>
+
+using namespace stereorizer::graphics;
+
+namespace
+{
+	constexpr UniformId LeftDepthTextureUniform("leftDepthTexture");
+	constexpr UniformId LeftColorTextureUniform("leftColorTexture");
+	constexpr UniformId FillRadiusUniform("fillRadius");
+
+	// Match the "binding =" qualifiers in ForwardReprojection.shader
+	constexpr GLuint ScatterDepthImageUnit = 0;
+	constexpr GLuint ScatterColorImageUnit = 1;
+	constexpr GLuint RightColorImageUnit = 2;
+	constexpr GLuint ResolvedDepthImageUnit = 3;
+	constexpr GLuint CounterBufferBinding = 1;
+
+	constexpr GLuint EmptyDepth = 0xFFFFFFFFu;
+
+	GLuint CreateStorageTexture(GLenum format, int width, int height) {
+		GLuint texture = 0;
+		glGenTextures(1, &texture);
+		GLStateCache::Get().BindTexture(GL_TEXTURE_2D, texture);
+		glTexStorage2D(GL_TEXTURE_2D, 1, format, width, height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		return texture;
+	}
+}
+
+ForwardReprojector::ForwardReprojector() {
+	// Shader and textures are created on the first Reproject(), the context might not be ready yet
+}
+
+ForwardReprojector::~ForwardReprojector() {
+	DeleteResources();
+}
+
+void ForwardReprojector::SetFillRadius(int radius) {
+	_fillRadius = std::clamp(radius, 0, MaxFillRadius);
+}
+
+void ForwardReprojector::DeleteResources() {
+	GLuint textures[] = { _scatterDepth, _scatterColor, _resolvedDepth };
+	for (GLuint texture : textures) {
+		if (texture != 0)
+			GLStateCache::Get().DeleteTextures(1, &texture);
+	}
+	_scatterDepth = _scatterColor = _resolvedDepth = 0;
+
+	if (_counterBuffer != 0) {
+		glDeleteBuffers(1, &_counterBuffer);
+		_counterBuffer = 0;
+	}
+	if (_countersFence) {
+		glDeleteSync(_countersFence);
+		_countersFence = nullptr;
+	}
+}
+
+bool ForwardReprojector::CreateResources(int width, int height) {
+	if (!_shader) {
+		try {
+			_shader = std::make_shared<Shader>("resources/shaders/ForwardReprojection.shader",
+				std::unordered_map<std::string, std::string>{ { "GROUP_SIZE", std::to_string(GroupSize) } });
+		} catch (const std::exception& e) {
+			LOG_ERROR(std::string("Failed to load forward reprojection shader: ") + e.what());
+			return false;
+		}
+	}
+	if (_shader->GetID() == 0)
+		return false;
+
+	if (_scatterDepth != 0 && width == _width && height == _height)
+		return true;
+
+	DeleteResources();
+	_width = width;
+	_height = height;
+
+	GLStateSnapshot savedState = GLStateCache::Get().Save();
+	_scatterDepth = CreateStorageTexture(GL_R32UI, width, height);
+	_scatterColor = CreateStorageTexture(GL_RGBA8, width, height);
+	_resolvedDepth = CreateStorageTexture(GL_R32F, width, height);
+	GLStateCache::Get().Restore(savedState);
+
+	glGenBuffers(1, &_counterBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _counterBuffer);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, 2 * sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	LOG_INFO("Forward reprojection targets created: " + std::to_string(width) + "x" + std::to_string(height));
+	return true;
+}
+
+void ForwardReprojector::ReadCounters() {
+	if (!_countersFence)
+		return;
+
+	// Written by the previous frame's dispatch. If that hasn't retired yet the sample is
+	// dropped, reading it would stall the CPU on the GPU
+	GLenum status = glClientWaitSync(_countersFence, 0, 0);
+	glDeleteSync(_countersFence);
+	_countersFence = nullptr;
+	if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		return;
+
+	GLuint counters[2] = { 0, 0 };
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _counterBuffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(counters), counters);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	_stats.filledPixels = (int)counters[0];
+	_stats.holePixels = (int)counters[1];
+}
+
+void ForwardReprojector::Dispatch(const char* stage, int width, int height) {
+	_shader->EnableDefine(stage);
+	_shader->ActivateVariant();
+
+	glUniform1i(_shader->GetUniformLocation(LeftDepthTextureUniform), 0);
+	glUniform1i(_shader->GetUniformLocation(LeftColorTextureUniform), 1);
+	glUniform1i(_shader->GetUniformLocation(FillRadiusUniform), _fillRadius);
+
+	glDispatchCompute((GLuint)((width + GroupSize - 1) / GroupSize), (GLuint)((height + GroupSize - 1) / GroupSize), 1);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+	_shader->DisableDefine(stage);
+}
+
+bool ForwardReprojector::Reproject(GLuint leftColorTexture, GLuint leftDepthTexture, GLuint rightColorTexture, int width, int height) {
+	if (width <= 0 || height <= 0 || !CreateResources(width, height))
+		return false;
+
+	ReadCounters();
+
+	GLuint previousProgram = GLStateCache::Get().GetProgram();
+
+	_shader->ReloadIfChanged();
+
+	glClearTexImage(_scatterDepth, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, &EmptyDepth);
+	GLuint zero[2] = { 0, 0 };
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _counterBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(zero), zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CounterBufferBinding, _counterBuffer);
+
+	GLStateCache::Get().BindTexture(0, GL_TEXTURE_2D, leftDepthTexture);
+	GLStateCache::Get().BindTexture(1, GL_TEXTURE_2D, leftColorTexture);
+	GLStateCache::Get().ActiveTexture(0);
+
+	glBindImageTexture(ScatterDepthImageUnit, _scatterDepth, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+	glBindImageTexture(ScatterColorImageUnit, _scatterColor, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA8);
+	glBindImageTexture(RightColorImageUnit, rightColorTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+	glBindImageTexture(ResolvedDepthImageUnit, _resolvedDepth, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+	// Depth first so the color pass can tell which left pixel won each right pixel
+	Dispatch("SCATTER_DEPTH", width, height);
+	Dispatch("RESOLVE_COLOR", width, height);
+	Dispatch("FILL_HOLES", width, height);
+
+	// The right color target is rendered into and the resolved depth sampled next, the counters read back later
+	glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+	_countersFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	GLStateCache::Get().UseProgram(previousProgram);
+	return true;
+}
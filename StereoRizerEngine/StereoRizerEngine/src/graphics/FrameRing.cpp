@@ -0,0 +1,72 @@
+#include "graphics/FrameRing.h"
+#include "core/Common.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace stereorizer::graphics;
+
+namespace {
+	constexpr GLuint64 WaitSliceNs = 1000000; // 1 ms
+	// A frame that isn't done after a second won't finish, the context is gone
+	constexpr int MaxWaitSlices = 1000;
+}
+
+FrameRing::~FrameRing() {
+	for (auto& fence : _fences) {
+		if (fence) {
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+	}
+}
+
+void FrameRing::SetFramesInFlight(int count) {
+	count = std::clamp(count, 1, MaxFramesInFlight);
+	if (count == _framesInFlight)
+		return;
+
+	// Slots past the new count are never visited again, retire their frames now
+	for (int slot = count; slot < MaxFramesInFlight; slot++)
+		WaitForSlot(slot);
+
+	_framesInFlight = count;
+	_slot = std::min(_slot, _framesInFlight - 1);
+	LOG_INFO("Frames in flight: " + std::to_string(_framesInFlight));
+}
+
+void FrameRing::WaitForSlot(int slot) {
+	GLsync fence = _fences[slot];
+	if (!fence) return;
+
+	// Bounded waits so a lost context can't hang the loop forever
+	GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+	for (int slice = 0; result == GL_TIMEOUT_EXPIRED && slice < MaxWaitSlices; slice++) {
+		result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WaitSliceNs);
+	}
+	if (result == GL_TIMEOUT_EXPIRED) {
+		LOG_ERROR("Frame fence did not signal within a second, the GL context may be lost");
+	}
+	else if (result == GL_WAIT_FAILED) {
+		LOG_ERROR("Waiting for a frame fence failed");
+	}
+
+	glDeleteSync(fence);
+	_fences[slot] = nullptr;
+}
+
+int FrameRing::BeginFrame() {
+	_slot = (_slot + 1) % _framesInFlight;
+
+	auto start = std::chrono::steady_clock::now();
+	WaitForSlot(_slot);
+	_lastWaitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	return _slot;
+}
+
+void FrameRing::EndFrame() {
+	if (_fences[_slot])
+		glDeleteSync(_fences[_slot]);
+	_fences[_slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,54 @@
+#include "graphics/FrameUniformBuffer.h"
+#include "core/Common.h"
+
+#include <cstring>
+
+using namespace stereorizer::graphics;
+
+FrameUniformBuffer::FrameUniformBuffer() {
+	// Buffer is created on the first Update(), the context might not be ready yet
+}
+
+FrameUniformBuffer::~FrameUniformBuffer() {
+	if (_buffer != 0) {
+		glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+		glUnmapBuffer(GL_UNIFORM_BUFFER);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glDeleteBuffers(1, &_buffer);
+	}
+}
+
+void FrameUniformBuffer::Create() {
+	// Every slot has to start on a valid glBindBufferRange offset
+	GLint alignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	_slotStride = ((GLsizeiptr)sizeof(FrameData) + alignment - 1) / alignment * alignment;
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &_buffer);
+	glBindBuffer(GL_UNIFORM_BUFFER, _buffer);
+	glBufferStorage(GL_UNIFORM_BUFFER, _slotStride * RingSize, nullptr, flags);
+	_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, _slotStride * RingSize, flags));
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	if (!_mapped) {
+		LOG_ERROR("Failed to persistently map the frame uniform buffer");
+		glDeleteBuffers(1, &_buffer);
+		_buffer = 0;
+		return;
+	}
+
+	LOG_INFO("Frame uniform buffer created: " + std::to_string(RingSize) + " x " + std::to_string(_slotStride) + " bytes");
+}
+
+void FrameUniformBuffer::Update(const FrameData& data, int slot) {
+	if (_buffer == 0) {
+		Create();
+		if (_buffer == 0) return;
+	}
+	if (slot < 0 || slot >= RingSize) return;
+
+	GLintptr offset = _slotStride * slot;
+	std::memcpy(_mapped + offset, &data, sizeof(FrameData));
+	glBindBufferRange(GL_UNIFORM_BUFFER, BindingPoint, _buffer, offset, sizeof(FrameData));
+}
@@ -0,0 +1,255 @@
+#include "graphics/GLStateCache.h"
+
+#include <cstring>
+
+using namespace stereorizer::graphics;
+
+namespace
+{
+	constexpr GLenum TrackedCapabilities[] = { GL_DEPTH_TEST, GL_STENCIL_TEST, GL_BLEND, GL_SCISSOR_TEST, GL_CULL_FACE, GL_CLIP_DISTANCE0 };
+	constexpr int TrackedCapabilityCount = sizeof(TrackedCapabilities) / sizeof(TrackedCapabilities[0]);
+}
+
+GLStateCache& GLStateCache::Get() {
+	static GLStateCache cache;
+	return cache;
+}
+
+int GLStateCache::EnableBit(GLenum capability) {
+	for (int i = 0; i < TrackedCapabilityCount; i++) {
+		if (TrackedCapabilities[i] == capability)
+			return i;
+	}
+	return -1;
+}
+
+GLuint* GLStateCache::TextureSlot(GLuint unit, GLenum target) {
+	if (unit >= (GLuint)GLStateSnapshot::TextureUnits)
+		return nullptr;
+	if (target == GL_TEXTURE_2D)
+		return &_state.textures2D[unit];
+	if (target == GL_TEXTURE_2D_ARRAY)
+		return &_state.textures2DArray[unit];
+	return nullptr;
+}
+
+void GLStateCache::Invalidate() {
+	GLint value;
+	glGetIntegerv(GL_CURRENT_PROGRAM, &value);
+	_state.program = (GLuint)value;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &value);
+	_state.vertexArray = (GLuint)value;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &value);
+	_state.readFramebuffer = (GLuint)value;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &value);
+	_state.drawFramebuffer = (GLuint)value;
+
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &value);
+	GLenum activeTexture = (GLenum)value;
+	for (int unit = 0; unit < GLStateSnapshot::TextureUnits; unit++) {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &value);
+		_state.textures2D[unit] = (GLuint)value;
+		glGetIntegerv(GL_TEXTURE_BINDING_2D_ARRAY, &value);
+		_state.textures2DArray[unit] = (GLuint)value;
+	}
+	glActiveTexture(activeTexture);
+	_state.activeUnit = activeTexture - GL_TEXTURE0;
+
+	_state.enables = 0;
+	for (int i = 0; i < TrackedCapabilityCount; i++) {
+		if (glIsEnabled(TrackedCapabilities[i]))
+			_state.enables |= 1u << i;
+	}
+	glGetIntegerv(GL_VIEWPORT, _state.viewport);
+	glGetIntegerv(GL_SCISSOR_BOX, _state.scissor);
+}
+
+void GLStateCache::BeginFrame() {
+	_lastFrame = _frame;
+	_frame = {};
+}
+
+void GLStateCache::UseProgram(GLuint program) {
+	if (_state.program == program) {
+		_frame.skipped++;
+		return;
+	}
+	glUseProgram(program);
+	_state.program = program;
+	_frame.issued++;
+}
+
+void GLStateCache::BindVertexArray(GLuint vertexArray) {
+	if (_state.vertexArray == vertexArray) {
+		_frame.skipped++;
+		return;
+	}
+	glBindVertexArray(vertexArray);
+	_state.vertexArray = vertexArray;
+	_frame.issued++;
+}
+
+void GLStateCache::BindFramebuffer(GLenum target, GLuint framebuffer) {
+	bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+	bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+	bool readChanged = read && _state.readFramebuffer != framebuffer;
+	bool drawChanged = draw && _state.drawFramebuffer != framebuffer;
+	if (!readChanged && !drawChanged) {
+		_frame.skipped++;
+		return;
+	}
+
+	// Narrow GL_FRAMEBUFFER down to the half that actually changes
+	if (readChanged && drawChanged)
+		glBindFramebuffer(target, framebuffer);
+	else
+		glBindFramebuffer(readChanged ? GL_READ_FRAMEBUFFER : GL_DRAW_FRAMEBUFFER, framebuffer);
+	if (read)
+		_state.readFramebuffer = framebuffer;
+	if (draw)
+		_state.drawFramebuffer = framebuffer;
+	_frame.issued++;
+}
+
+void GLStateCache::ActiveTexture(GLuint unit) {
+	if (_state.activeUnit == unit) {
+		_frame.skipped++;
+		return;
+	}
+	glActiveTexture(GL_TEXTURE0 + unit);
+	_state.activeUnit = unit;
+	_frame.issued++;
+}
+
+void GLStateCache::BindTexture(GLuint unit, GLenum target, GLuint texture) {
+	GLuint* slot = TextureSlot(unit, target);
+	if (slot && *slot == texture) {
+		_frame.skipped++;
+		return;
+	}
+	ActiveTexture(unit);
+	glBindTexture(target, texture);
+	if (slot)
+		*slot = texture;
+	_frame.issued++;
+}
+
+void GLStateCache::BindTexture(GLenum target, GLuint texture) {
+	BindTexture(_state.activeUnit, target, texture);
+}
+
+bool GLStateCache::IsEnabled(GLenum capability) const {
+	int bit = EnableBit(capability);
+	if (bit < 0)
+		return glIsEnabled(capability) == GL_TRUE;
+	return (_state.enables & (1u << bit)) != 0;
+}
+
+void GLStateCache::SetEnabled(GLenum capability, bool enabled) {
+	int bit = EnableBit(capability);
+	if (bit >= 0 && ((_state.enables >> bit) & 1u) == (enabled ? 1u : 0u)) {
+		_frame.skipped++;
+		return;
+	}
+	if (enabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+	if (bit >= 0)
+		_state.enables = enabled ? _state.enables | (1u << bit) : _state.enables & ~(1u << bit);
+	_frame.issued++;
+}
+
+void GLStateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+	GLint viewport[4] = { x, y, width, height };
+	if (std::memcmp(_state.viewport, viewport, sizeof(viewport)) == 0) {
+		_frame.skipped++;
+		return;
+	}
+	glViewport(x, y, width, height);
+	std::memcpy(_state.viewport, viewport, sizeof(viewport));
+	_frame.issued++;
+}
+
+void GLStateCache::Scissor(GLint x, GLint y, GLsizei width, GLsizei height) {
+	GLint scissor[4] = { x, y, width, height };
+	if (std::memcmp(_state.scissor, scissor, sizeof(scissor)) == 0) {
+		_frame.skipped++;
+		return;
+	}
+	glScissor(x, y, width, height);
+	std::memcpy(_state.scissor, scissor, sizeof(scissor));
+	_frame.issued++;
+}
+
+void GLStateCache::Restore(const GLStateSnapshot& snapshot) {
+	// Fields that already match are neither issued nor counted, only the caller's calls are
+	if (snapshot.program != _state.program)
+		UseProgram(snapshot.program);
+	if (snapshot.vertexArray != _state.vertexArray)
+		BindVertexArray(snapshot.vertexArray);
+	if (snapshot.readFramebuffer == snapshot.drawFramebuffer) {
+		if (snapshot.drawFramebuffer != _state.drawFramebuffer || snapshot.readFramebuffer != _state.readFramebuffer)
+			BindFramebuffer(GL_FRAMEBUFFER, snapshot.drawFramebuffer);
+	}
+	else {
+		if (snapshot.readFramebuffer != _state.readFramebuffer)
+			BindFramebuffer(GL_READ_FRAMEBUFFER, snapshot.readFramebuffer);
+		if (snapshot.drawFramebuffer != _state.drawFramebuffer)
+			BindFramebuffer(GL_DRAW_FRAMEBUFFER, snapshot.drawFramebuffer);
+	}
+	for (int unit = 0; unit < GLStateSnapshot::TextureUnits; unit++) {
+		if (snapshot.textures2D[unit] != _state.textures2D[unit])
+			BindTexture(unit, GL_TEXTURE_2D, snapshot.textures2D[unit]);
+		if (snapshot.textures2DArray[unit] != _state.textures2DArray[unit])
+			BindTexture(unit, GL_TEXTURE_2D_ARRAY, snapshot.textures2DArray[unit]);
+	}
+	if (snapshot.activeUnit != _state.activeUnit)
+		ActiveTexture(snapshot.activeUnit);
+	for (int i = 0; i < TrackedCapabilityCount; i++) {
+		if (((snapshot.enables ^ _state.enables) >> i) & 1u)
+			SetEnabled(TrackedCapabilities[i], (snapshot.enables >> i) & 1u);
+	}
+	const GLint* viewport = snapshot.viewport;
+	if (std::memcmp(viewport, _state.viewport, sizeof(_state.viewport)) != 0)
+		Viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+	const GLint* scissor = snapshot.scissor;
+	if (std::memcmp(scissor, _state.scissor, sizeof(_state.scissor)) != 0)
+		Scissor(scissor[0], scissor[1], scissor[2], scissor[3]);
+}
+
+void GLStateCache::DeleteTextures(GLsizei count, const GLuint* textures) {
+	// GL unbinds a deleted texture from every unit, so does the shadow
+	for (GLsizei i = 0; i < count; i++) {
+		if (textures[i] == 0)
+			continue;
+		for (int unit = 0; unit < GLStateSnapshot::TextureUnits; unit++) {
+			if (_state.textures2D[unit] == textures[i])
+				_state.textures2D[unit] = 0;
+			if (_state.textures2DArray[unit] == textures[i])
+				_state.textures2DArray[unit] = 0;
+		}
+	}
+	glDeleteTextures(count, textures);
+}
+
+void GLStateCache::DeleteFramebuffers(GLsizei count, const GLuint* framebuffers) {
+	for (GLsizei i = 0; i < count; i++) {
+		if (framebuffers[i] == 0)
+			continue;
+		if (_state.readFramebuffer == framebuffers[i])
+			_state.readFramebuffer = 0;
+		if (_state.drawFramebuffer == framebuffers[i])
+			_state.drawFramebuffer = 0;
+	}
+	glDeleteFramebuffers(count, framebuffers);
+}
+
+void GLStateCache::DeleteVertexArrays(GLsizei count, const GLuint* vertexArrays) {
+	for (GLsizei i = 0; i < count; i++) {
+		if (vertexArrays[i] != 0 && _state.vertexArray == vertexArrays[i])
+			_state.vertexArray = 0;
+	}
+	glDeleteVertexArrays(count, vertexArrays);
+}
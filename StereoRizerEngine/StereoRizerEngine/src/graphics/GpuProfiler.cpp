@@ -0,0 +1,187 @@
+#include "graphics/GpuProfiler.h"
+#include "core/Common.h"
+
+#include <algorithm>
+#include <fstream>
+
+using namespace stereorizer::graphics;
+
+namespace
+{
+	double Percentile(std::vector<double>& sorted, double fraction) {
+		if (sorted.empty()) return 0.0;
+		size_t index = std::min(sorted.size() - 1, (size_t)(fraction * (double)(sorted.size() - 1) + 0.5));
+		return sorted[index];
+	}
+}
+
+GpuProfiler::GpuProfiler() {
+	// Queries are created on the first BeginFrame(), the context might not be ready yet
+}
+
+GpuProfiler::~GpuProfiler() {
+	if (!_created) return;
+	for (auto& frame : _frames)
+		glDeleteQueries(2 * MaxScopesPerFrame, frame.queries);
+}
+
+void GpuProfiler::CreateQueries() {
+	for (auto& frame : _frames) {
+		glGenQueries(2 * MaxScopesPerFrame, frame.queries);
+		frame.scopes.reserve(MaxScopesPerFrame);
+	}
+	_created = true;
+}
+
+void GpuProfiler::AddSample(const PendingScope& scope, double ms) {
+	auto it = std::find_if(_history.begin(), _history.end(), [&](const ScopeHistory& history) { return history.name == scope.name; });
+	if (it == _history.end()) {
+		ScopeHistory history;
+		history.name = scope.name;
+		history.depth = scope.depth;
+		history.samples.reserve(HistorySize);
+		_history.push_back(std::move(history));
+		it = _history.end() - 1;
+	}
+
+	if (it->samples.size() < HistorySize)
+		it->samples.push_back(ms);
+	else
+		it->samples[it->next] = ms;
+	it->next = (it->next + 1) % HistorySize;
+	it->lastMs = ms;
+}
+
+void GpuProfiler::Collect(FrameQueries& frame) {
+	if (frame.scopes.empty())
+		return;
+
+	// Never wait: a frame whose queries aren't all back yet is dropped
+	for (const auto& scope : frame.scopes) {
+		GLint available = 0;
+		glGetQueryObjectiv(frame.queries[scope.endQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available) {
+			frame.scopes.clear();
+			return;
+		}
+	}
+
+	for (const auto& scope : frame.scopes) {
+		GLuint64 begin = 0, end = 0;
+		glGetQueryObjectui64v(frame.queries[scope.beginQuery], GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(frame.queries[scope.endQuery], GL_QUERY_RESULT, &end);
+		double ms = end > begin ? (double)(end - begin) / 1.0e6 : 0.0;
+		AddSample(scope, ms);
+		if (scope.depth == 0) {
+			_hasFrameTime = true;
+			_lastFrameNumber = frame.frameNumber;
+			_lastFrameMs = ms;
+		}
+	}
+	frame.scopes.clear();
+}
+
+bool GpuProfiler::GetLastFrameTime(uint64_t& frameNumber, double& ms) const {
+	if (!_hasFrameTime) return false;
+	frameNumber = _lastFrameNumber;
+	ms = _lastFrameMs;
+	return true;
+}
+
+void GpuProfiler::BeginFrame(uint64_t frameNumber) {
+	if (!_enabled) return;
+	if (!_created)
+		CreateQueries();
+
+	_frameIndex = (_frameIndex + 1) % FrameLatency;
+	FrameQueries& frame = _frames[_frameIndex];
+	Collect(frame);
+	frame.scopes.clear();
+	frame.usedQueries = 0;
+	frame.frameNumber = frameNumber;
+	_openScopes.clear();
+	_inFrame = true;
+
+	BeginScope("Frame");
+}
+
+void GpuProfiler::EndFrame() {
+	if (!_inFrame) return;
+
+	// Close anything left open so the frame's ranges stay consistent
+	while (!_openScopes.empty())
+		EndScope();
+	_inFrame = false;
+}
+
+void GpuProfiler::BeginScope(const char* name) {
+	if (!_inFrame) return;
+
+	FrameQueries& frame = _frames[_frameIndex];
+	if (frame.usedQueries + 2 > 2 * MaxScopesPerFrame) {
+		_openScopes.push_back(-1);
+		return;
+	}
+
+	PendingScope scope{ name, (int)_openScopes.size(), frame.usedQueries, frame.usedQueries + 1 };
+	frame.usedQueries += 2;
+	glQueryCounter(frame.queries[scope.beginQuery], GL_TIMESTAMP);
+	_openScopes.push_back((int)frame.scopes.size());
+	frame.scopes.push_back(scope);
+}
+
+void GpuProfiler::EndScope() {
+	if (!_inFrame || _openScopes.empty()) return;
+
+	int index = _openScopes.back();
+	_openScopes.pop_back();
+	if (index < 0) return;
+
+	FrameQueries& frame = _frames[_frameIndex];
+	glQueryCounter(frame.queries[frame.scopes[index].endQuery], GL_TIMESTAMP);
+}
+
+std::vector<GpuScopeStats> GpuProfiler::GetStats() const {
+	std::vector<GpuScopeStats> stats;
+	stats.reserve(_history.size());
+
+	std::vector<double> sorted;
+	for (const auto& history : _history) {
+		GpuScopeStats scope;
+		scope.name = history.name;
+		scope.depth = history.depth;
+		scope.samples = (int)history.samples.size();
+		scope.lastMs = history.lastMs;
+
+		sorted = history.samples;
+		std::sort(sorted.begin(), sorted.end());
+		double sum = 0.0;
+		for (double sample : sorted)
+			sum += sample;
+		scope.averageMs = sorted.empty() ? 0.0 : sum / (double)sorted.size();
+		scope.p50Ms = Percentile(sorted, 0.50);
+		scope.p95Ms = Percentile(sorted, 0.95);
+		scope.p99Ms = Percentile(sorted, 0.99);
+		scope.maxMs = sorted.empty() ? 0.0 : sorted.back();
+		stats.push_back(scope);
+	}
+	return stats;
+}
+
+bool GpuProfiler::ExportCsv(const std::string& path) const {
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		LOG_ERROR("Failed to open GPU timing export: " + path);
+		return false;
+	}
+
+	file << "scope,depth,samples,last_ms,average_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+	for (const auto& scope : GetStats()) {
+		file << scope.name << ',' << scope.depth << ',' << scope.samples << ','
+			<< scope.lastMs << ',' << scope.averageMs << ',' << scope.p50Ms << ','
+			<< scope.p95Ms << ',' << scope.p99Ms << ',' << scope.maxMs << '\n';
+	}
+
+	LOG_INFO("GPU timings exported to " + path);
+	return true;
+}
@@ -1,4 +1,5 @@
 #include "graphics/Light.h"
+#include "graphics/Shader.h"
 #include <GL/glew.h>
 #include <glm/gtc/type_ptr.hpp>
 #include <cmath>
@@ -42,50 +43,62 @@ void Light::SetSpotAngles(float innerConeAngle, float outerConeAngle) {
     _outerConeAngle = outerConeAngle;
 }
 
-void Light::UploadToShader(unsigned int shaderID, const std::string& uniformPrefix) const {
+void Light::WriteToBlock(LightBlock& block) const {
+    block = {};
+    block.type = static_cast<int32_t>(_type);
+    block.position = _position;
+    block.direction = _direction;
+    block.color = _color;
+    block.intensity = _intensity;
+    block.attenuation = _attenuation;
+    block.innerConeAngle = _innerConeAngle;
+    block.outerConeAngle = _outerConeAngle;
+}
+
+void Light::UploadToShader(const Shader& shader, const LightUniforms& uniforms) const {
     // Type (0 = Directional, 1 = Point, 2 = Spot)
-    GLint typeLocation = glGetUniformLocation(shaderID, (uniformPrefix + ".type").c_str());
+    GLint typeLocation = shader.GetUniformLocation(uniforms.type);
     if (typeLocation != -1) {
         glUniform1i(typeLocation, static_cast<int>(_type));
     }
     
     // Position
-    GLint positionLocation = glGetUniformLocation(shaderID, (uniformPrefix + ".position").c_str());
+    GLint positionLocation = shader.GetUniformLocation(uniforms.position);
     if (positionLocation != -1) {
         glUniform3fv(positionLocation, 1, glm::value_ptr(_position));
     }
     
     // Direction
-    GLint directionLocation = glGetUniformLocation(shaderID, (uniformPrefix + ".direction").c_str());
+    GLint directionLocation = shader.GetUniformLocation(uniforms.direction);
     if (directionLocation != -1) {
         glUniform3fv(directionLocation, 1, glm::value_ptr(_direction));
     }
     
     // Color
-    GLint colorLocation = glGetUniformLocation(shaderID, (uniformPrefix + ".color").c_str());
+    GLint colorLocation = shader.GetUniformLocation(uniforms.color);
     if (colorLocation != -1) {
         glUniform3fv(colorLocation, 1, glm::value_ptr(_color));
     }
     
     // Intensity
-    GLint intensityLocation = glGetUniformLocation(shaderID, (uniformPrefix + ".intensity").c_str());
+    GLint intensityLocation = shader.GetUniformLocation(uniforms.intensity);
     if (intensityLocation != -1) {
         glUniform1f(intensityLocation, _intensity);
     }
     
     // Attenuation (for point and spot lights)
-    GLint attenuationLocation = glGetUniformLocation(shaderID, (uniformPrefix + ".attenuation").c_str());
+    GLint attenuationLocation = shader.GetUniformLocation(uniforms.attenuation);
     if (attenuationLocation != -1) {
         glUniform3fv(attenuationLocation, 1, glm::value_ptr(_attenuation));
     }
     
     // Spot light angles
-    GLint innerAngleLocation = glGetUniformLocation(shaderID, (uniformPrefix + ".innerConeAngle").c_str());
+    GLint innerAngleLocation = shader.GetUniformLocation(uniforms.innerConeAngle);
     if (innerAngleLocation != -1) {
         glUniform1f(innerAngleLocation, _innerConeAngle);
     }
     
-    GLint outerAngleLocation = glGetUniformLocation(shaderID, (uniformPrefix + ".outerConeAngle").c_str());
+    GLint outerAngleLocation = shader.GetUniformLocation(uniforms.outerConeAngle);
     if (outerAngleLocation != -1) {
         glUniform1f(outerAngleLocation, _outerConeAngle);
     }
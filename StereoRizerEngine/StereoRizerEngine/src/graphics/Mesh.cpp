@@ -1,64 +1,130 @@
 #include "graphics/Mesh.h"
 #include "core/Common.h"
+#include "core/CpuProfiler.h"
+#include "graphics/StagingBuffer.h"
+
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
 
 using namespace stereorizer::graphics;
 
-Mesh::Mesh(const std::string& path)
+namespace
+{
+	// Vertex is uploaded as is: position, normal
+	static_assert(sizeof(Vertex) == 6 * sizeof(float), "Vertex must stay two tightly packed vec3");
+	const VertexLayout& GetVertexLayout() {
+		static const VertexLayout layout = VertexLayout::fromFloatSizes({ 3, 3 });
+		return layout;
+	}
+
+	// VertexFormat::Compressed. The position keeps three components so shaders reading a vec4
+	// still get w = 1; the fourth short only pads the normal to its alignment.
+	struct CompressedVertex {
+		uint16_t position[4];
+		uint32_t normal;
+	};
+	static_assert(sizeof(CompressedVertex) == 12, "CompressedVertex must stay tightly packed");
+	const VertexLayout& GetCompressedVertexLayout() {
+		static const VertexLayout layout = [] {
+			VertexLayout layout;
+			layout.attributes.push_back({ 3, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(CompressedVertex, position) });
+			layout.attributes.push_back({ 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(CompressedVertex, normal) });
+			layout.stride = sizeof(CompressedVertex);
+			return layout;
+		}();
+		return layout;
+	}
+
+	// Fraction of the way from min to max as a 16-bit unorm, 0 on a flat axis
+	uint16_t QuantizeUnorm16(float value, float min, float extent) {
+		if (extent <= 0.0f)
+			return 0;
+		return (uint16_t)std::lround(glm::clamp((value - min) / extent, 0.0f, 1.0f) * 65535.0f);
+	}
+
+	// xyz as 10-bit snorm, w left 0
+	uint32_t PackNormal(const glm::vec3& normal) {
+		auto component = [](float value) {
+			return (uint32_t)std::lround(glm::clamp(value, -1.0f, 1.0f) * 511.0f) & 0x3FFu;
+		};
+		return component(normal.x) | component(normal.y) << 10 | component(normal.z) << 20;
+	}
+}
+
+Mesh::Mesh(const std::string& path, const MeshImportOptions& options)
 {
 	_path = path;
-	ProcessMesh();
-	this->vertices = vertices;
-	this->indices = indices;
-	SetupMesh();
+	MeshData data;
+	if (!Load(path, options, data))
+		return;
+	Upload(data);
+	vertices = std::move(data.vertices);
+	indices = std::move(data.indices);
 }
 
-Mesh::~Mesh()
+Mesh::Mesh(const MeshData& data)
 {
-	/*if (VAO != 0) {
-		glDeleteVertexArrays(1, &VAO);
-		VAO = 0;
-	}
-	if (VBO != 0) {
-		glDeleteBuffers(1, &VBO);
-		VBO = 0;
-	}
-	if (EBO != 0) {
-		glDeleteBuffers(1, &EBO);
-		EBO = 0;
-	}*/
+	Upload(data);
 }
 
+Mesh::Mesh(std::shared_ptr<const Mesh> placeholder)
+	: _placeholder(std::move(placeholder))
+{
+}
+
+// GL objects go with their unique_ptrs, the context must still be current
+Mesh::~Mesh() = default;
+
 Mesh::Mesh(Mesh&& other) noexcept
 {
-	// Steal resources
-	vertices = std::move(other.vertices);
-	indices = std::move(other.indices);
-	/*VAO = other.VAO; other.VAO = 0;
-	VBO = other.VBO; other.VBO = 0;
-	EBO = other.EBO; other.EBO = 0;*/
-	_path = std::move(other._path);
+	*this = std::move(other);
 }
 
 Mesh& Mesh::operator=(Mesh&& other) noexcept
 {
 	if (this != &other) {
-		// free existing resources
-		/*if (VAO != 0) glDeleteVertexArrays(1, &VAO);
-		if (VBO != 0) glDeleteBuffers(1, &VBO);
-		if (EBO != 0) glDeleteBuffers(1, &EBO);*/
-
 		vertices = std::move(other.vertices);
 		indices = std::move(other.indices);
-		/*VAO = other.VAO; other.VAO = 0;
-		VBO = other.VBO; other.VBO = 0;
-		EBO = other.EBO; other.EBO = 0;*/
+		vtxBuffer = std::move(other.vtxBuffer);
+		vtxArray = std::move(other.vtxArray);
+		elementBuffer = std::move(other.elementBuffer);
 		_path = std::move(other._path);
+		_boundsMin = other._boundsMin;
+		_boundsMax = other._boundsMax;
+		_indexCount = other._indexCount;
+		_dequantization = other._dequantization;
+		_gpuBytes = other._gpuBytes;
+		_placeholder = std::move(other._placeholder);
+		other._indexCount = 0;
+		other._gpuBytes = 0;
 	}
 	return *this;
 }
 
-void Mesh::Draw() const
+size_t Mesh::GetCpuBytes() const
 {
+	return vertices.capacity() * sizeof(Vertex) + indices.capacity() * sizeof(unsigned int);
+}
+
+void Mesh::Draw(int instanceCount) const
+{
+	if (_placeholder) {
+		_placeholder->Draw(instanceCount);
+		return;
+	}
+	// Failed import, nothing was uploaded
+	if (vtxArray == nullptr)
+		return;
+	if (instanceCount > 1)
+	{
+		if (elementBuffer != nullptr)
+			vtxArray->drawElementsInstanced(*elementBuffer, DrawType::TRIANGLES, instanceCount);
+		else
+			vtxArray->drawArrayInstanced(*vtxBuffer, DrawType::TRIANGLES, instanceCount);
+		return;
+	}
+
 	if (elementBuffer != nullptr)
 	{
 		vtxArray->drawElements(*elementBuffer, DrawType::TRIANGLES);
@@ -67,68 +133,216 @@ void Mesh::Draw() const
 	vtxArray->drawArray(*vtxBuffer, DrawType::TRIANGLES);
 }
 
-void Mesh::SetupMesh()
+void Mesh::DrawIndirect(GLintptr commandOffset) const
 {
-	vtxArray = new VertexArray();
-	std::vector<uint32_t> attributesSizes = { 3,3 };
-	std::vector<float> verticesFloat;
-	verticesFloat.reserve(vertices.size() * 6);
-	for (auto& vertex : vertices)
-		verticesFloat.insert(verticesFloat.end(), (float*)&vertex, (float*)(&vertex + 1));
-	vtxBuffer = new VertexBuffer(*vtxArray, verticesFloat, attributesSizes, BufferAccessType::STATIC, BufferCallType::DRAW);
-	elementBuffer = new ElementBuffer(indices, BufferAccessType::STATIC, BufferCallType::DRAW);
+	if (_placeholder) {
+		_placeholder->DrawIndirect(commandOffset);
+		return;
+	}
+	if (elementBuffer == nullptr)
+		return;
+	vtxArray->drawElementsIndirect(*elementBuffer, DrawType::TRIANGLES, commandOffset);
 }
 
-void Mesh::ProcessMesh()
+void Mesh::SetupMesh(const MeshData& data, bool fill)
 {
+	// Resetting first frees the buffers of a previous upload before the new ones exist
+	elementBuffer.reset();
+	vtxBuffer.reset();
+	vtxArray.reset();
+	vtxArray = std::make_unique<VertexArray>();
+	vtxBuffer = std::make_unique<VertexBuffer>(*vtxArray, fill ? data.vertexData : nullptr, data.vertexSize, data.layout);
+	elementBuffer = std::make_unique<ElementBuffer>(fill ? data.indexData : nullptr, data.indexCount, data.GetIndexType());
+	_indexCount = (GLuint)data.indexCount;
+	_dequantization = glm::scale(glm::translate(glm::mat4(1.0f), data.positionOffset), data.positionScale);
+	_gpuBytes = data.vertexSize + data.GetIndexBytes();
+	_boundsMin = data.boundsMin;
+	_boundsMax = data.boundsMax;
+	_placeholder.reset();
+}
+
+void Mesh::Upload(const MeshData& data)
+{
+	PROFILE_SCOPE("Mesh::Upload");
+	SetupMesh(data, true);
+}
+
+bool Mesh::Upload(const MeshData& data, StagingBuffer& staging)
+{
+	size_t indexSize = data.GetIndexBytes();
+	if (data.vertexSize + indexSize + 2 * StagingBuffer::Alignment > staging.GetSize()) {
+		Upload(data);
+		return true;
+	}
+	if (!staging.CanStage(data.vertexSize + indexSize + 2 * StagingBuffer::Alignment))
+		return false;
+
+	PROFILE_SCOPE("Mesh::Upload staged");
+	SetupMesh(data, false);
+	return staging.Stage({
+		{ vtxBuffer->getId(), 0, data.vertexData, data.vertexSize },
+		{ elementBuffer->getId(), 0, data.indexData, indexSize } });
+}
+
+bool Mesh::Load(const std::string& path, const MeshImportOptions& options, MeshData& data)
+{
+	PROFILE_SCOPE("Mesh::Load");
+	uint64_t cacheKey = options.GetCacheKey();
+	if (MeshCache::Load(path, cacheKey, data.cacheEntry)) {
+		const MeshCacheEntry& entry = data.cacheEntry;
+		data.layout = entry.layout;
+		data.vertexData = entry.vertexData;
+		data.vertexSize = entry.vertexSize;
+		data.indexData = entry.indexData;
+		data.indexCount = entry.indexCount;
+		data.indexSize = entry.indexSize;
+		data.boundsMin = entry.boundsMin;
+		data.boundsMax = entry.boundsMax;
+		data.positionScale = entry.positionScale;
+		data.positionOffset = entry.positionOffset;
+		LOG_INFO("Loaded model from mesh cache: " + path);
+		return true;
+	}
+
+	if (!ProcessMesh(path, options.GetImportFlags(), data))
+		return false;
+	PackVertices(options.vertexFormat, data);
+	MeshCache::Store(path, cacheKey, data.layout, data.vertexData, data.vertexSize,
+		data.indexData, data.indexCount, data.indexSize, data.boundsMin, data.boundsMax, data.positionScale, data.positionOffset);
+	return true;
+}
+
+void Mesh::PackVertices(VertexFormat format, MeshData& data)
+{
+	PROFILE_SCOPE("Mesh::PackVertices");
+	if (format == VertexFormat::Compressed) {
+		// Quantized within the mesh bounds, the dequantization maps [0, 1] back onto them
+		glm::vec3 extent = data.boundsMax - data.boundsMin;
+		data.packedVertices.resize(data.vertices.size() * sizeof(CompressedVertex));
+		CompressedVertex* packed = (CompressedVertex*)data.packedVertices.data();
+		for (size_t i = 0; i < data.vertices.size(); i++) {
+			const Vertex& vertex = data.vertices[i];
+			for (int axis = 0; axis < 3; axis++)
+				packed[i].position[axis] = QuantizeUnorm16(vertex.position[axis], data.boundsMin[axis], extent[axis]);
+			packed[i].position[3] = 0;
+			packed[i].normal = PackNormal(vertex.normal);
+		}
+		data.layout = GetCompressedVertexLayout();
+		data.vertexData = data.packedVertices.data();
+		data.vertexSize = data.packedVertices.size();
+		data.positionScale = extent;
+		data.positionOffset = data.boundsMin;
+	}
+	else {
+		data.layout = GetVertexLayout();
+		data.vertexData = data.vertices.data();
+		data.vertexSize = data.vertices.size() * sizeof(Vertex);
+		data.positionScale = glm::vec3(1.0f);
+		data.positionOffset = glm::vec3(0.0f);
+	}
+
+	// Half the index bytes whenever every vertex can be addressed with 16 bits
+	data.indexCount = data.indices.size();
+	if (ElementBuffer::indexTypeFor(data.vertices.size()) == GL_UNSIGNED_SHORT) {
+		data.shortIndices.assign(data.indices.begin(), data.indices.end());
+		data.indexData = data.shortIndices.data();
+		data.indexSize = sizeof(uint16_t);
+	}
+	else {
+		data.indexData = data.indices.data();
+		data.indexSize = sizeof(uint32_t);
+	}
+}
+
+bool Mesh::ProcessMesh(const std::string& path, unsigned int importFlags, MeshData& data)
+{
+	PROFILE_SCOPE("Mesh::ProcessMesh");
 	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(_path, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);
+	const aiScene* scene = importer.ReadFile(path, importFlags);
 
 	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
 	{
 		LOG_ERROR(std::string("ERROR::ASSIMP:: ") + importer.GetErrorString());
-		return;
+		return false;
 	}
 	else {
 		LOG_INFO("Loaded model successfully!");
 		LOG_INFO(std::string("Number of meshes: ") + std::to_string(scene->mNumMeshes));
 	}
 
-	ProcessMeshInternally(scene->mMeshes[0]);
+	data.vertices.clear();
+	data.indices.clear();
+	ProcessNode(scene, scene->mRootNode, glm::mat4(1.0f), data);
+	if (data.vertices.empty()) {
+		// No node references a mesh, take them all as they are
+		for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+			ProcessMeshInternally(scene->mMeshes[i], glm::mat4(1.0f), data);
+	}
+	if (data.vertices.empty())
+		return false;
+
+	// Mesh space, the node transforms are baked into the vertices
+	data.boundsMin = data.vertices.front().position;
+	data.boundsMax = data.vertices.front().position;
+	for (const Vertex& vertex : data.vertices) {
+		data.boundsMin = glm::min(data.boundsMin, vertex.position);
+		data.boundsMax = glm::max(data.boundsMax, vertex.position);
+	}
+	LOG_INFO(std::string("Vertices: ") + std::to_string(data.vertices.size()) + ", indices: " + std::to_string(data.indices.size()));
+	return true;
+}
+
+void Mesh::ProcessNode(const aiScene* scene, const aiNode* node, const glm::mat4& parentTransform, MeshData& data)
+{
+	// aiMatrix4x4 is row-major
+	glm::mat4 transform = parentTransform * glm::transpose(glm::make_mat4(&node->mTransformation.a1));
+	for (unsigned int i = 0; i < node->mNumMeshes; i++) {
+		if (node->mMeshes[i] < scene->mNumMeshes)
+			ProcessMeshInternally(scene->mMeshes[node->mMeshes[i]], transform, data);
+	}
+	for (unsigned int i = 0; i < node->mNumChildren; i++)
+		ProcessNode(scene, node->mChildren[i], transform, data);
 }
 
-void Mesh::ProcessMeshInternally(aiMesh* mesh) 
+void Mesh::ProcessMeshInternally(const aiMesh* mesh, const glm::mat4& transform, MeshData& data)
 {
-	std::vector<Vertex> vertices;
-	std::vector<uint32_t> indices;
-	vertices.reserve(mesh->mNumVertices);
+	if (mesh->mNumVertices == 0)
+		return;
+
+	std::vector<Vertex>& vertices = data.vertices;
+	std::vector<uint32_t>& indices = data.indices;
+	// Indices are offset to the shared vertex buffer, no base vertex needed
+	uint32_t firstVertex = (uint32_t)vertices.size();
+
+	glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+	vertices.reserve(vertices.size() + mesh->mNumVertices);
 	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
 	{
 		Vertex vertex;
-		vertex.position.x = mesh->mVertices[i].x;
-		vertex.position.y = mesh->mVertices[i].y;
-		vertex.position.z = mesh->mVertices[i].z;
+		vertex.position = glm::vec3(transform * glm::vec4(mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z, 1.0f));
+		vertex.normal = glm::vec3(0.0f);
 		if (mesh->HasNormals())
 		{
-			vertex.normal.x = mesh->mNormals[i].x;
-			vertex.normal.y = mesh->mNormals[i].y;
-			vertex.normal.z = mesh->mNormals[i].z;
+			glm::vec3 normal = normalMatrix * glm::vec3(mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z);
+			float length = glm::length(normal);
+			if (length > 0.0f)
+				vertex.normal = normal / length;
 		}
 
 		vertices.push_back(vertex);
 	}
 
-	indices.reserve((size_t)mesh->mNumFaces * 3);
-
+	// A mirroring transform turns the faces inside out, swapping two corners turns them back
+	bool mirrored = glm::determinant(glm::mat3(transform)) < 0.0f;
+	indices.reserve(indices.size() + (size_t)mesh->mNumFaces * 3);
 	for (uint32_t i = 0; i < mesh->mNumFaces; i++)
 	{
-		aiFace& face = mesh->mFaces[i];
-		for (uint32_t j = 0; j < face.mNumIndices; j++)
-		{
-			indices.push_back(face.mIndices[j]);
-		}
+		// Points and lines survive triangulation, the mesh is drawn as triangles
+		const aiFace& face = mesh->mFaces[i];
+		if (face.mNumIndices != 3)
+			continue;
+		indices.push_back(firstVertex + face.mIndices[0]);
+		indices.push_back(firstVertex + face.mIndices[mirrored ? 2 : 1]);
+		indices.push_back(firstVertex + face.mIndices[mirrored ? 1 : 2]);
 	}
-    
-	this->vertices = vertices;
-	this->indices = indices;
 }
@@ -0,0 +1,188 @@
+#include "graphics/MeshCache.h"
+#include "core/Common.h"
+#include "core/CpuProfiler.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+using namespace stereorizer::graphics;
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	bool GetSourceWriteTime(const std::string& sourcePath, int64_t& writeTime) {
+		std::error_code error;
+		fs::file_time_type time = fs::last_write_time(sourcePath, error);
+		if (error)
+			return false;
+		writeTime = (int64_t)time.time_since_epoch().count();
+		return true;
+	}
+
+	// Loads on worker threads may store the same entry at once, each writes its own temporary
+	std::atomic<uint32_t> TempFileCounter{ 0 };
+
+	uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	// FNV-1a, only picks a file name, the entry itself is checked against the full path
+	uint64_t HashKey(const std::string& path, uint64_t importKey) {
+		uint64_t hash = 14695981039346656037ull;
+		auto mix = [&](const void* data, size_t size) {
+			for (size_t i = 0; i < size; i++) {
+				hash ^= ((const uint8_t*)data)[i];
+				hash *= 1099511628211ull;
+			}
+		};
+		mix(path.data(), path.size());
+		mix(&importKey, sizeof(importKey));
+		return hash;
+	}
+}
+
+std::string MeshCache::NormalizeSourcePath(const std::string& sourcePath) {
+	std::error_code error;
+	fs::path path = fs::weakly_canonical(fs::absolute(sourcePath, error), error);
+	return error ? sourcePath : path.generic_string();
+}
+
+std::string MeshCache::GetEntryPath(const std::string& sourcePath, uint64_t importKey) {
+	char name[32];
+	std::snprintf(name, sizeof(name), "%016llx.srmesh", (unsigned long long)HashKey(NormalizeSourcePath(sourcePath), importKey));
+	return (fs::path(Directory) / name).string();
+}
+
+bool MeshCache::Load(const std::string& sourcePath, uint64_t importKey, MeshCacheEntry& entry) {
+	PROFILE_SCOPE("MeshCache::Load");
+	int64_t sourceWriteTime;
+	if (!GetSourceWriteTime(sourcePath, sourceWriteTime))
+		return false;
+	if (!entry.file.Open(GetEntryPath(sourcePath, importKey)))
+		return false;
+
+	const uint8_t* data = entry.file.GetData();
+	size_t size = entry.file.GetSize();
+	MeshCacheHeader header;
+	if (size < sizeof(header)) {
+		entry.file.Close();
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(header));
+
+	std::string normalizedPath = NormalizeSourcePath(sourcePath);
+	bool valid = std::memcmp(header.magic, Magic, sizeof(Magic)) == 0
+		&& header.version == Version
+		&& header.sourceWriteTime == sourceWriteTime
+		&& header.importKey == importKey
+		&& header.sourcePathSize == normalizedPath.size()
+		&& sizeof(header) + header.sourcePathSize <= size
+		&& std::memcmp(data + sizeof(header), normalizedPath.data(), normalizedPath.size()) == 0
+		&& header.attributeCount <= MeshCacheHeader::MaxAttributes
+		&& header.vertexStride > 0
+		&& (header.indexSize == sizeof(uint16_t) || header.indexSize == sizeof(uint32_t))
+		&& header.vertexOffset % BlobAlignment == 0 && header.indexOffset % BlobAlignment == 0
+		&& header.vertexOffset + (uint64_t)header.vertexCount * header.vertexStride <= size
+		&& header.indexOffset + (uint64_t)header.indexCount * header.indexSize <= size;
+	if (!valid) {
+		LOG_INFO("Mesh cache entry of " + sourcePath + " is stale, re-importing");
+		entry.file.Close();
+		return false;
+	}
+
+	entry.layout.attributes.clear();
+	for (uint32_t i = 0; i < header.attributeCount; i++) {
+		const MeshCacheAttribute& stored = header.attributes[i];
+		VertexAttribute attribute;
+		attribute.components = (GLint)stored.components;
+		attribute.type = (GLenum)stored.type;
+		attribute.normalized = stored.normalized ? GL_TRUE : GL_FALSE;
+		attribute.offset = stored.offset;
+		entry.layout.attributes.push_back(attribute);
+	}
+	entry.layout.stride = (GLsizei)header.vertexStride;
+	entry.vertexData = data + header.vertexOffset;
+	entry.vertexSize = (size_t)header.vertexCount * header.vertexStride;
+	entry.indexData = data + header.indexOffset;
+	entry.indexCount = header.indexCount;
+	entry.indexSize = header.indexSize;
+	entry.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+	entry.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+	entry.positionScale = glm::vec3(header.positionScale[0], header.positionScale[1], header.positionScale[2]);
+	entry.positionOffset = glm::vec3(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]);
+	return true;
+}
+
+bool MeshCache::Store(const std::string& sourcePath, uint64_t importKey, const VertexLayout& layout,
+	const void* vertexData, size_t vertexSize, const void* indexData, size_t indexCount, uint32_t indexSize,
+	const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+	const glm::vec3& positionScale, const glm::vec3& positionOffset) {
+	PROFILE_SCOPE("MeshCache::Store");
+	if (layout.stride <= 0 || layout.attributes.size() > MeshCacheHeader::MaxAttributes
+		|| (indexSize != sizeof(uint16_t) && indexSize != sizeof(uint32_t)))
+		return false;
+
+	MeshCacheHeader header{};
+	std::memcpy(header.magic, Magic, sizeof(Magic));
+	header.version = Version;
+	if (!GetSourceWriteTime(sourcePath, header.sourceWriteTime))
+		return false;
+	std::string normalizedPath = NormalizeSourcePath(sourcePath);
+	header.importKey = importKey;
+	header.sourcePathSize = (uint32_t)normalizedPath.size();
+	header.vertexCount = (uint32_t)(vertexSize / layout.stride);
+	header.vertexStride = (uint32_t)layout.stride;
+	header.attributeCount = (uint32_t)layout.attributes.size();
+	for (size_t i = 0; i < layout.attributes.size(); i++) {
+		const VertexAttribute& attribute = layout.attributes[i];
+		header.attributes[i] = { (uint32_t)attribute.components, (uint32_t)attribute.type, (uint32_t)attribute.normalized, attribute.offset };
+	}
+	header.indexCount = (uint32_t)indexCount;
+	header.indexSize = indexSize;
+	std::memcpy(header.boundsMin, &boundsMin[0], sizeof(header.boundsMin));
+	std::memcpy(header.boundsMax, &boundsMax[0], sizeof(header.boundsMax));
+	std::memcpy(header.positionScale, &positionScale[0], sizeof(header.positionScale));
+	std::memcpy(header.positionOffset, &positionOffset[0], sizeof(header.positionOffset));
+	header.vertexOffset = AlignUp(sizeof(header) + normalizedPath.size(), BlobAlignment);
+	header.indexOffset = AlignUp(header.vertexOffset + vertexSize, BlobAlignment);
+
+	std::string entryPath = GetEntryPath(sourcePath, importKey);
+	std::string tempPath = entryPath + "." + std::to_string(TempFileCounter++) + ".tmp";
+	std::error_code error;
+	fs::create_directories(Directory, error);
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			LOG_ERROR("Failed to write mesh cache entry " + tempPath);
+			return false;
+		}
+		const char padding[BlobAlignment] = {};
+		file.write((const char*)&header, sizeof(header));
+		file.write(normalizedPath.data(), normalizedPath.size());
+		file.write(padding, header.vertexOffset - (sizeof(header) + normalizedPath.size()));
+		file.write((const char*)vertexData, vertexSize);
+		file.write(padding, header.indexOffset - (header.vertexOffset + vertexSize));
+		file.write((const char*)indexData, indexCount * indexSize);
+		if (!file) {
+			LOG_ERROR("Failed to write mesh cache entry " + tempPath);
+			file.close();
+			fs::remove(tempPath, error);
+			return false;
+		}
+	}
+
+	// A reader never sees a half-written entry
+	fs::rename(tempPath, entryPath, error);
+	if (error) {
+		LOG_ERROR("Failed to replace mesh cache entry " + entryPath + ": " + error.message());
+		fs::remove(tempPath, error);
+		return false;
+	}
+	LOG_INFO("Mesh cache entry written: " + entryPath);
+	return true;
+}
@@ -0,0 +1,95 @@
+#include "graphics/MeshManager.h"
+#include "core/CpuProfiler.h"
+#include "graphics/MeshCache.h"
+
+using namespace stereorizer::graphics;
+
+MeshManager::MeshManager(AssetLoader& loader)
+	: _loader(loader) {
+}
+
+// Unreferenced meshes go with their entries, referenced ones with their last holder
+MeshManager::~MeshManager() = default;
+
+std::string MeshManager::MakeKey(const std::string& path, const MeshImportOptions& options) {
+	return MeshCache::NormalizeSourcePath(path) + "|" + std::to_string(options.GetCacheKey());
+}
+
+MeshHandle MeshManager::Acquire(const std::string& path, const MeshImportOptions& options) {
+	std::string key = MakeKey(path, options);
+	auto found = _entries.find(key);
+	if (found != _entries.end()) {
+		Entry& entry = found->second;
+		bool failed = entry.handle.IsReady() && !entry.handle.uploaded.get();
+		if (!failed) {
+			entry.lastUsed = _updateCount;
+			_stats.hits++;
+			return entry.handle;
+		}
+		_entries.erase(found);
+	}
+
+	Entry entry;
+	entry.handle = _loader.LoadMesh(path, options);
+	entry.lastUsed = _updateCount;
+	_stats.misses++;
+	MeshHandle handle = entry.handle;
+	_entries.emplace(std::move(key), std::move(entry));
+	_stats.meshCount = _entries.size();
+	return handle;
+}
+
+void MeshManager::Account() {
+	_stats.meshCount = _entries.size();
+	_stats.referencedCount = 0;
+	_stats.gpuBytes = 0;
+	_stats.cpuBytes = 0;
+	for (auto& [key, entry] : _entries) {
+		if (IsReferenced(entry)) {
+			entry.lastUsed = _updateCount;
+			_stats.referencedCount++;
+		}
+		_stats.gpuBytes += entry.handle.mesh->GetGpuBytes();
+		_stats.cpuBytes += entry.handle.mesh->GetCpuBytes();
+	}
+}
+
+void MeshManager::Update() {
+	PROFILE_SCOPE("MeshManager::Update");
+	_updateCount++;
+	Account();
+
+	size_t budget = _stats.gpuBudget;
+	while (budget > 0 && _stats.gpuBytes > budget) {
+		// Least recently referenced of the unreferenced ones. Still loading ones are left alone,
+		// they hold no GPU bytes yet and the loader still has to deliver them.
+		auto victim = _entries.end();
+		for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+			const Entry& entry = it->second;
+			if (IsReferenced(entry) || !entry.handle.IsReady())
+				continue;
+			if (victim == _entries.end() || entry.lastUsed < victim->second.lastUsed)
+				victim = it;
+		}
+		if (victim == _entries.end())
+			break;
+
+		_stats.gpuBytes -= victim->second.handle.mesh->GetGpuBytes();
+		_stats.cpuBytes -= victim->second.handle.mesh->GetCpuBytes();
+		_entries.erase(victim);
+		_stats.evictions++;
+	}
+	_stats.meshCount = _entries.size();
+}
+
+void MeshManager::ReleaseUnused() {
+	for (auto it = _entries.begin(); it != _entries.end();) {
+		if (!IsReferenced(it->second) && it->second.handle.IsReady()) {
+			it = _entries.erase(it);
+			_stats.evictions++;
+		}
+		else
+			++it;
+	}
+	Account();
+}
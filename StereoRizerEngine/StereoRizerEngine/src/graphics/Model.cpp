@@ -4,6 +4,13 @@
 
 using namespace stereorizer::graphics;
 
+namespace
+{
+	constexpr UniformId ModelMatrixUniform("modelMatrix");
+	constexpr UniformId NormalMatrixUniform("normalMatrix");
+	constexpr UniformId MaterialColorUniform("materialColor");
+}
+
 Model::Model(std::shared_ptr<Mesh> mesh, std::shared_ptr<Shader> shader)
 	: _mesh(std::move(mesh)), _shader(std::move(shader))
 {
@@ -14,7 +21,7 @@ Model::~Model() = default;
 
 // Copy constructor
 Model::Model(const Model& other)
-	: _mesh(other._mesh), _shader(other._shader), _transform(other._transform), _color(other._color) {
+	: _mesh(other._mesh), _shader(other._shader), _transform(other._transform), _normalMatrix(other._normalMatrix), _color(other._color) {
 	// Shallow copy - shares the same mesh and shader resources
 }
 
@@ -24,13 +31,14 @@ Model& Model::operator=(const Model& other) {
 		_mesh = other._mesh;
 		_shader = other._shader;
 		_transform = other._transform;
+		_normalMatrix = other._normalMatrix;
 		_color = other._color;
 	}
 	return *this;
 }
 
 Model::Model(Model&& other) noexcept
-	: _mesh(std::move(other._mesh)), _shader(std::move(other._shader)), _transform(other._transform), _color(other._color) {}
+	: _mesh(std::move(other._mesh)), _shader(std::move(other._shader)), _transform(other._transform), _normalMatrix(other._normalMatrix), _color(other._color) {}
 
 Model& Model::operator=(Model&& other) noexcept
 {
@@ -38,6 +46,8 @@ Model& Model::operator=(Model&& other) noexcept
 		_mesh = std::move(other._mesh);
 		_shader = std::move(other._shader);
 		_transform = other._transform;
+		_normalMatrix = other._normalMatrix;
+		_color = other._color;
 	}
 	return *this;
 }
@@ -47,33 +57,57 @@ void stereorizer::graphics::Model::SetShader(std::shared_ptr<Shader> shader) noe
 	_shader = std::move(shader);
 }
 
-void Model::Draw() const
+void Model::Draw(int instanceCount) const
+{
+	UploadUniforms();
+	_mesh->Draw(instanceCount);
+
+	//_shader->Unbind();
+}
+
+void Model::DrawIndirect(GLintptr commandOffset) const
 {
-	GLint modelLoc = glGetUniformLocation(_shader->GetID(), "modelMatrix");
-	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(_transform));
+	UploadUniforms();
+	_mesh->DrawIndirect(commandOffset);
+}
+
+void Model::UploadUniforms() const
+{
+	// Quantized positions are dequantized on the way; the normals aren't quantized against the
+	// bounds, so the normal matrix stays the transform's
+	glm::mat4 modelMatrix = _transform * _mesh->GetDequantization();
+	GLint modelLoc = _shader->GetUniformLocation(ModelMatrixUniform);
+	glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(modelMatrix));
 
-	GLint colorLoc = glGetUniformLocation(_shader->GetID(), "materialColor");
+	GLint normalLoc = _shader->GetUniformLocation(NormalMatrixUniform);
+	if (normalLoc != -1)
+		glUniformMatrix3fv(normalLoc, 1, GL_FALSE, glm::value_ptr(_normalMatrix));
+
+	GLint colorLoc = _shader->GetUniformLocation(MaterialColorUniform);
 	if (colorLoc != -1)
 		glUniform3fv(colorLoc, 1, glm::value_ptr(_color));
 
 	_shader->ReloadIfChanged();
 	_shader->Bind();
-
-	_mesh->Draw();
-
-	//_shader->Unbind();
 }
 
 // --- Transformations ---
 
 void Model::Translate(const glm::vec3& offset) {
 	_transform = glm::translate(_transform, offset);
+	UpdateNormalMatrix();
 }
 
 void Model::Rotate(float angle, const glm::vec3& axis) {
 	_transform = glm::rotate(_transform, glm::radians(angle), axis);
+	UpdateNormalMatrix();
 }
 
 void Model::Scale(const glm::vec3& scale) {
 	_transform = glm::scale(_transform, scale);
+	UpdateNormalMatrix();
+}
+
+void Model::UpdateNormalMatrix() {
+	_normalMatrix = glm::transpose(glm::inverse(glm::mat3(_transform)));
 }
@@ -0,0 +1,160 @@
+#include "graphics/OcclusionCuller.h"
+#include "graphics/GLStateCache.h"
+#include "core/Common.h"
+
+using namespace stereorizer::graphics;
+
+namespace
+{
+	constexpr UniformId DepthPyramidUniform("depthPyramid");
+	constexpr UniformId EyeIndexUniform("eyeIndex");
+	constexpr UniformId ObjectCountUniform("objectCount");
+
+	// Match the "binding =" qualifiers and the work group size in OcclusionCull.shader
+	constexpr GLuint ObjectBufferBinding = 1;
+	constexpr GLuint CommandBufferBinding = 2;
+	constexpr GLuint CounterBufferBinding = 3;
+	constexpr int GroupSize = 64;
+}
+
+OcclusionCuller::OcclusionCuller() {
+	// Shader and buffers are created on the first Cull(), the context might not be ready yet
+}
+
+OcclusionCuller::~OcclusionCuller() {
+	DeleteBuffers();
+	if (_counterFence) {
+		glDeleteSync(_counterFence);
+		_counterFence = nullptr;
+	}
+	if (_counterBuffer != 0) {
+		glDeleteBuffers(1, &_counterBuffer);
+		_counterBuffer = 0;
+	}
+}
+
+void OcclusionCuller::DeleteBuffers() {
+	if (_objectBuffer != 0) {
+		glDeleteBuffers(1, &_objectBuffer);
+		_objectBuffer = 0;
+	}
+	if (_commandBuffer != 0) {
+		glDeleteBuffers(1, &_commandBuffer);
+		_commandBuffer = 0;
+	}
+	_capacity = 0;
+}
+
+bool OcclusionCuller::CreateResources(size_t modelCount) {
+	if (!_shader) {
+		try {
+			_shader = std::make_shared<Shader>("resources/shaders/OcclusionCull.shader");
+		} catch (const std::exception& e) {
+			LOG_ERROR(std::string("Failed to load occlusion culling shader: ") + e.what());
+			return false;
+		}
+		glGenBuffers(1, &_counterBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, _counterBuffer);
+		glBufferStorage(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+	if (_shader->GetID() == 0)
+		return false;
+
+	if (modelCount <= _capacity)
+		return true;
+
+	DeleteBuffers();
+	_capacity = std::max<size_t>(modelCount, 16);
+
+	glGenBuffers(1, &_objectBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _objectBuffer);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, _capacity * sizeof(CullObject), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+	glGenBuffers(1, &_commandBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _commandBuffer);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, _capacity * sizeof(DrawElementsIndirectCommand), nullptr, 0);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	return true;
+}
+
+void OcclusionCuller::ReadVisibleCount() {
+	if (!_counterFence)
+		return;
+
+	// Written by the previous Cull. If that hasn't retired yet the sample is dropped,
+	// reading it would stall the CPU on the GPU
+	GLenum status = glClientWaitSync(_counterFence, 0, 0);
+	glDeleteSync(_counterFence);
+	_counterFence = nullptr;
+	if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		return;
+
+	GLuint visible = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _counterBuffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &visible);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	_visibleCount = (int)visible;
+}
+
+bool OcclusionCuller::Cull(const std::vector<std::shared_ptr<Model>>& models, const DepthPyramid& pyramid, int eyeIndex) {
+	if (models.empty() || !pyramid.IsValid() || !CreateResources(models.size()))
+		return false;
+
+	ReadVisibleCount();
+
+	_objects.clear();
+	for (const auto& model : models) {
+		CullObject object{};
+		if (model) {
+			const Mesh& mesh = *model->GetMesh();
+			object.modelMatrix = model->GetTransformMatrix();
+			object.boundsMin = mesh.GetBoundsMin();
+			object.indexCount = mesh.GetIndexCount();
+			object.boundsMax = mesh.GetBoundsMax();
+		}
+		_objects.push_back(object);
+	}
+
+	GLStateCache& state = GLStateCache::Get();
+	GLStateSnapshot savedState = state.Save();
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _objectBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, _objects.size() * sizeof(CullObject), _objects.data());
+	GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _counterBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ObjectBufferBinding, _objectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CommandBufferBinding, _commandBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CounterBufferBinding, _counterBuffer);
+
+	_shader->ReloadIfChanged();
+	_shader->Bind();
+	state.BindTexture(0, GL_TEXTURE_2D, pyramid.GetTexture());
+	glUniform1i(_shader->GetUniformLocation(DepthPyramidUniform), 0);
+	glUniform1i(_shader->GetUniformLocation(EyeIndexUniform), eyeIndex);
+	glUniform1ui(_shader->GetUniformLocation(ObjectCountUniform), (GLuint)_objects.size());
+
+	glDispatchCompute((GLuint)((_objects.size() + GroupSize - 1) / GroupSize), 1, 1);
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+	_counterFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	state.Restore(savedState);
+
+	_testedCount = (int)_objects.size();
+	return true;
+}
+
+void OcclusionCuller::BeginDraws() const {
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBuffer);
+}
+
+void OcclusionCuller::DrawModel(const Model& model, size_t index) const {
+	model.DrawIndirect((GLintptr)(index * sizeof(DrawElementsIndirectCommand)));
+}
+
+void OcclusionCuller::EndDraws() const {
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
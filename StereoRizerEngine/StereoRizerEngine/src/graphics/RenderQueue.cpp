@@ -0,0 +1,135 @@
+#include "graphics/RenderQueue.h"
+#include "graphics/Mesh.h"
+#include "core/CpuProfiler.h"
+#include "core/WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+using namespace stereorizer::graphics;
+
+const std::vector<std::shared_ptr<Model>> RenderQueue::NoModels;
+
+uint64_t DrawKey::Make(RenderPass pass, GLuint program, GLuint vertexArray, float depth) {
+	uint32_t depthBits;
+	depth = std::max(depth, 0.0f);
+	std::memcpy(&depthBits, &depth, sizeof(depthBits));
+
+	return ((uint64_t)pass << PassShift)
+		| ((uint64_t)(program & ((1u << VariantBits) - 1)) << VariantShift)
+		| ((uint64_t)(vertexArray & ((1u << MeshBits) - 1)) << MeshShift)
+		| (uint64_t)(depthBits >> (32 - DepthBits));
+}
+
+void RenderQueue::Record(const std::vector<std::shared_ptr<Model>>& models, const Camera& leftCamera, const Camera& rightCamera, bool depthPrepass) {
+	PROFILE_SCOPE("RenderQueue::Record");
+	auto start = std::chrono::steady_clock::now();
+	_models = &models;
+
+	// Eye positions and directions from the views, the XR path sets those without the camera vectors
+	glm::mat4 leftWorld = glm::inverse(leftCamera.GetViewMatrix());
+	glm::mat4 rightWorld = glm::inverse(rightCamera.GetViewMatrix());
+	glm::vec3 viewPosition = 0.5f * (glm::vec3(leftWorld[3]) + glm::vec3(rightWorld[3]));
+	glm::vec3 viewForward = -glm::normalize(glm::vec3(leftWorld[2]) + glm::vec3(rightWorld[2]));
+
+	core::WorkerPool& pool = core::WorkerPool::Get();
+	_buckets.resize(pool.GetSlotCount());
+	for (auto& bucket : _buckets)
+		bucket.clear();
+
+	pool.ParallelFor(models.size(), MinModelsPerThread, [&](size_t begin, size_t end, unsigned slot) {
+		std::vector<DrawPacket>& bucket = _buckets[slot];
+		for (size_t i = begin; i < end; i++) {
+			const Model* model = models[i].get();
+			if (!model)
+				continue;
+			const Mesh& mesh = *model->GetMesh();
+			glm::vec3 center = glm::vec3(model->GetTransformMatrix() * glm::vec4(0.5f * (mesh.GetBoundsMin() + mesh.GetBoundsMax()), 1.0f));
+			float depth = glm::dot(center - viewPosition, viewForward);
+			GLuint program = model->GetShader()->GetID();
+			GLuint vertexArray = mesh.GetVertexArrayId();
+
+			if (depthPrepass)
+				bucket.push_back({ DrawKey::Make(RenderPass::DepthPrepass, program, vertexArray, depth), model, (uint32_t)i });
+			bucket.push_back({ DrawKey::Make(RenderPass::Opaque, program, vertexArray, depth), model, (uint32_t)i });
+		}
+	});
+
+	_packets.clear();
+	_stats = {};
+	for (const auto& bucket : _buckets) {
+		if (bucket.empty())
+			continue;
+		_packets.insert(_packets.end(), bucket.begin(), bucket.end());
+		_stats.bucketCount++;
+	}
+	auto recorded = std::chrono::steady_clock::now();
+
+	SortPackets();
+
+	// Pass ranges, and the state changes the sorted order leaves
+	size_t index = 0;
+	for (size_t pass = 0; pass <= (size_t)RenderPass::Count; pass++) {
+		while (index < _packets.size() && (size_t)DrawKey::GetPass(_packets[index].key) < pass)
+			index++;
+		_passBegin[pass] = index;
+	}
+	for (size_t i = 0; i < _packets.size(); i++) {
+		uint64_t key = _packets[i].key;
+		uint64_t previous = i > 0 ? _packets[i - 1].key : ~key;
+		if (DrawKey::GetVariant(key) != DrawKey::GetVariant(previous))
+			_stats.variantChanges++;
+		if (DrawKey::GetMesh(key) != DrawKey::GetMesh(previous))
+			_stats.meshChanges++;
+	}
+
+	auto end = std::chrono::steady_clock::now();
+	_stats.packetCount = _packets.size();
+	_stats.recordMs = std::chrono::duration<double, std::milli>(recorded - start).count();
+	_stats.sortMs = std::chrono::duration<double, std::milli>(end - recorded).count();
+}
+
+void RenderQueue::SortPackets() {
+	size_t count = _packets.size();
+	if (count < 2)
+		return;
+
+	// One counting sweep for all eight digits
+	size_t histograms[8][256] = {};
+	for (const auto& packet : _packets) {
+		for (int digit = 0; digit < 8; digit++)
+			histograms[digit][(packet.key >> (digit * 8)) & 0xFF]++;
+	}
+
+	_sortScratch.resize(count);
+	bool inScratch = false;
+	for (int digit = 0; digit < 8; digit++) {
+		const std::vector<DrawPacket>& source = inScratch ? _sortScratch : _packets;
+		std::vector<DrawPacket>& destination = inScratch ? _packets : _sortScratch;
+		int shift = digit * 8;
+		size_t* histogram = histograms[digit];
+
+		// A digit every key shares leaves the order as it is
+		if (histogram[(source[0].key >> shift) & 0xFF] == count)
+			continue;
+
+		size_t offset = 0;
+		for (int value = 0; value < 256; value++) {
+			size_t valueCount = histogram[value];
+			histogram[value] = offset;
+			offset += valueCount;
+		}
+		for (const auto& packet : source)
+			destination[histogram[(packet.key >> shift) & 0xFF]++] = packet;
+		inScratch = !inScratch;
+	}
+	if (inScratch)
+		_packets.swap(_sortScratch);
+}
+
+std::span<const DrawPacket> RenderQueue::GetPass(RenderPass pass) const {
+	size_t begin = _passBegin[(size_t)pass];
+	size_t end = _passBegin[(size_t)pass + 1];
+	return std::span<const DrawPacket>(_packets.data() + begin, end - begin);
+}
@@ -1,10 +1,32 @@
 #include "graphics/Renderer.h"
 #include "graphics/Camera.h"
 #include "graphics/Model.h"
+#include "graphics/GLStateCache.h"
 #include "core/Common.h"
 
+#include <algorithm>
+
 using namespace stereorizer::graphics;
 
+namespace
+{
+	constexpr UniformId NearPlaneUniform("nearPlane");
+	constexpr UniformId FarPlaneUniform("farPlane");
+	constexpr UniformId DepthTextureUniform("depthTexture");
+	constexpr UniformId ColorTextureUniform("colorTexture");
+	constexpr UniformId EyeIndexUniform("eyeIndex");
+	constexpr UniformId FrameDataBlock("FrameData");
+	constexpr UniformId RightDepthTextureUniform("rightDepthTexture");
+	constexpr UniformId LeftDepthTextureUniform("leftDepthTexture");
+	constexpr UniformId LeftColorTextureUniform("leftColorTexture");
+	constexpr UniformId ResolvedDepthTextureUniform("resolvedDepthTexture");
+	constexpr UniformId LeftDepthPyramidUniform("leftDepthPyramid");
+	constexpr UniformId PyramidLevelUniform("pyramidLevel");
+
+	// Stencil value of pixels the left eye cannot explain and that need full shading
+	constexpr GLint DisoccludedStencil = 1;
+}
+
 Renderer::Renderer()
 	: _camera(std::make_shared<Camera>(45.0f, 4.0f / 3.0f, 0.1f, 10.0f)) {
 	// Framebuffer and textures are created on-demand in BeginDepthTextureRender
@@ -12,14 +34,12 @@ Renderer::Renderer()
 }
 
 Renderer::~Renderer() {
-	if (_framebuffer != 0) {
-		glDeleteFramebuffers(1, &_framebuffer);
-	}
-	if (_colorTexture != 0) {
-		glDeleteTextures(1, &_colorTexture);
+	DeleteTextureResources();
+	if (_holeQuery != 0) {
+		glDeleteQueries(1, &_holeQuery);
 	}
-	if (_depthTexture != 0) {
-		glDeleteTextures(1, &_depthTexture);
+	if (_reuseQuery != 0) {
+		glDeleteQueries(1, &_reuseQuery);
 	}
 	CleanupFullScreenQuad();
 }
@@ -35,13 +55,50 @@ void Renderer::Clear() {
 }
 
 void Renderer::Draw(std::shared_ptr<Model> model) {
-	if (_camera)
-		_camera->UploadToShader(model->GetShader());
-	if (_light)
-		_light->UploadToShader(model->GetShader()->GetID(), "light");
+	UploadPerDraw(*model);
 	model->Draw();
 }
 
+void Renderer::Submit(const RenderQueue& queue, RenderPass pass, const char* define, const OcclusionCuller* culler) {
+	Shader* current = nullptr;
+	if (culler)
+		culler->BeginDraws();
+	for (const DrawPacket& packet : queue.GetPass(pass)) {
+		Shader* shader = packet.model->GetShader().get();
+		if (shader != current) {
+			if (current && define)
+				current->DisableDefine(define);
+			if (define)
+				shader->EnableDefine(define);
+			shader->ActivateVariant();
+			UploadPerDraw(*packet.model);
+			current = shader;
+		}
+		if (culler)
+			culler->DrawModel(*packet.model, packet.modelIndex);
+		else
+			packet.model->Draw();
+	}
+	if (current && define)
+		current->DisableDefine(define);
+	if (culler)
+		culler->EndDraws();
+}
+
+void Renderer::UploadPerDraw(const Model& model) {
+	auto shader = model.GetShader();
+	if (shader->HasUniformBlock(FrameDataBlock)) {
+		// Camera and light come from the per-frame uniform buffer, only pick the eye
+		glUniform1i(shader->GetUniformLocation(EyeIndexUniform), _eyeIndex);
+	}
+	else {
+		if (_camera)
+			_camera->UploadToShader(shader);
+		if (_light)
+			_light->UploadToShader(*shader);
+	}
+}
+
 void stereorizer::graphics::Renderer::SetLight(std::shared_ptr<Light> light)
 {
 	_light = light;
@@ -55,26 +112,38 @@ void Renderer::SetupDepthTexture(int width, int height, bool isRightViewport) {
 	_isRightViewport = isRightViewport;
 	
 	// Clean up existing resources only
+	DeleteTextureResources();
+	
+	LOG_INFO("Depth texture setup deferred - will be created on first use");
+	LOG_INFO("Target size: " + std::to_string(width) + "x" + std::to_string(height));
+}
+
+void Renderer::DeleteTextureResources() {
 	if (_framebuffer != 0) {
-		glDeleteFramebuffers(1, &_framebuffer);
+		GLStateCache::Get().DeleteFramebuffers(1, &_framebuffer);
 		_framebuffer = 0;
 	}
 	if (_colorTexture != 0) {
-		glDeleteTextures(1, &_colorTexture);
+		GLStateCache::Get().DeleteTextures(1, &_colorTexture);
 		_colorTexture = 0;
 	}
 	if (_depthTexture != 0) {
-		glDeleteTextures(1, &_depthTexture);
+		GLStateCache::Get().DeleteTextures(1, &_depthTexture);
 		_depthTexture = 0;
 	}
-	
-	LOG_INFO("Depth texture setup deferred - will be created on first use");
-	LOG_INFO("Target size: " + std::to_string(width) + "x" + std::to_string(height));
+	if (_prepassFramebuffer != 0) {
+		GLStateCache::Get().DeleteFramebuffers(1, &_prepassFramebuffer);
+		_prepassFramebuffer = 0;
+	}
+	if (_prepassDepthTexture != 0) {
+		GLStateCache::Get().DeleteTextures(1, &_prepassDepthTexture);
+		_prepassDepthTexture = 0;
+	}
 }
 
 void Renderer::CreateColorTexture() {
 	glGenTextures(1, &_colorTexture);
-	glBindTexture(GL_TEXTURE_2D, _colorTexture);
+	GLStateCache::Get().BindTexture(GL_TEXTURE_2D, _colorTexture);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, _textureWidth, _textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -84,25 +153,27 @@ void Renderer::CreateColorTexture() {
 
 void Renderer::CreateDepthTexture() {
 	glGenTextures(1, &_depthTexture);
-	glBindTexture(GL_TEXTURE_2D, _depthTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, _textureWidth, _textureHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	GLStateCache::Get().BindTexture(GL_TEXTURE_2D, _depthTexture);
+	// Stencil rides along for the stencil-masked right eye, sampling still returns depth
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, _textureWidth, _textureHeight, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+	glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_STENCIL_TEXTURE_MODE, GL_DEPTH_COMPONENT);
 }
 
 void Renderer::CreateFramebuffer() {
 	glGenFramebuffers(1, &_framebuffer);
-	glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
 	
 	// Create and attach textures
 	CreateColorTexture();
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _colorTexture, 0);
 	
 	CreateDepthTexture();
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _depthTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, _depthTexture, 0);
 	
 	// Ensure we have both color and depth attachments
 	GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0 };
@@ -114,15 +185,15 @@ void Renderer::CreateFramebuffer() {
 		LOG_ERROR("Framebuffer not complete for depth texture rendering! Status: " + std::to_string(status));
 		// Clean up failed resources
 		if (_framebuffer != 0) {
-			glDeleteFramebuffers(1, &_framebuffer);
+			GLStateCache::Get().DeleteFramebuffers(1, &_framebuffer);
 			_framebuffer = 0;
 		}
 		if (_colorTexture != 0) {
-			glDeleteTextures(1, &_colorTexture);
+			GLStateCache::Get().DeleteTextures(1, &_colorTexture);
 			_colorTexture = 0;
 		}
 		if (_depthTexture != 0) {
-			glDeleteTextures(1, &_depthTexture);
+			GLStateCache::Get().DeleteTextures(1, &_depthTexture);
 			_depthTexture = 0;
 		}
 		throw std::runtime_error("Failed to create framebuffer");
@@ -140,31 +211,31 @@ void Renderer::BeginTextureRender() {
 	// Create framebuffer and textures on first use if not already created
 	if (_framebuffer == 0) {
 		// Save current OpenGL state
-		OpenGLState savedState = SaveOpenGLState();
+		GLStateSnapshot savedState = GLStateCache::Get().Save();
 		
 		try {
 			CreateFramebuffer();
 		} catch (const std::runtime_error& e) {
 			// Restore state and return on failure
-			RestoreOpenGLState(savedState);
+			GLStateCache::Get().Restore(savedState);
 			return;
 		}
 		
 		// Restore state after creation
-		RestoreOpenGLState(savedState);
+		GLStateCache::Get().Restore(savedState);
 	}
 	
 	// Now use the framebuffer for rendering
-	glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
 	// Set viewport based on whether this is right viewport (shifted) or left viewport
-	glViewport(0, 0, _textureWidth, _textureHeight);
+	GLStateCache::Get().Viewport(0, 0, _textureWidth, _textureHeight);
 	
 	// Ensure depth testing and depth writes are enabled
-	glEnable(GL_DEPTH_TEST);
+	GLStateCache::Get().Enable(GL_DEPTH_TEST);
 	glDepthMask(GL_TRUE);
 	glDepthFunc(GL_LESS);
 	
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
 
 void Renderer::EndTextureRender() {
@@ -175,29 +246,329 @@ void Renderer::EndTextureRender() {
 		LOG_ERROR("Framebuffer not complete when ending render! Status: " + std::to_string(status));
 	}
 
-	glFlush();
-	glFinish();
-	
-	glViewport(_isRightViewport ? _textureWidth : 0, 0, _textureWidth, _textureHeight);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	// Coarse depth for reprojection and culling, before anything samples this depth
+	if (_depthPyramidEnabled)
+		_depthPyramid.Build(_depthTexture, _textureWidth, _textureHeight);
+
+	GLStateCache::Get().Viewport(_isRightViewport ? _textureWidth : 0, 0, _textureWidth, _textureHeight);
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _presentFramebuffer);
 }
 
-void Renderer::RenderToTextures(const std::vector<std::shared_ptr<Model>>& models) {
+void Renderer::RenderToTextures(const RenderQueue& queue) {
+	_pixelReuseRatio = 0.0f;
 
 	BeginTextureRender();
-	for (const auto& model : models) {
-		if (model) {
-			Draw(model);
+	Submit(queue, RenderPass::Opaque);
+	EndTextureRender();
+}
+
+bool Renderer::CreatePrepassFramebuffer() {
+	glGenTextures(1, &_prepassDepthTexture);
+	GLStateCache::Get().BindTexture(GL_TEXTURE_2D, _prepassDepthTexture);
+	// Same format as the main depth texture so the tiled path can blit it over
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, _textureWidth, _textureHeight, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, nullptr);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+	glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_STENCIL_TEXTURE_MODE, GL_DEPTH_COMPONENT);
+
+	glGenFramebuffers(1, &_prepassFramebuffer);
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _prepassFramebuffer);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _prepassDepthTexture, 0);
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		LOG_ERROR("Depth prepass framebuffer not complete! Status: " + std::to_string(status));
+		GLStateCache::Get().DeleteFramebuffers(1, &_prepassFramebuffer);
+		_prepassFramebuffer = 0;
+		GLStateCache::Get().DeleteTextures(1, &_prepassDepthTexture);
+		_prepassDepthTexture = 0;
+		return false;
+	}
+	return true;
+}
+
+bool Renderer::RenderDepthPrepass(const RenderQueue& queue) {
+	if (_prepassFramebuffer == 0 && !CreatePrepassFramebuffer())
+		return false;
+
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _prepassFramebuffer);
+	glClear(GL_DEPTH_BUFFER_BIT);
+	// Queues recorded without prepass packets draw their opaque ones depth-only
+	bool hasPrepass = !queue.GetPass(RenderPass::DepthPrepass).empty();
+	Submit(queue, hasPrepass ? RenderPass::DepthPrepass : RenderPass::Opaque, "DEPTH_ONLY");
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	return true;
+}
+
+void Renderer::RenderToTexturesStencilMasked(const RenderQueue& queue, GLuint leftColorTexture, GLuint leftDepthTexture) {
+	if (leftColorTexture == 0 || leftDepthTexture == 0) {
+		RenderToTextures(queue);
+		return;
+	}
+
+	if (_quadVAO == 0)
+		SetupFullScreenQuad();
+	if (!_stencilReprojectionShader) {
+		try {
+			_stencilReprojectionShader = std::make_shared<Shader>("resources/shaders/StencilReprojection.shader");
+		} catch (const std::exception& e) {
+			LOG_ERROR(std::string("Failed to load stencil reprojection shader: ") + e.what());
 		}
 	}
+
+	// Main targets are created (and cleared) here, the prepass target next to them
+	BeginTextureRender();
+	if (_framebuffer == 0)
+		return;
+
+	// Pass 1: right eye depth only, no shading
+	if (!_stencilReprojectionShader || _quadVAO == 0 || !RenderDepthPrepass(queue)) {
+		_pixelReuseRatio = 0.0f;
+		Submit(queue, RenderPass::Opaque);
+		EndTextureRender();
+		return;
+	}
+
+	// Pass 2: full-screen reprojection. Every pixel starts as disoccluded, fragments that find a
+	// matching left-eye sample copy its color, restore the prepass depth and clear the stencil bit.
+	// Lookups outside the left frustum or failing the depth test discard and keep the bit.
+	glClearStencil(DisoccludedStencil);
+	glClear(GL_STENCIL_BUFFER_BIT);
+	glClearStencil(0);
+
+	GLStateCache::Get().Enable(GL_STENCIL_TEST);
+	glStencilMask(0xFF);
+	glStencilFunc(GL_ALWAYS, 0, 0xFF);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+	glDepthFunc(GL_ALWAYS);
+
+	_stencilReprojectionShader->ReloadIfChanged();
+	bool usePyramid = _reprojectionPyramid && _reprojectionPyramid->IsValid();
+	if (usePyramid)
+		_stencilReprojectionShader->EnableDefine("USE_DEPTH_PYRAMID");
+	else
+		_stencilReprojectionShader->DisableDefine("USE_DEPTH_PYRAMID");
+	_stencilReprojectionShader->ActivateVariant();
+	GLStateCache::Get().BindTexture(0, GL_TEXTURE_2D, _prepassDepthTexture);
+	glUniform1i(_stencilReprojectionShader->GetUniformLocation(RightDepthTextureUniform), 0);
+	GLStateCache::Get().BindTexture(1, GL_TEXTURE_2D, leftDepthTexture);
+	glUniform1i(_stencilReprojectionShader->GetUniformLocation(LeftDepthTextureUniform), 1);
+	GLStateCache::Get().BindTexture(2, GL_TEXTURE_2D, leftColorTexture);
+	glUniform1i(_stencilReprojectionShader->GetUniformLocation(LeftColorTextureUniform), 2);
+	if (usePyramid) {
+		GLStateCache::Get().BindTexture(3, GL_TEXTURE_2D, _reprojectionPyramid->GetTexture());
+		glUniform1i(_stencilReprojectionShader->GetUniformLocation(LeftDepthPyramidUniform), 3);
+		glUniform1i(_stencilReprojectionShader->GetUniformLocation(PyramidLevelUniform), std::min(DepthPyramid::BlockTestLevel, _reprojectionPyramid->GetLevelCount() - 1));
+	}
+	GLStateCache::Get().ActiveTexture(0);
+
+	// Surviving fragments are the copied pixels. Only one count is in flight at a time, it is
+	// read back on a later frame so the CPU never waits for it.
+	if (_reuseQuery == 0)
+		glGenQueries(1, &_reuseQuery);
+	bool countReuse = !_reuseQueryPending || ReadReuseQuery();
+	if (countReuse)
+		glBeginQuery(GL_SAMPLES_PASSED, _reuseQuery);
+	GLStateCache::Get().BindVertexArray(_quadVAO);
+	glDrawArrays(GL_TRIANGLES, 0, 6);
+	GLStateCache::Get().BindVertexArray(0);
+	if (countReuse) {
+		glEndQuery(GL_SAMPLES_PASSED);
+		_reuseQueryPending = true;
+	}
+
+	// Pass 3: full shading only where the stencil bit survived
+	glDepthFunc(GL_LESS);
+	glStencilFunc(GL_EQUAL, DisoccludedStencil, 0xFF);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+	Submit(queue, RenderPass::Opaque);
+	GLStateCache::Get().Disable(GL_STENCIL_TEST);
+
 	EndTextureRender();
 }
 
+bool Renderer::ReadReuseQuery() {
+	GLint available = GL_FALSE;
+	glGetQueryObjectiv(_reuseQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return false;
+
+	GLuint samples = 0;
+	glGetQueryObjectuiv(_reuseQuery, GL_QUERY_RESULT, &samples);
+	int pixelCount = _textureWidth * _textureHeight;
+	_pixelReuseRatio = pixelCount > 0 ? std::min(1.0f, (float)samples / pixelCount) : 0.0f;
+	_reuseQueryPending = false;
+	return true;
+}
+
+void Renderer::RenderToTexturesTiled(const RenderQueue& queue, GLuint leftColorTexture, GLuint leftDepthTexture) {
+	if (leftColorTexture == 0 || leftDepthTexture == 0) {
+		RenderToTextures(queue);
+		return;
+	}
+
+	BeginTextureRender();
+	if (_framebuffer == 0)
+		return;
+
+	// Depth prepass feeds the classification, tiles come back as scissor rectangles
+	bool classified = RenderDepthPrepass(queue)
+		&& _tileClassifier.Classify(_prepassDepthTexture, leftDepthTexture, leftColorTexture, _colorTexture, _textureWidth, _textureHeight, _reprojectionPyramid);
+	if (!classified) {
+		_pixelReuseRatio = 0.0f;
+		Submit(queue, RenderPass::Opaque);
+		EndTextureRender();
+		return;
+	}
+
+	const TileStats& tileStats = _tileClassifier.GetStats();
+	_pixelReuseRatio = tileStats.tileCount > 0 ? 1.0f - (float)tileStats.shadedTileCount / tileStats.tileCount : 0.0f;
+
+	// The copy kernel filled every pixel with a left-eye color, the failed ones too. Shaded tiles
+	// start from the clear color again, otherwise background the geometry doesn't cover keeps the
+	// left eye's foreground along disocclusions.
+	GLStateCache::Get().Enable(GL_SCISSOR_TEST);
+	for (const auto& rect : _tileClassifier.GetShadeRects()) {
+		GLStateCache::Get().Scissor(rect.x, rect.y, rect.width, rect.height);
+		glClear(GL_COLOR_BUFFER_BIT);
+		Submit(queue, RenderPass::Opaque);
+	}
+	GLStateCache::Get().Disable(GL_SCISSOR_TEST);
+
+	// Skipped tiles still hold the cleared depth. The prepass has the whole eye's, the shaded
+	// tiles included (same geometry), so it replaces the main depth for the right-eye depth
+	// texture and the visualization.
+	GLStateCache::Get().BindFramebuffer(GL_READ_FRAMEBUFFER, _prepassFramebuffer);
+	GLStateCache::Get().BindFramebuffer(GL_DRAW_FRAMEBUFFER, _framebuffer);
+	glBlitFramebuffer(0, 0, _textureWidth, _textureHeight, 0, 0, _textureWidth, _textureHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+
+	EndTextureRender();
+}
+
+void Renderer::RenderToTexturesForward(const RenderQueue& queue, GLuint leftColorTexture, GLuint leftDepthTexture) {
+	if (leftColorTexture == 0 || leftDepthTexture == 0) {
+		RenderToTextures(queue);
+		return;
+	}
+
+	if (_quadVAO == 0)
+		SetupFullScreenQuad();
+	if (!_forwardHolesShader) {
+		try {
+			_forwardHolesShader = std::make_shared<Shader>("resources/shaders/ForwardReprojectionHoles.shader");
+		} catch (const std::exception& e) {
+			LOG_ERROR(std::string("Failed to load forward reprojection holes shader: ") + e.what());
+		}
+	}
+	if (_holeQuery == 0)
+		glGenQueries(1, &_holeQuery);
+
+	BeginTextureRender();
+	if (_framebuffer == 0)
+		return;
+
+	// Scatter, resolve and crack filling write the right color target directly
+	bool reprojected = _forwardHolesShader && _quadVAO != 0
+		&& _forwardReprojector.Reproject(leftColorTexture, leftDepthTexture, _colorTexture, _textureWidth, _textureHeight);
+	if (!reprojected) {
+		_pixelReuseRatio = 0.0f;
+		Submit(queue, RenderPass::Opaque);
+		EndTextureRender();
+		return;
+	}
+
+	// Filled cracks count as reused, only the holes go back to the geometry
+	const ForwardReprojectionStats& forwardStats = _forwardReprojector.GetStats();
+	int pixelCount = _textureWidth * _textureHeight;
+	_pixelReuseRatio = pixelCount > 0 ? 1.0f - (float)forwardStats.holePixels / pixelCount : 0.0f;
+
+	_forwardHolesShader->ReloadIfChanged();
+	GLStateCache::Get().BindTexture(0, GL_TEXTURE_2D, _forwardReprojector.GetResolvedDepthTexture());
+	GLStateCache::Get().BindVertexArray(_quadVAO);
+	glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+	// Reprojected pixels restore their depth so the right depth view stays meaningful
+	_forwardHolesShader->DisableDefine("MARK_HOLES");
+	_forwardHolesShader->ActivateVariant();
+	glUniform1i(_forwardHolesShader->GetUniformLocation(ResolvedDepthTextureUniform), 0);
+	glDepthFunc(GL_ALWAYS);
+	glDrawArrays(GL_TRIANGLES, 0, 6);
+
+	// Holes get the stencil bit, the query tells the GPU whether there is anything to re-render
+	_forwardHolesShader->EnableDefine("MARK_HOLES");
+	_forwardHolesShader->ActivateVariant();
+	glUniform1i(_forwardHolesShader->GetUniformLocation(ResolvedDepthTextureUniform), 0);
+	glDepthMask(GL_FALSE);
+	GLStateCache::Get().Enable(GL_STENCIL_TEST);
+	glStencilMask(0xFF);
+	glStencilFunc(GL_ALWAYS, DisoccludedStencil, 0xFF);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+	glBeginQuery(GL_ANY_SAMPLES_PASSED, _holeQuery);
+	glDrawArrays(GL_TRIANGLES, 0, 6);
+	glEndQuery(GL_ANY_SAMPLES_PASSED);
+	GLStateCache::Get().BindVertexArray(0);
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+	glDepthFunc(GL_LESS);
+	glStencilFunc(GL_EQUAL, DisoccludedStencil, 0xFF);
+	glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+
+	// Hi-Z culling against the reprojected right depth: holes count as far, so only models behind
+	// reprojected surfaces everywhere they cover are dropped, and those could not reach a hole anyway
+	bool culled = _depthPyramid.Build(_forwardReprojector.GetResolvedDepthTexture(), _textureWidth, _textureHeight, true)
+		&& _occlusionCuller.Cull(queue.GetModels(), _depthPyramid, _eyeIndex);
+
+	// Geometric re-render of the holes, dropped by the GPU without a CPU round trip when none are left
+	glBeginConditionalRender(_holeQuery, GL_QUERY_WAIT);
+	Submit(queue, RenderPass::Opaque, nullptr, culled ? &_occlusionCuller : nullptr);
+	glEndConditionalRender();
+	GLStateCache::Get().Disable(GL_STENCIL_TEST);
+
+	EndTextureRender();
+}
+
+void Renderer::RenderToStereoTarget(const RenderQueue& queue, StereoRenderTarget& target, const Camera& rightCamera) {
+	if (!target.Begin())
+		return;
+
+	// Side-by-side keeps each eye in its half by clipping at the seam in the vertex shader
+	bool sideBySide = target.GetLayout() == StereoLayout::SideBySide;
+	if (sideBySide)
+		GLStateCache::Get().Enable(GL_CLIP_DISTANCE0);
+
+	int instanceCount = target.GetInstanceCount();
+	const Shader* current = nullptr;
+	for (const DrawPacket& packet : queue.GetPass(RenderPass::Opaque)) {
+		auto shader = packet.model->GetShader();
+		if (shader.get() != current) {
+			shader->Bind();
+			// Shaders reading FrameData pick both eyes from the uniform buffer
+			if (!shader->HasUniformBlock(FrameDataBlock)) {
+				if (_camera)
+					Camera::UploadStereoToShader(shader, *_camera, rightCamera);
+				if (_light)
+					_light->UploadToShader(*shader);
+			}
+			current = shader.get();
+		}
+		packet.model->Draw(instanceCount);
+	}
+
+	if (sideBySide)
+		GLStateCache::Get().Disable(GL_CLIP_DISTANCE0);
+
+	target.End();
+}
+
 void Renderer::SetupFullScreenQuad() {
-	// Save current OpenGL state
-	GLint previousVAO, previousVBO, previousArrayBuffer;
-	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVAO);
-	glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousArrayBuffer);
+	GLuint previousVAO = GLStateCache::Get().GetVertexArray();
 	
 	// Full-screen quad vertices (position + texture coordinates)
 	float quadVertices[] = {
@@ -213,7 +584,7 @@ void Renderer::SetupFullScreenQuad() {
 
 	glGenVertexArrays(1, &_quadVAO);
 	glGenBuffers(1, &_quadVBO);
-	glBindVertexArray(_quadVAO);
+	GLStateCache::Get().BindVertexArray(_quadVAO);
 	glBindBuffer(GL_ARRAY_BUFFER, _quadVBO);
 	glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
 	
@@ -225,9 +596,8 @@ void Renderer::SetupFullScreenQuad() {
 	glEnableVertexAttribArray(1);
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
 	
-	// Restore previous OpenGL state
-	glBindVertexArray(previousVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, previousArrayBuffer);
+	// GL_ARRAY_BUFFER isn't part of the VAO, leaving the quad's bound is harmless
+	GLStateCache::Get().BindVertexArray(previousVAO);
 	
 	// Load visualization shaders
 	try {
@@ -247,7 +617,7 @@ void Renderer::SetupFullScreenQuad() {
 
 void Renderer::CleanupFullScreenQuad() {
 	if (_quadVAO != 0) {
-		glDeleteVertexArrays(1, &_quadVAO);
+		GLStateCache::Get().DeleteVertexArrays(1, &_quadVAO);
 		_quadVAO = 0;
 	}
 	if (_quadVBO != 0) {
@@ -258,26 +628,12 @@ void Renderer::CleanupFullScreenQuad() {
 	_colorShader = nullptr;
 }
 
-Renderer::OpenGLState Renderer::SaveOpenGLState() {
-	OpenGLState state;
-	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &state.framebuffer);
-	glGetIntegerv(GL_ACTIVE_TEXTURE, &state.activeTexture);
-	glActiveTexture(GL_TEXTURE0);
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &state.texture2D);
-	return state;
-}
-
-void Renderer::RestoreOpenGLState(const OpenGLState& state) {
-	if (state.framebuffer != 0)
-		glBindFramebuffer(GL_FRAMEBUFFER, state.framebuffer);
-	if (state.texture2D != 0)
-		glBindTexture(GL_TEXTURE_2D, state.texture2D);
-	if (state.activeTexture != 0)
-		glActiveTexture(state.activeTexture);
+void Renderer::RenderDepthVisualization(float nearPlane, float farPlane) {
+	RenderDepthVisualization(_depthTexture, nearPlane, farPlane);
 }
 
-void Renderer::RenderDepthVisualization(float nearPlane, float farPlane) {
-	if (_depthTexture == 0) {
+void Renderer::RenderDepthVisualization(GLuint depthTexture, float nearPlane, float farPlane) {
+	if (depthTexture == 0) {
 		LOG_ERROR("Cannot render depth visualization: depth texture not available");
 		return;
 	}
@@ -292,52 +648,39 @@ void Renderer::RenderDepthVisualization(float nearPlane, float farPlane) {
 		return;
 	}
 	
-	// Save current OpenGL state
-	GLint previousVAO, previousTexture, previousActiveTexture, previousProgram, previousArrayBuffer;
-	GLboolean depthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
-	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVAO);
-	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
-	glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActiveTexture);
-	glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousArrayBuffer);
-	glActiveTexture(GL_TEXTURE0);
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	// Saved from the shadow state, no driver round trip
+	GLStateCache& state = GLStateCache::Get();
+	GLStateSnapshot savedState = state.Save();
 	
 	// Disable depth testing for full-screen quad
-	glDisable(GL_DEPTH_TEST);
+	state.Disable(GL_DEPTH_TEST);
 	
 	// Bind depth shader
 	_depthShader->ReloadIfChanged();
 	_depthShader->Bind();
 	
 	// Set uniforms
-	glUniform1f(glGetUniformLocation(_depthShader->GetID(), "nearPlane"), nearPlane);
-	glUniform1f(glGetUniformLocation(_depthShader->GetID(), "farPlane"), farPlane);
+	glUniform1f(_depthShader->GetUniformLocation(NearPlaneUniform), nearPlane);
+	glUniform1f(_depthShader->GetUniformLocation(FarPlaneUniform), farPlane);
 	
 	// Bind depth texture
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, _depthTexture);
-	glUniform1i(glGetUniformLocation(_depthShader->GetID(), "depthTexture"), 0);
+	state.BindTexture(0, GL_TEXTURE_2D, depthTexture);
+	glUniform1i(_depthShader->GetUniformLocation(DepthTextureUniform), 0);
 	
 	// Render full-screen quad
-	glBindVertexArray(_quadVAO);
+	state.BindVertexArray(_quadVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 	
-	// Restore previous OpenGL state completely
-	glUseProgram(previousProgram);
-	glBindVertexArray(previousVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, previousArrayBuffer);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, previousTexture);
-	glActiveTexture(previousActiveTexture);
-	
-	// Restore depth testing state
-	if (depthTestEnabled) {
-		glEnable(GL_DEPTH_TEST);
-	}
+	// Only what the pass changed is issued
+	state.Restore(savedState);
 }
 
 void Renderer::RenderColorVisualization() {
-	if (_colorTexture == 0) {
+	RenderColorVisualization(_colorTexture);
+}
+
+void Renderer::RenderColorVisualization(GLuint colorTexture) {
+	if (colorTexture == 0) {
 		LOG_ERROR("Cannot render color visualization: color texture not available");
 		return;
 	}
@@ -352,42 +695,25 @@ void Renderer::RenderColorVisualization() {
 		return;
 	}
 	
-	// Save current OpenGL state
-	GLint previousVAO, previousTexture, previousActiveTexture, previousProgram, previousArrayBuffer;
-	GLboolean depthTestEnabled = glIsEnabled(GL_DEPTH_TEST);
-	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVAO);
-	glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
-	glGetIntegerv(GL_ACTIVE_TEXTURE, &previousActiveTexture);
-	glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousArrayBuffer);
-	glActiveTexture(GL_TEXTURE0);
-	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+	// Saved from the shadow state, no driver round trip
+	GLStateCache& state = GLStateCache::Get();
+	GLStateSnapshot savedState = state.Save();
 	
 	// Disable depth testing for full-screen quad
-	glDisable(GL_DEPTH_TEST);
+	state.Disable(GL_DEPTH_TEST);
 	
 	// Bind color shader
 	_colorShader->ReloadIfChanged();
 	_colorShader->Bind();
 	
 	// Bind color texture
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, _colorTexture);
-	glUniform1i(glGetUniformLocation(_colorShader->GetID(), "colorTexture"), 0);
+	state.BindTexture(0, GL_TEXTURE_2D, colorTexture);
+	glUniform1i(_colorShader->GetUniformLocation(ColorTextureUniform), 0);
 	
 	// Render full-screen quad
-	glBindVertexArray(_quadVAO);
+	state.BindVertexArray(_quadVAO);
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 	
-	// Restore previous OpenGL state completely
-	glUseProgram(previousProgram);
-	glBindVertexArray(previousVAO);
-	glBindBuffer(GL_ARRAY_BUFFER, previousArrayBuffer);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, previousTexture);
-	glActiveTexture(previousActiveTexture);
-	
-	// Restore depth testing state
-	if (depthTestEnabled) {
-		glEnable(GL_DEPTH_TEST);
-	}
+	// Only what the pass changed is issued
+	state.Restore(savedState);
 }
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include "graphics/Shader.h"
+#include "graphics/GLStateCache.h"
 #include "core/Common.h"
+#include "core/CpuProfiler.h"
+
+#include <algorithm>
 
 using namespace stereorizer::graphics;
 
@@ -8,26 +12,24 @@ Shader::Shader(const std::string& filepath)
 	_filePath = filepath;
 	_lastWriteTime = GetLastWriteTime();
 
-	ShaderProgramSource source = ParseShader(filepath);
-	_rendererID = CreateShader(source.VertexSource, source.FragmentSource);
+	_source = ParseShader(filepath);
+	ActivateVariant();
 }
 
 Shader::Shader(const std::string& filepath, const std::unordered_map<std::string, std::string>& defines)
 {
 	_filePath = filepath;
 	_defines = defines;
+	UpdateVariantKey();
 	_lastWriteTime = GetLastWriteTime();
 
-	ShaderProgramSource source = ParseShader(filepath);
-	// Inject defines into both vertex and fragment shaders
-	source.VertexSource = InjectDefines(source.VertexSource);
-	source.FragmentSource = InjectDefines(source.FragmentSource);
-	_rendererID = CreateShader(source.VertexSource, source.FragmentSource);
+	_source = ParseShader(filepath);
+	ActivateVariant();
 }
 
 Shader::~Shader()
 {
-	glDeleteProgram(_rendererID);
+	InvalidateVariants();
 }
 
 Shader::Shader(Shader&& other) noexcept
@@ -36,56 +38,87 @@ Shader::Shader(Shader&& other) noexcept
 	_filePath = std::move(other._filePath);
 	_lastWriteTime = other._lastWriteTime;
 	_defines = std::move(other._defines);
+	_variantKey = std::move(other._variantKey);
+	_variantKeyChanged = other._variantKeyChanged;
+	_source = std::move(other._source);
+	_variants = std::move(other._variants);
+	_activeVariant = other._activeVariant;
 
 	other._rendererID = 0;
+	other._variants.clear();
+	other._activeVariant = nullptr;
 }
 
 Shader& Shader::operator=(Shader&& other) noexcept
 {
 	if (this != &other) {
-		glDeleteProgram(_rendererID);
+		InvalidateVariants();
 		_rendererID = other._rendererID;
 		_filePath = std::move(other._filePath);
 		_lastWriteTime = other._lastWriteTime;
 		_defines = std::move(other._defines);
+		_variantKey = std::move(other._variantKey);
+		_variantKeyChanged = other._variantKeyChanged;
+		_source = std::move(other._source);
+		_variants = std::move(other._variants);
+		_activeVariant = other._activeVariant;
 
 		other._rendererID = 0;
+		other._variants.clear();
+		other._activeVariant = nullptr;
 	}
 	return *this;
 }
 
 void Shader::Bind() const
 {
-	glUseProgram(_rendererID);
+	GLStateCache::Get().UseProgram(_rendererID);
 }
 
 void Shader::Unbind() const
 {
-	glUseProgram(0);
+	GLStateCache::Get().UseProgram(0);
+}
+
+GLint Shader::GetUniformLocation(UniformId id) const
+{
+	if (!_activeVariant)
+		return -1;
+
+	auto it = _activeVariant->uniforms.find(id.hash);
+	return it != _activeVariant->uniforms.end() ? it->second : -1;
+}
+
+bool Shader::HasUniformBlock(UniformId id) const
+{
+	return _activeVariant && _activeVariant->uniformBlocks.count(id.hash) != 0;
 }
 
 bool Shader::ReloadIfChanged()
 {
 	fs::file_time_type currentWriteTime = GetLastWriteTime();
 	if (currentWriteTime != _lastWriteTime) {
+		PROFILE_SCOPE("Shader::ReloadIfChanged");
 		_lastWriteTime = currentWriteTime;
-	LOG_INFO("Reloading shader...");
-
-		ShaderProgramSource newSource = ParseShader(_filePath);
-		// Inject defines if they exist
-		if (!_defines.empty()) {
-			newSource.VertexSource = InjectDefines(newSource.VertexSource);
-			newSource.FragmentSource = InjectDefines(newSource.FragmentSource);
-		}
-		unsigned int newShader = CreateShader(newSource.VertexSource, newSource.FragmentSource);
-		if (newShader != 0) {
-			glDeleteProgram(_rendererID);
-			_rendererID = newShader;
-			glUseProgram(_rendererID);
-			return true;
-		}
-		else
+		LOG_INFO("Reloading shader...");
+
+		// Build the active variant from the new source first so a broken edit
+		// keeps the old programs alive. On success every variant built from the
+		// old source is dropped; the rest are recompiled lazily on first use.
+		ShaderProgramSource previousSource = std::move(_source);
+		_source = ParseShader(_filePath);
+		GLuint newShader = CompileVariant();
+		if (newShader == 0) {
+			_source = std::move(previousSource);
 			return false;
+		}
+
+		InvalidateVariants();
+		ShaderVariant& variant = _variants[_variantKey];
+		variant.program = newShader;
+		ReflectUniforms(variant);
+		SetActiveVariant(variant);
+		return true;
 	}
 	else
 		return false;
@@ -106,7 +139,7 @@ GLuint Shader::CompileShader(const std::string& source, GLenum type)
 		glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
 	std::vector<char> message(length);
 	glGetShaderInfoLog(id, length, nullptr, message.data());
-	LOG_ERROR(std::string("Failed to compile ") + (type == GL_VERTEX_SHADER ? "vertex" : "fragment") + " shader!");
+	LOG_ERROR(std::string("Failed to compile ") + (type == GL_VERTEX_SHADER ? "vertex" : type == GL_COMPUTE_SHADER ? "compute" : "fragment") + " shader!");
 	LOG_ERROR(std::string(message.data()));
 	}
 
@@ -127,6 +160,38 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
 	glDeleteShader(vs);
 	glDeleteShader(fs);
 
+	return CheckLinkStatus(program);
+}
+
+GLuint Shader::CreateComputeShader(const std::string& computeShader)
+{
+	GLuint program = glCreateProgram();
+	GLuint cs = CompileShader(computeShader, GL_COMPUTE_SHADER);
+
+	glAttachShader(program, cs);
+	glLinkProgram(program);
+
+	glDeleteShader(cs);
+
+	return CheckLinkStatus(program);
+}
+
+GLuint Shader::CheckLinkStatus(GLuint program)
+{
+	int linked;
+	glGetProgramiv(program, GL_LINK_STATUS, &linked);
+	if (linked == GL_FALSE)
+	{
+		int length;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+		std::vector<char> message(length + 1, '\0');
+		glGetProgramInfoLog(program, length, nullptr, message.data());
+		LOG_ERROR(std::string("Failed to link shader program: ") + _filePath);
+		LOG_ERROR(std::string(message.data()));
+		glDeleteProgram(program);
+		return 0;
+	}
+
 	return program;
 }
 
@@ -137,11 +202,12 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
 	enum class ShaderType {
 		NONE = -1,
 		VERTEX = 0,
-		FRAGMENT = 1
+		FRAGMENT = 1,
+		COMPUTE = 2
 	};
 
 	std::string line;
-	std::stringstream ss[2];
+	std::stringstream ss[3];
 	ShaderType type = ShaderType::NONE;
 	while (std::getline(stream, line))
 	{
@@ -151,13 +217,15 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
 				type = ShaderType::VERTEX;
 			if (line.find("fragment") != std::string::npos)
 				type = ShaderType::FRAGMENT;
+			if (line.find("compute") != std::string::npos)
+				type = ShaderType::COMPUTE;
 		}
 		else {
 			ss[(int)type] << line << "\n";
 		}
 	}
 
-	return { ss[0].str(), ss[1].str() };
+	return { ss[0].str(), ss[1].str(), ss[2].str() };
 }
 
 fs::file_time_type Shader::GetLastWriteTime()
@@ -220,7 +288,12 @@ std::string Shader::InjectDefines(const std::string& source)
 
 void Shader::EnableDefine(const std::string& name, const std::string& value)
 {
+	// Techniques set every define each frame, only an actual change rebuilds the key
+	auto it = _defines.find(name);
+	if (it != _defines.end() && it->second == value)
+		return;
 	_defines[name] = value;
+	UpdateVariantKey();
 }
 
 void Shader::DisableDefine(const std::string& name)
@@ -228,6 +301,7 @@ void Shader::DisableDefine(const std::string& name)
 	auto it = _defines.find(name);
 	if (it != _defines.end()) {
 		_defines.erase(it);
+		UpdateVariantKey();
 	}
 }
 
@@ -239,26 +313,157 @@ bool Shader::HasDefine(const std::string& name) const
 void Shader::ClearAllDefines()
 {
 	_defines.clear();
+	UpdateVariantKey();
 }
 
 bool Shader::RecompileWithDefines()
 {
-	ShaderProgramSource source = ParseShader(_filePath);
-	// Apply defines if they exist
-	if (!_defines.empty()) {
-		source.VertexSource = InjectDefines(source.VertexSource);
-		source.FragmentSource = InjectDefines(source.FragmentSource);
-	}
+	// Forces a rebuild of the current variant from disk, bypassing the cache
+	_source = ParseShader(_filePath);
 
-	unsigned int newShader = CreateShader(source.VertexSource, source.FragmentSource);
-	if (newShader != 0) {
-		glDeleteProgram(_rendererID);
-		_rendererID = newShader;
-		glUseProgram(_rendererID);
-		return true;
+	auto it = _variants.find(_variantKey);
+	if (it != _variants.end()) {
+		glDeleteProgram(it->second.program);
+		_variants.erase(it);
 	}
-	else {
+	_rendererID = 0;
+	_activeVariant = nullptr;
+
+	if (!ActivateVariant()) {
 		LOG_ERROR("Failed to recompile shader with defines");
 		return false;
 	}
+	return true;
+}
+
+bool Shader::ActivateVariant()
+{
+	if (_activeVariant && !_variantKeyChanged) {
+		SetActiveVariant(*_activeVariant);
+		return true;
+	}
+
+	auto it = _variants.find(_variantKey);
+	if (it == _variants.end()) {
+		GLuint program = CompileVariant();
+		if (program == 0)
+			return false;
+		it = _variants.emplace(_variantKey, ShaderVariant{ program, {}, {} }).first;
+		ReflectUniforms(it->second);
+	}
+
+	SetActiveVariant(it->second);
+	_variantKeyChanged = false;
+	return true;
+}
+
+void Shader::SetActiveVariant(const ShaderVariant& variant)
+{
+	_activeVariant = &variant;
+	_rendererID = variant.program;
+	GLStateCache::Get().UseProgram(_rendererID);
+}
+
+void Shader::InvalidateVariants()
+{
+	for (auto& variant : _variants) {
+		glDeleteProgram(variant.second.program);
+	}
+	_variants.clear();
+	_rendererID = 0;
+	_activeVariant = nullptr;
+}
+
+void Shader::ReflectUniforms(ShaderVariant& variant) const
+{
+	variant.uniforms.clear();
+	variant.uniformBlocks.clear();
+
+	// Lookups only carry the 32-bit hash, two names sharing one would silently read the same slot
+	std::unordered_map<uint32_t, std::string> names;
+	auto checkCollision = [&](const char* name, uint32_t hash) {
+		auto [it, inserted] = names.emplace(hash, name);
+		if (!inserted && it->second != name)
+			LOG_ERROR("Uniform names \"" + it->second + "\" and \"" + name + "\" share the hash " + std::to_string(hash) + " in " + _filePath + ", rename one");
+	};
+
+	GLint blockCount = 0;
+	GLint maxBlockNameLength = 0;
+	glGetProgramiv(variant.program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+	glGetProgramiv(variant.program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+
+	std::vector<char> blockName(maxBlockNameLength + 1, '\0');
+	for (GLint i = 0; i < blockCount; i++) {
+		glGetActiveUniformBlockName(variant.program, (GLuint)i, (GLsizei)blockName.size(), nullptr, blockName.data());
+		UniformId id(blockName.data());
+		checkCollision(blockName.data(), id.hash);
+		variant.uniformBlocks[id.hash] = (GLuint)i;
+	}
+
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+	glGetProgramiv(variant.program, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(variant.program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	std::vector<char> name(maxNameLength + 1, '\0');
+	for (GLint i = 0; i < uniformCount; i++) {
+		GLsizei length = 0;
+		GLint size = 0;
+		GLenum type = 0;
+		glGetActiveUniform(variant.program, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+		// Uniforms inside blocks report -1 and are not set through glUniform*
+		GLint location = glGetUniformLocation(variant.program, name.data());
+		if (location == -1)
+			continue;
+
+		UniformId id(name.data());
+		checkCollision(name.data(), id.hash);
+		variant.uniforms[id.hash] = location;
+
+		// Arrays are reported as "name[0]", also register the bare name like glGetUniformLocation does
+		std::string uniformName(name.data(), length);
+		if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0) {
+			uniformName.resize(uniformName.size() - 3);
+			UniformId bareId(uniformName.c_str());
+			checkCollision(uniformName.c_str(), bareId.hash);
+			variant.uniforms[bareId.hash] = location;
+		}
+	}
+}
+
+void Shader::UpdateVariantKey()
+{
+	// _defines is unordered, so sort by name to make the key independent of insertion order
+	_variantKey.assign(_defines.begin(), _defines.end());
+	std::sort(_variantKey.begin(), _variantKey.end());
+	_variantKeyChanged = true;
+}
+
+size_t ShaderVariantKeyHash::operator()(const ShaderVariantKey& key) const noexcept
+{
+	std::hash<std::string> hasher;
+	size_t hash = key.size();
+	for (const auto& define : key) {
+		hash ^= hasher(define.first) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+		hash ^= hasher(define.second) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+	}
+	return hash;
+}
+
+GLuint Shader::CompileVariant()
+{
+	PROFILE_SCOPE("Shader::CompileVariant");
+	if (!_source.ComputeSource.empty())
+		return CreateComputeShader(InjectDefines(_source.ComputeSource));
+
+	std::string vertexSource = _source.VertexSource;
+	std::string fragmentSource = _source.FragmentSource;
+	// Apply defines if they exist
+	if (!_defines.empty()) {
+		vertexSource = InjectDefines(vertexSource);
+		fragmentSource = InjectDefines(fragmentSource);
+	}
+
+	return CreateShader(vertexSource, fragmentSource);
 }
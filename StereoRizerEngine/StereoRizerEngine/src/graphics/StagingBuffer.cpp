@@ -0,0 +1,150 @@
+#include "graphics/StagingBuffer.h"
+#include "core/Common.h"
+
+#include <cstring>
+
+using namespace stereorizer::graphics;
+
+namespace
+{
+	size_t AlignUp(size_t value) {
+		return (value + StagingBuffer::Alignment - 1) / StagingBuffer::Alignment * StagingBuffer::Alignment;
+	}
+}
+
+StagingBuffer::~StagingBuffer() {
+	Destroy();
+}
+
+bool StagingBuffer::Create(size_t size) {
+	Destroy();
+
+	_size = AlignUp(size);
+	glGenBuffers(1, &_buffer);
+	glBindBuffer(GL_COPY_READ_BUFFER, _buffer);
+	// Coherent, the CPU writes are visible to copies issued after them without a flush
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glBufferStorage(GL_COPY_READ_BUFFER, _size, nullptr, flags);
+	_mapped = (uint8_t*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, _size, flags);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	if (!_mapped) {
+		LOG_ERROR("Failed to map the staging buffer");
+		Destroy();
+		return false;
+	}
+	return true;
+}
+
+void StagingBuffer::Destroy() {
+	for (auto& batch : _batches) {
+		if (batch.fence)
+			glDeleteSync(batch.fence);
+	}
+	_batches.clear();
+	if (_buffer) {
+		// Deleting a buffer unmaps it
+		glDeleteBuffers(1, &_buffer);
+		_buffer = 0;
+	}
+	_mapped = nullptr;
+	_size = 0;
+	_head = 0;
+	_tail = 0;
+	_empty = true;
+	_unfenced = false;
+}
+
+size_t StagingBuffer::FindBlock(size_t size) const {
+	if (size > _size)
+		return SIZE_MAX;
+	if (_empty)
+		return 0;
+	if (_head > _tail) {
+		if (size <= _size - _head)
+			return _head;
+		// Wrap, the end of the ring stays unused until the tail passes it
+		if (size <= _tail)
+			return 0;
+		return SIZE_MAX;
+	}
+	if (_head < _tail && size <= _tail - _head)
+		return _head;
+	return SIZE_MAX;
+}
+
+void StagingBuffer::Retire(bool wait) {
+	while (!_batches.empty()) {
+		Batch& batch = _batches.front();
+		GLenum status = glClientWaitSync(batch.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? 1000000 : 0); // 1 ms
+		if (status == GL_TIMEOUT_EXPIRED) {
+			if (!wait)
+				return;
+			continue;
+		}
+		if (status == GL_WAIT_FAILED)
+			LOG_ERROR("Waiting for a staging fence failed");
+		glDeleteSync(batch.fence);
+		_tail = batch.end;
+		_batches.pop_front();
+		// Only one batch gets waited for, the caller checks whether that made room
+		wait = false;
+	}
+	if (!_unfenced) {
+		_empty = true;
+		_head = 0;
+		_tail = 0;
+	}
+}
+
+bool StagingBuffer::CanStage(size_t size, bool wait) {
+	if (!IsValid())
+		return false;
+	size = AlignUp(size);
+	Retire(false);
+	while (FindBlock(size) == SIZE_MAX) {
+		if (!wait || _batches.empty())
+			return false;
+		Retire(true);
+	}
+	return true;
+}
+
+bool StagingBuffer::Stage(std::initializer_list<StagingCopy> copies) {
+	size_t total = 0;
+	for (const StagingCopy& copy : copies)
+		total += AlignUp(copy.size);
+	if (total == 0)
+		return true;
+	size_t offset = IsValid() ? FindBlock(total) : SIZE_MAX;
+	if (offset == SIZE_MAX)
+		return false;
+
+	glBindBuffer(GL_COPY_READ_BUFFER, _buffer);
+	size_t blockOffset = offset;
+	for (const StagingCopy& copy : copies) {
+		if (copy.size == 0)
+			continue;
+		std::memcpy(_mapped + blockOffset, copy.data, copy.size);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, copy.buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, blockOffset, copy.bufferOffset, copy.size);
+		blockOffset += AlignUp(copy.size);
+		_stagedBytes += copy.size;
+	}
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	_head = offset + total;
+	if (_head == _size)
+		_head = 0;
+	_empty = false;
+	_unfenced = true;
+	return true;
+}
+
+void StagingBuffer::Fence() {
+	if (!_unfenced)
+		return;
+	_batches.push_back({ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), _head });
+	_unfenced = false;
+}
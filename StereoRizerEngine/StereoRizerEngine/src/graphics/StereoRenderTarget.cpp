@@ -0,0 +1,201 @@
+#include "graphics/StereoRenderTarget.h"
+#include "graphics/GLStateCache.h"
+#include "core/Common.h"
+
+#include <stdexcept>
+#include <string>
+
+using namespace stereorizer::graphics;
+
+StereoRenderTarget::StereoRenderTarget() {
+	// GL objects are created on demand in Begin(), the context might not be ready yet
+}
+
+StereoRenderTarget::~StereoRenderTarget() {
+	Cleanup();
+}
+
+bool StereoRenderTarget::IsMultiviewSupported() {
+	return GLEW_OVR_multiview && GLEW_OVR_multiview2;
+}
+
+bool StereoRenderTarget::IsVertexLayerSupported() {
+	return GLEW_ARB_shader_viewport_layer_array;
+}
+
+void StereoRenderTarget::Setup(int width, int height) {
+	_width = width;
+	_height = height;
+	Cleanup();
+}
+
+void StereoRenderTarget::SetLayout(StereoLayout layout) {
+	if (_layout == layout) return;
+	_layout = layout;
+	Cleanup();
+}
+
+void StereoRenderTarget::CreateTextures() {
+	// Immutable storage is required for glTextureView
+	glGenTextures(1, &_colorArray);
+	GLStateCache::Get().BindTexture(GL_TEXTURE_2D_ARRAY, _colorArray);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, _width, _height, ViewCount);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glGenTextures(1, &_depthArray);
+	GLStateCache::Get().BindTexture(GL_TEXTURE_2D_ARRAY, _depthArray);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT24, _width, _height, ViewCount);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+	GLStateCache::Get().BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// Per-layer 2D views so the visualization and reprojection shaders can keep using sampler2D
+	glGenTextures(ViewCount, _colorViews);
+	glGenTextures(ViewCount, _depthViews);
+	for (int view = 0; view < ViewCount; view++) {
+		glTextureView(_colorViews[view], GL_TEXTURE_2D, _colorArray, GL_RGBA8, 0, 1, view, 1);
+		glTextureParameteri(_colorViews[view], GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTextureParameteri(_colorViews[view], GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTextureParameteri(_colorViews[view], GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(_colorViews[view], GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glTextureView(_depthViews[view], GL_TEXTURE_2D, _depthArray, GL_DEPTH_COMPONENT24, 0, 1, view, 1);
+		glTextureParameteri(_depthViews[view], GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTextureParameteri(_depthViews[view], GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTextureParameteri(_depthViews[view], GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(_depthViews[view], GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(_depthViews[view], GL_TEXTURE_COMPARE_MODE, GL_NONE);
+	}
+}
+
+void StereoRenderTarget::CreateSideBySideTextures() {
+	glGenTextures(1, &_sideBySideColor);
+	GLStateCache::Get().BindTexture(GL_TEXTURE_2D, _sideBySideColor);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, _width * ViewCount, _height);
+
+	glGenTextures(1, &_sideBySideDepth);
+	GLStateCache::Get().BindTexture(GL_TEXTURE_2D, _sideBySideDepth);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, _width * ViewCount, _height);
+	GLStateCache::Get().BindTexture(GL_TEXTURE_2D, 0);
+}
+
+void StereoRenderTarget::CreateFramebuffer() {
+	if (_layout == StereoLayout::Multiview && !IsMultiviewSupported())
+		throw std::runtime_error("GL_OVR_multiview2 is not supported by the current driver");
+	if (_layout == StereoLayout::Layered && !IsVertexLayerSupported())
+		throw std::runtime_error("GL_ARB_shader_viewport_layer_array is not supported by the current driver");
+
+	CreateTextures();
+
+	glGenFramebuffers(1, &_framebuffer);
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	switch (_layout) {
+	case StereoLayout::Multiview:
+		glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, _colorArray, 0, 0, ViewCount);
+		glFramebufferTextureMultiviewOVR(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _depthArray, 0, 0, ViewCount);
+		break;
+	case StereoLayout::Layered:
+		// Attaching the whole array makes the framebuffer layered, gl_Layer selects the eye
+		glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, _colorArray, 0);
+		glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, _depthArray, 0);
+		break;
+	case StereoLayout::SideBySide:
+		CreateSideBySideTextures();
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _sideBySideColor, 0);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, _sideBySideDepth, 0);
+		break;
+	}
+
+	GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0 };
+	glDrawBuffers(1, drawBuffers);
+
+	GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		Cleanup();
+		throw std::runtime_error("Stereo framebuffer not complete! Status: " + std::to_string(status));
+	}
+
+	LOG_INFO("Stereo framebuffer created successfully");
+	LOG_INFO("Framebuffer size: " + std::to_string(_width) + "x" + std::to_string(_height) + " x " + std::to_string(ViewCount) + " views");
+}
+
+bool StereoRenderTarget::Begin() {
+	if (_width == 0 || _height == 0) return false;
+
+	_previousFramebuffer = GLStateCache::Get().GetDrawFramebuffer();
+
+	if (_framebuffer == 0) {
+		try {
+			CreateFramebuffer();
+		} catch (const std::runtime_error& e) {
+			LOG_ERROR(e.what());
+			return false;
+		}
+	}
+
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+	if (_layout == StereoLayout::SideBySide)
+		GLStateCache::Get().Viewport(0, 0, _width * ViewCount, _height);
+	else
+		GLStateCache::Get().Viewport(0, 0, _width, _height);
+
+	GLStateCache::Get().Enable(GL_DEPTH_TEST);
+	glDepthMask(GL_TRUE);
+	glDepthFunc(GL_LESS);
+
+	// Clears every layer of the attachments
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	return true;
+}
+
+void StereoRenderTarget::End() {
+	GLStateCache::Get().BindFramebuffer(GL_FRAMEBUFFER, _previousFramebuffer);
+
+	if (_layout == StereoLayout::SideBySide && _framebuffer != 0) {
+		// Move each half into its layer so consumers see the same layout on every path
+		for (int view = 0; view < ViewCount; view++) {
+			glCopyImageSubData(_sideBySideColor, GL_TEXTURE_2D, 0, view * _width, 0, 0,
+				_colorArray, GL_TEXTURE_2D_ARRAY, 0, 0, 0, view, _width, _height, 1);
+			glCopyImageSubData(_sideBySideDepth, GL_TEXTURE_2D, 0, view * _width, 0, 0,
+				_depthArray, GL_TEXTURE_2D_ARRAY, 0, 0, 0, view, _width, _height, 1);
+		}
+	}
+}
+
+void StereoRenderTarget::Cleanup() {
+	if (_framebuffer != 0) {
+		GLStateCache::Get().DeleteFramebuffers(1, &_framebuffer);
+		_framebuffer = 0;
+	}
+	if (_colorViews[0] != 0) {
+		GLStateCache::Get().DeleteTextures(ViewCount, _colorViews);
+		_colorViews[0] = _colorViews[1] = 0;
+	}
+	if (_depthViews[0] != 0) {
+		GLStateCache::Get().DeleteTextures(ViewCount, _depthViews);
+		_depthViews[0] = _depthViews[1] = 0;
+	}
+	if (_colorArray != 0) {
+		GLStateCache::Get().DeleteTextures(1, &_colorArray);
+		_colorArray = 0;
+	}
+	if (_depthArray != 0) {
+		GLStateCache::Get().DeleteTextures(1, &_depthArray);
+		_depthArray = 0;
+	}
+	if (_sideBySideColor != 0) {
+		GLStateCache::Get().DeleteTextures(1, &_sideBySideColor);
+		_sideBySideColor = 0;
+	}
+	if (_sideBySideDepth != 0) {
+		GLStateCache::Get().DeleteTextures(1, &_sideBySideDepth);
+		_sideBySideDepth = 0;
+	}
+}
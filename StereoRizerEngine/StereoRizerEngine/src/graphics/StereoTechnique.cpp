@@ -0,0 +1,85 @@
+#include "graphics/StereoTechnique.h"
+#include "core/Common.h"
+
+using namespace stereorizer::graphics;
+
+IStereoTechnique::~IStereoTechnique() {
+	for (auto& pair : _timerQueries) {
+		if (pair[0] != 0)
+			glDeleteQueries(2, pair);
+	}
+}
+
+void IStereoTechnique::CollectTimer(int index) {
+	if (!_timerPending[index])
+		return;
+
+	// Only the end stamp has to be checked, queries complete in order
+	GLint available = GL_FALSE;
+	glGetQueryObjectiv(_timerQueries[index][1], GL_QUERY_RESULT_AVAILABLE, &available);
+	_timerPending[index] = false;
+	if (!available)
+		return;
+
+	GLuint64 begin = 0, end = 0;
+	glGetQueryObjectui64v(_timerQueries[index][0], GL_QUERY_RESULT, &begin);
+	glGetQueryObjectui64v(_timerQueries[index][1], GL_QUERY_RESULT, &end);
+	_stats.gpuMs = (double)(end - begin) / 1.0e6;
+	_stats.gpuRender = _timerRender[index];
+}
+
+void IStereoTechnique::Render(const StereoScene& scene, Renderer& leftView, Renderer& rightView, StereoTargets& targets) {
+	SelectVariants(scene.models);
+	_queue.Record(scene.models, *leftView.GetCamera(), *rightView.GetCamera(), UsesDepthPrepass());
+
+	// Timestamps rather than GL_TIME_ELAPSED, passes inside may run their own elapsed query
+	_timerIndex = (_timerIndex + 1) % TimerLatency;
+	GLuint* queries = _timerQueries[_timerIndex];
+	if (queries[0] == 0)
+		glGenQueries(2, queries);
+	CollectTimer(_timerIndex);
+
+	glQueryCounter(queries[0], GL_TIMESTAMP);
+	RenderViews(scene, leftView, rightView, targets);
+	glQueryCounter(queries[1], GL_TIMESTAMP);
+	_timerRender[_timerIndex] = ++_renderCount;
+	_timerPending[_timerIndex] = true;
+}
+
+StereoTechniqueRegistry& StereoTechniqueRegistry::Get() {
+	static StereoTechniqueRegistry registry;
+	static bool builtInsRegistered = false;
+	if (!builtInsRegistered) {
+		builtInsRegistered = true;
+		RegisterBuiltInStereoTechniques(registry);
+	}
+	return registry;
+}
+
+void StereoTechniqueRegistry::Register(const std::string& name, const std::string& description, StereoTechniqueFactory factory) {
+	for (auto& entry : _entries) {
+		if (entry.name == name) {
+			entry.description = description;
+			entry.factory = std::move(factory);
+			return;
+		}
+	}
+	_entries.push_back({ name, description, std::move(factory) });
+}
+
+bool StereoTechniqueRegistry::Contains(const std::string& name) const {
+	for (const auto& entry : _entries) {
+		if (entry.name == name)
+			return true;
+	}
+	return false;
+}
+
+std::unique_ptr<IStereoTechnique> StereoTechniqueRegistry::Create(const std::string& name) const {
+	for (const auto& entry : _entries) {
+		if (entry.name == name)
+			return entry.factory();
+	}
+	LOG_ERROR("Unknown stereo technique: " + name);
+	return nullptr;
+}
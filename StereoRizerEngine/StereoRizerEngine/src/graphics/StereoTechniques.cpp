@@ -0,0 +1,262 @@
+#include "graphics/StereoTechniques.h"
+#include "graphics/GLStateCache.h"
+#include "core/Common.h"
+#include "core/CpuProfiler.h"
+
+#include <algorithm>
+#include <imgui.h>
+
+using namespace stereorizer::graphics;
+
+namespace
+{
+	constexpr UniformId LeftDepthTextureUniform("leftDepthTexture");
+	constexpr UniformId LeftColorTextureUniform("leftColorTexture");
+
+	// Must match ReprojectionMaskCounters in PhongDiffuseOnly.shader
+	constexpr GLuint MaskCounterBinding = 1;
+
+	enum class StereoVariant {
+		None,
+		Reprojection,
+		Multiview,
+		Instanced,
+		InstancedLayer
+	};
+
+	// Every model's shader is shared state, so each technique sets all stereo defines, never relying on the previous one
+	void SelectVariant(const std::vector<std::shared_ptr<Model>>& models, StereoVariant variant) {
+		for (const auto& model : models) {
+			if (!model)
+				continue;
+			auto shader = model->GetShader();
+			auto setDefine = [&](const char* name, bool enabled) {
+				if (enabled)
+					shader->EnableDefine(name);
+				else
+					shader->DisableDefine(name);
+			};
+			setDefine("USE_REPROJECTION", variant == StereoVariant::Reprojection);
+			setDefine("USE_MULTIVIEW", variant == StereoVariant::Multiview);
+			setDefine("USE_INSTANCED_STEREO", variant == StereoVariant::Instanced || variant == StereoVariant::InstancedLayer);
+			setDefine("USE_STEREO_LAYER", variant == StereoVariant::InstancedLayer);
+			shader->ActivateVariant();
+		}
+	}
+
+	void DrawLeftPyramidStats(Renderer& leftView) {
+		const DepthPyramid& pyramid = leftView.GetDepthPyramid();
+		ImGui::Text("Left Hi-Z build: %.3f ms (budget %.2f ms)%s", pyramid.GetLastBuildTimeMs(), DepthPyramid::BuildBudgetMs,
+			pyramid.IsOverBudget() ? ", suspended" : "");
+	}
+}
+
+void TwoPassTechnique::SelectVariants(const std::vector<std::shared_ptr<Model>>& models) {
+	SelectVariant(models, StereoVariant::None);
+}
+
+void TwoPassTechnique::RenderViews(const StereoScene& scene, Renderer& leftView, Renderer& rightView, StereoTargets& targets) {
+	(void)scene;
+	{
+		PROFILE_SCOPE("Left");
+		leftView.SetDepthPyramidEnabled(UsesLeftDepthPyramid());
+
+		GpuScope scope(_profiler, "Left RenderToTextures");
+		leftView.RenderToTextures(_queue);
+	}
+
+	// The right eye samples the left targets through the same context, the GL
+	// orders the FBO writes before those reads without a CPU round trip
+	{
+		PROFILE_SCOPE("Right");
+		rightView.SetReprojectionPyramid(UsesLeftDepthPyramid() ? &leftView.GetDepthPyramid() : nullptr);
+
+		GpuScope scope(_profiler, "Right RenderToTextures");
+		RenderRightEye(leftView, rightView);
+	}
+
+	targets.colorTextures[0] = leftView.GetColorTexture();
+	targets.depthTextures[0] = leftView.GetDepthTexture();
+	targets.colorTextures[1] = rightView.GetColorTexture();
+	targets.depthTextures[1] = rightView.GetDepthTexture();
+}
+
+void TwoPassTechnique::RenderRightEye(Renderer& leftView, Renderer& rightView) {
+	(void)leftView;
+	rightView.RenderToTextures(_queue);
+	_stats.pixelReuse = 0.0f;
+}
+
+ReprojectionMaskTechnique::~ReprojectionMaskTechnique() {
+	if (_countersFence)
+		glDeleteSync(_countersFence);
+	if (_counterBuffer != 0)
+		glDeleteBuffers(1, &_counterBuffer);
+}
+
+void ReprojectionMaskTechnique::ReadCounters() {
+	if (!_countersFence)
+		return;
+
+	GLenum status = glClientWaitSync(_countersFence, 0, 0);
+	glDeleteSync(_countersFence);
+	_countersFence = nullptr;
+	if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+		return;
+
+	GLuint counters[2] = { 0, 0 };
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _counterBuffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(counters), counters);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	_reprojectedFragments = counters[0];
+	_mismatchedFragments = counters[1];
+
+	GLuint total = _reprojectedFragments + _mismatchedFragments;
+	_stats.pixelReuse = total > 0 ? (float)_reprojectedFragments / (float)total : 0.0f;
+}
+
+void ReprojectionMaskTechnique::RenderRightEye(Renderer& leftView, Renderer& rightView) {
+	GLuint depthTexture = leftView.GetDepthTexture();
+	GLuint colorTexture = leftView.GetColorTexture();
+	if (depthTexture == 0 || colorTexture == 0) {
+		TwoPassTechnique::RenderRightEye(leftView, rightView);
+		return;
+	}
+
+	if (_counterBuffer == 0) {
+		glGenBuffers(1, &_counterBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, _counterBuffer);
+		glBufferStorage(GL_SHADER_STORAGE_BUFFER, 2 * sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	}
+	ReadCounters();
+
+	GLuint zero[2] = { 0, 0 };
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _counterBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(zero), zero);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MaskCounterBinding, _counterBuffer);
+
+	// Every model compares against the left eye, not only the first one added
+	const auto& models = _queue.GetModels();
+	SelectVariant(models, StereoVariant::Reprojection);
+	for (const auto& model : models) {
+		if (!model)
+			continue;
+		auto shader = model->GetShader();
+		glProgramUniform1i(shader->GetID(), shader->GetUniformLocation(LeftDepthTextureUniform), 0);
+		glProgramUniform1i(shader->GetID(), shader->GetUniformLocation(LeftColorTextureUniform), 1);
+	}
+
+	GLStateCache::Get().BindTexture(0, GL_TEXTURE_2D, depthTexture);
+	GLStateCache::Get().BindTexture(1, GL_TEXTURE_2D, colorTexture);
+	GLStateCache::Get().ActiveTexture(0);
+
+	rightView.RenderToTextures(_queue);
+
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	_countersFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MaskCounterBinding, 0);
+}
+
+void ReprojectionMaskTechnique::DrawSettings(Renderer& leftView, Renderer& rightView) {
+	(void)leftView;
+	(void)rightView;
+	ImGui::Text("Reprojected: %u fragments, mismatched: %u fragments", _reprojectedFragments, _mismatchedFragments);
+}
+
+void StencilReprojectionTechnique::RenderRightEye(Renderer& leftView, Renderer& rightView) {
+	rightView.RenderToTexturesStencilMasked(_queue, leftView.GetColorTexture(), leftView.GetDepthTexture());
+	_stats.pixelReuse = rightView.GetPixelReuseRatio();
+}
+
+void StencilReprojectionTechnique::DrawSettings(Renderer& leftView, Renderer& rightView) {
+	(void)rightView;
+	DrawLeftPyramidStats(leftView);
+}
+
+void TileReprojectionTechnique::RenderRightEye(Renderer& leftView, Renderer& rightView) {
+	rightView.RenderToTexturesTiled(_queue, leftView.GetColorTexture(), leftView.GetDepthTexture());
+	_stats.pixelReuse = rightView.GetPixelReuseRatio();
+}
+
+void TileReprojectionTechnique::DrawSettings(Renderer& leftView, Renderer& rightView) {
+	auto& classifier = rightView.GetTileClassifier();
+	float threshold = classifier.GetFailureThreshold();
+	if (ImGui::SliderFloat("Tile failure threshold", &threshold, 0.0f, 1.0f, "%.3f")) {
+		classifier.SetFailureThreshold(threshold);
+	}
+	const TileStats& stats = classifier.GetStats();
+	ImGui::Text("Tiles shaded: %d / %d (%d scissor passes)", stats.shadedTileCount, stats.tileCount, stats.scissorPassCount);
+	ImGui::Text("Average tile failure: %.1f %%", stats.averageFailure * 100.0f);
+	DrawLeftPyramidStats(leftView);
+}
+
+void ForwardReprojectionTechnique::RenderRightEye(Renderer& leftView, Renderer& rightView) {
+	rightView.RenderToTexturesForward(_queue, leftView.GetColorTexture(), leftView.GetDepthTexture());
+	_stats.pixelReuse = rightView.GetPixelReuseRatio();
+}
+
+void ForwardReprojectionTechnique::DrawSettings(Renderer& leftView, Renderer& rightView) {
+	(void)leftView;
+	auto& reprojector = rightView.GetForwardReprojector();
+	int fillRadius = reprojector.GetFillRadius();
+	if (ImGui::SliderInt("Crack fill radius", &fillRadius, 0, ForwardReprojector::MaxFillRadius)) {
+		reprojector.SetFillRadius(fillRadius);
+	}
+	const ForwardReprojectionStats& stats = reprojector.GetStats();
+	ImGui::Text("Filled: %d px, re-rendered holes: %d px", stats.filledPixels, stats.holePixels);
+	const OcclusionCuller& culler = rightView.GetOcclusionCuller();
+	ImGui::Text("Hi-Z culling: %d / %d models drawn", culler.GetVisibleCount(), culler.GetTestedCount());
+}
+
+void SinglePassTechnique::SelectVariants(const std::vector<std::shared_ptr<Model>>& models) {
+	if (_layout == StereoLayout::Multiview)
+		SelectVariant(models, StereoVariant::Multiview);
+	else
+		SelectVariant(models, _layout == StereoLayout::Layered ? StereoVariant::InstancedLayer : StereoVariant::Instanced);
+}
+
+void SinglePassTechnique::RenderViews(const StereoScene& scene, Renderer& leftView, Renderer& rightView, StereoTargets& targets) {
+	(void)scene;
+	PROFILE_SCOPE("Single pass");
+	if (!targets.stereoTarget)
+		return;
+
+	targets.stereoTarget->SetLayout(_layout);
+
+	{
+		GpuScope scope(_profiler, "Stereo RenderToTextures");
+		leftView.RenderToStereoTarget(_queue, *targets.stereoTarget, *rightView.GetCamera());
+	}
+
+	// Both eyes shaded in full by the same pass
+	_stats.pixelReuse = 0.0f;
+	for (int eye = 0; eye < 2; eye++) {
+		targets.colorTextures[eye] = targets.stereoTarget->GetColorTexture(eye);
+		targets.depthTextures[eye] = targets.stereoTarget->GetDepthTexture(eye);
+	}
+}
+
+void InstancedTechnique::DrawSettings(Renderer& leftView, Renderer& rightView) {
+	(void)leftView;
+	(void)rightView;
+	ImGui::Text("Instanced routing: %s", StereoRenderTarget::IsVertexLayerSupported() ? "gl_Layer" : "side-by-side");
+}
+
+void stereorizer::graphics::RegisterBuiltInStereoTechniques(StereoTechniqueRegistry& registry) {
+	registry.Register("two-pass", "One full pass per eye",
+		[] { return std::make_unique<TwoPassTechnique>(); });
+	registry.Register("reprojection-mask", "Right eye shows the left color where it reprojects, mismatches in pink",
+		[] { return std::make_unique<ReprojectionMaskTechnique>(); });
+	registry.Register("stencil-reprojection", "Reuse left-eye pixels, shade only disoccluded ones behind a stencil mask",
+		[] { return std::make_unique<StencilReprojectionTechnique>(); });
+	registry.Register("tile-reprojection", "Reuse left-eye pixels, shade only tiles that fail reprojection",
+		[] { return std::make_unique<TileReprojectionTechnique>(); });
+	registry.Register("forward-reprojection", "Scatter left-eye pixels in compute, re-render only the remaining holes",
+		[] { return std::make_unique<ForwardReprojectionTechnique>(); });
+	registry.Register("multiview", "Single pass into a 2-layer texture array via GL_OVR_multiview2",
+		[] { return std::make_unique<MultiviewTechnique>(); });
+	registry.Register("instanced", "Single pass, one instance per eye routed by gl_Layer or side-by-side",
+		[] { return std::make_unique<InstancedTechnique>(); });
+}
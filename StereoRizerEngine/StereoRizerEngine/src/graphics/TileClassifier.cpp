@@ -0,0 +1,214 @@
+#include "graphics/TileClassifier.h"
+#include "graphics/GLStateCache.h"
+#include "core/Common.h"
+
+#include <algorithm>
+
+using namespace stereorizer::graphics;
+
+namespace
+{
+	constexpr UniformId RightDepthTextureUniform("rightDepthTexture");
+	constexpr UniformId LeftDepthTextureUniform("leftDepthTexture");
+	constexpr UniformId LeftColorTextureUniform("leftColorTexture");
+	constexpr UniformId FailureThresholdUniform("failureThreshold");
+	constexpr UniformId LeftDepthPyramidUniform("leftDepthPyramid");
+	constexpr UniformId PyramidLevelUniform("pyramidLevel");
+
+	// Match the "binding =" qualifiers in TileClassify.shader
+	constexpr GLuint RightColorImageUnit = 0;
+	constexpr GLuint FailureBufferBinding = 1;
+	constexpr GLuint ListBufferBinding = 2;
+}
+
+TileClassifier::TileClassifier() {
+	// Shader and buffers are created on the first Classify(), the context might not be ready yet
+}
+
+TileClassifier::~TileClassifier() {
+	DeleteBuffers();
+}
+
+void TileClassifier::DeleteBuffers() {
+	if (_failureBuffer != 0) {
+		glDeleteBuffers(1, &_failureBuffer);
+		_failureBuffer = 0;
+	}
+	if (_listBuffer != 0) {
+		glDeleteBuffers(1, &_listBuffer);
+		_listBuffer = 0;
+	}
+}
+
+bool TileClassifier::CreateResources(int width, int height) {
+	if (!_shader) {
+		try {
+			_shader = std::make_shared<Shader>("resources/shaders/TileClassify.shader",
+				std::unordered_map<std::string, std::string>{ { "TILE_SIZE", std::to_string(TileSize) } });
+		} catch (const std::exception& e) {
+			LOG_ERROR(std::string("Failed to load tile classification shader: ") + e.what());
+			return false;
+		}
+	}
+	if (_shader->GetID() == 0)
+		return false;
+
+	if (_failureBuffer != 0 && width == _width && height == _height)
+		return true;
+
+	DeleteBuffers();
+	_width = width;
+	_height = height;
+	_tilesX = (width + TileSize - 1) / TileSize;
+	_tilesY = (height + TileSize - 1) / TileSize;
+	GLsizeiptr tileCount = (GLsizeiptr)_tilesX * _tilesY;
+
+	glGenBuffers(1, &_failureBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _failureBuffer);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, tileCount * sizeof(GLuint), nullptr, 0);
+
+	glGenBuffers(1, &_listBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _listBuffer);
+	glBufferStorage(GL_SHADER_STORAGE_BUFFER, (tileCount + 1) * sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	LOG_INFO("Tile classifier: " + std::to_string(_tilesX) + "x" + std::to_string(_tilesY) + " tiles of " + std::to_string(TileSize) + " pixels");
+	return true;
+}
+
+bool TileClassifier::Classify(GLuint rightDepthTexture, GLuint leftDepthTexture, GLuint leftColorTexture,
+	GLuint rightColorTexture, int width, int height, const DepthPyramid* leftPyramid) {
+	if (width <= 0 || height <= 0 || !CreateResources(width, height))
+		return false;
+
+	GLuint previousProgram = GLStateCache::Get().GetProgram();
+
+	_shader->ReloadIfChanged();
+	bool usePyramid = leftPyramid && leftPyramid->IsValid();
+	if (usePyramid)
+		_shader->EnableDefine("USE_DEPTH_PYRAMID");
+	else
+		_shader->DisableDefine("USE_DEPTH_PYRAMID");
+	_shader->ActivateVariant();
+
+	GLStateCache::Get().BindTexture(0, GL_TEXTURE_2D, rightDepthTexture);
+	glUniform1i(_shader->GetUniformLocation(RightDepthTextureUniform), 0);
+	GLStateCache::Get().BindTexture(1, GL_TEXTURE_2D, leftDepthTexture);
+	glUniform1i(_shader->GetUniformLocation(LeftDepthTextureUniform), 1);
+	GLStateCache::Get().BindTexture(2, GL_TEXTURE_2D, leftColorTexture);
+	glUniform1i(_shader->GetUniformLocation(LeftColorTextureUniform), 2);
+	if (usePyramid) {
+		GLStateCache::Get().BindTexture(3, GL_TEXTURE_2D, leftPyramid->GetTexture());
+		glUniform1i(_shader->GetUniformLocation(LeftDepthPyramidUniform), 3);
+		glUniform1i(_shader->GetUniformLocation(PyramidLevelUniform), std::min(DepthPyramid::BlockTestLevel, leftPyramid->GetLevelCount() - 1));
+	}
+	GLStateCache::Get().ActiveTexture(0);
+	glUniform1f(_shader->GetUniformLocation(FailureThresholdUniform), _failureThreshold);
+
+	glBindImageTexture(RightColorImageUnit, rightColorTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+	// Reset the list counter, the per-tile counts are overwritten by every work group
+	GLuint zero = 0;
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _listBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, FailureBufferBinding, _failureBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ListBufferBinding, _listBuffer);
+
+	glDispatchCompute((GLuint)_tilesX, (GLuint)_tilesY, 1);
+
+	// Copied pixels are rendered over next, the lists are read back right away
+	glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	// The scissor rectangles are needed on the CPU before the right eye is drawn, so this
+	// read is a sync point within the frame
+	int tileCount = _tilesX * _tilesY;
+	std::vector<GLuint> list(tileCount + 1);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, list.size() * sizeof(GLuint), list.data());
+
+	std::vector<GLuint> failures(tileCount);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _failureBuffer);
+	glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, failures.size() * sizeof(GLuint), failures.data());
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	GLStateCache::Get().UseProgram(previousProgram);
+
+	_tileFailure.resize(tileCount);
+	float failureSum = 0.0f;
+	for (int i = 0; i < tileCount; i++) {
+		int tileX = i % _tilesX;
+		int tileY = i / _tilesX;
+		int pixels = std::min(TileSize, width - tileX * TileSize) * std::min(TileSize, height - tileY * TileSize);
+		_tileFailure[i] = (float)failures[i] / (float)pixels;
+		failureSum += _tileFailure[i];
+	}
+
+	GLuint shadedCount = std::min<GLuint>(list[0], (GLuint)tileCount);
+	std::vector<GLuint> tiles(list.begin() + 1, list.begin() + 1 + shadedCount);
+	BuildShadeRects(tiles);
+
+	_stats.tileCount = tileCount;
+	_stats.shadedTileCount = (int)shadedCount;
+	_stats.scissorPassCount = (int)_shadeRects.size();
+	_stats.averageFailure = tileCount > 0 ? failureSum / tileCount : 0.0f;
+	return true;
+}
+
+void TileClassifier::BuildShadeRects(std::vector<GLuint>& tiles) {
+	_shadeRects.clear();
+	if (tiles.empty())
+		return;
+
+	// Work groups append in any order, sorting makes neighbouring tiles of a row adjacent
+	std::sort(tiles.begin(), tiles.end());
+
+	// Merge horizontal runs of tiles into spans
+	std::vector<TileRect> spans;
+	for (size_t i = 0; i < tiles.size();) {
+		GLuint first = tiles[i];
+		size_t j = i + 1;
+		while (j < tiles.size() && tiles[j] == tiles[j - 1] + 1 && tiles[j] % _tilesX != 0)
+			j++;
+		int tileX = (int)(first % _tilesX);
+		int tileY = (int)(first / _tilesX);
+		spans.push_back({ tileX, tileY, (int)(j - i), 1 });
+		i = j;
+	}
+
+	// Stack spans with the same extent in consecutive rows
+	std::vector<TileRect> merged;
+	for (const auto& span : spans) {
+		auto it = std::find_if(merged.begin(), merged.end(), [&](const TileRect& rect) {
+			return rect.x == span.x && rect.width == span.width && rect.y + rect.height == span.y;
+		});
+		if (it != merged.end())
+			it->height++;
+		else
+			merged.push_back(span);
+	}
+
+	// Each rectangle costs a full geometry submission, past the limit one bounding box is cheaper
+	if ((int)merged.size() > MaxScissorPasses) {
+		TileRect bounds = merged.front();
+		int right = bounds.x + bounds.width;
+		int top = bounds.y + bounds.height;
+		for (const auto& rect : merged) {
+			bounds.x = std::min(bounds.x, rect.x);
+			bounds.y = std::min(bounds.y, rect.y);
+			right = std::max(right, rect.x + rect.width);
+			top = std::max(top, rect.y + rect.height);
+		}
+		bounds.width = right - bounds.x;
+		bounds.height = top - bounds.y;
+		merged.assign(1, bounds);
+	}
+
+	// Tiles to pixels, clamped to the view
+	for (const auto& rect : merged) {
+		TileRect pixels;
+		pixels.x = rect.x * TileSize;
+		pixels.y = rect.y * TileSize;
+		pixels.width = std::min(rect.width * TileSize, _width - pixels.x);
+		pixels.height = std::min(rect.height * TileSize, _height - pixels.y);
+		_shadeRects.push_back(pixels);
+	}
+}
@@ -1,26 +1,45 @@
 #include <graphics/VertexArray.h>
+#include <graphics/GLStateCache.h>
 
 using namespace stereorizer::graphics;
 
 VertexArray::VertexArray()
 {
 	glGenVertexArrays(1, &id);
-	glBindVertexArray(id);
+	GLStateCache::Get().BindVertexArray(id);
 }
 
 VertexArray::~VertexArray()
 {
-	glDeleteVertexArrays(1, &id);
+	GLStateCache::Get().DeleteVertexArrays(1, &id);
 }
 
 void VertexArray::drawArray(const VertexBuffer& vertexBuffer, DrawType drawType)
 {
-	//useIfNecessary();
+	GLStateCache::Get().BindVertexArray(id);
 	glDrawArrays((int32_t)drawType, 0, vertexBuffer.vertexCount);
 }
 
 void VertexArray::drawElements(const ElementBuffer& elementBuffer, DrawType drawType)
 {
-	//useIfNecessary();
-	glDrawElements((int32_t)drawType, elementBuffer.indicesSize, GL_UNSIGNED_INT, 0);
+	GLStateCache::Get().BindVertexArray(id);
+	glDrawElements((int32_t)drawType, elementBuffer.indicesSize, elementBuffer.indexType, 0);
+}
+
+void VertexArray::drawArrayInstanced(const VertexBuffer& vertexBuffer, DrawType drawType, int instanceCount)
+{
+	GLStateCache::Get().BindVertexArray(id);
+	glDrawArraysInstanced((int32_t)drawType, 0, vertexBuffer.vertexCount, instanceCount);
+}
+
+void VertexArray::drawElementsInstanced(const ElementBuffer& elementBuffer, DrawType drawType, int instanceCount)
+{
+	GLStateCache::Get().BindVertexArray(id);
+	glDrawElementsInstanced((int32_t)drawType, elementBuffer.indicesSize, elementBuffer.indexType, 0, instanceCount);
+}
+
+void VertexArray::drawElementsIndirect(const ElementBuffer& elementBuffer, DrawType drawType, GLintptr commandOffset)
+{
+	GLStateCache::Get().BindVertexArray(id);
+	glDrawElementsIndirect((int32_t)drawType, elementBuffer.indexType, (const void*)commandOffset);
 }
\ No newline at end of file
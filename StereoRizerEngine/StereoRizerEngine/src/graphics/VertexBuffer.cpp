@@ -1,23 +1,53 @@
 #include <graphics/VertexBuffer.h>
 #include <iostream>
 #include <graphics/VertexArray.h>
+#include <graphics/GLStateCache.h>
 
 using namespace stereorizer::graphics;
 
 VertexBuffer::VertexBuffer(VertexArray& vertexArray, const std::vector<float>& vertices, const std::vector<uint32_t>& attributeSizes, BufferAccessType accessType, BufferCallType callType) : vertexCount((uint32_t)vertices.size() / stride(attributeSizes))
 {
 	glGenBuffers(1, &id);
+	// The attribute pointers land in whatever VAO is bound, make sure it is the one they belong to
+	GLStateCache::Get().BindVertexArray(vertexArray.getId());
 	glBindBuffer(GL_ARRAY_BUFFER, id);
 	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STREAM_DRAW + (int32_t)accessType + (int32_t)callType);
-	uint32_t strideSize = stride(attributeSizes) * sizeof(float);
+	setupAttributes(VertexLayout::fromFloatSizes(attributeSizes));
+}
 
-	for (uint32_t i = 0; i < attributeSizes.size(); i++)
+VertexBuffer::VertexBuffer(VertexArray& vertexArray, const void* data, size_t size, const VertexLayout& layout) : vertexCount(layout.stride > 0 ? (int)(size / layout.stride) : 0)
+{
+	glGenBuffers(1, &id);
+	GLStateCache::Get().BindVertexArray(vertexArray.getId());
+	glBindBuffer(GL_ARRAY_BUFFER, id);
+	glBufferStorage(GL_ARRAY_BUFFER, size, data, 0);
+	setupAttributes(layout);
+}
+
+void VertexBuffer::setupAttributes(const VertexLayout& layout)
+{
+	for (uint32_t i = 0; i < layout.attributes.size(); i++)
 	{
-		glVertexAttribPointer(i, attributeSizes[i], GL_FLOAT, GL_FALSE, strideSize, (void*)(attributeOffset(attributeSizes, i) * sizeof(float)));
+		const VertexAttribute& attribute = layout.attributes[i];
+		glVertexAttribPointer(i, attribute.components, attribute.type, attribute.normalized, layout.stride, (void*)(uintptr_t)attribute.offset);
 		glEnableVertexAttribArray(i);
 	}
 }
 
+VertexLayout VertexLayout::fromFloatSizes(const std::vector<uint32_t>& attributeSizes)
+{
+	VertexLayout layout;
+	for (uint32_t i = 0; i < attributeSizes.size(); i++)
+	{
+		VertexAttribute attribute;
+		attribute.components = (GLint)attributeSizes[i];
+		attribute.offset = VertexBuffer::attributeOffset(attributeSizes, i) * sizeof(float);
+		layout.attributes.push_back(attribute);
+	}
+	layout.stride = (GLsizei)(VertexBuffer::stride(attributeSizes) * sizeof(float));
+	return layout;
+}
+
 const uint32_t VertexBuffer::attributeOffset(const std::vector<uint32_t>& attributeSizes, uint32_t index)
 {
 	uint32_t tot = 0;
@@ -1,7 +1,10 @@
 ﻿#include "xr/OpenXRSupport.h"
 #include "core/Common.h"
+#include "core/CpuProfiler.h"
+#include "graphics/GLStateCache.h"
 
 using namespace stereorizer::xr;
+using namespace stereorizer::graphics;
 
 OpenXRSupport::OpenXRSupport()
 {
@@ -126,6 +129,8 @@ bool OpenXRSupport::Init(GraphicsAPI_Type apiType)
 	}
 
 	// Create session (using OpenGL graphics binding)
+	XrSessionCreateInfo sessionCreateInfo{ XR_TYPE_SESSION_CREATE_INFO };
+#ifdef _WIN32
 	XrGraphicsBindingOpenGLWin32KHR graphicsBinding{ XR_TYPE_GRAPHICS_BINDING_OPENGL_WIN32_KHR };
 	graphicsBinding.hDC = wglGetCurrentDC();
 	graphicsBinding.hGLRC = wglGetCurrentContext();
@@ -133,8 +138,12 @@ bool OpenXRSupport::Init(GraphicsAPI_Type apiType)
 	xrSessionGLRC = graphicsBinding.hGLRC;
 	xrSessionDC = graphicsBinding.hDC;
 
-	XrSessionCreateInfo sessionCreateInfo{ XR_TYPE_SESSION_CREATE_INFO };
 	sessionCreateInfo.next = &graphicsBinding;
+#else
+	// Only the WGL binding exists so far
+	LOG_ERROR("OpenXR session binding is only implemented for Win32 OpenGL contexts");
+	return false;
+#endif
 	sessionCreateInfo.systemId = xrSystemId;
 
 	result = xrCreateSession(xrInstance, &sessionCreateInfo, &xrSession);
@@ -248,18 +257,19 @@ bool OpenXRSupport::CopyFramebufferToSwapchain(GLuint srcFbo,
 	// Create a temporary FBO on the correct context
 	GLuint dstFbo = 0;
 	glGenFramebuffers(1, &dstFbo);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dstFbo);
+	GLStateCache& state = GLStateCache::Get();
+	state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, dstFbo);
 	glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, dstTex, 0);
 
 	if (glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
 		LOG_ERROR("Swapchain FBO incomplete");
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-		glDeleteFramebuffers(1, &dstFbo);
+		state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+		state.DeleteFramebuffers(1, &dstFbo);
 		return false;
 	}
 
 	// Bind source FBO for reading
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, srcFbo);
+	state.BindFramebuffer(GL_READ_FRAMEBUFFER, srcFbo);
 	if (srcFbo == 0) {
 		glReadBuffer(GL_BACK); // default framebuffer
 	}
@@ -272,9 +282,8 @@ bool OpenXRSupport::CopyFramebufferToSwapchain(GLuint srcFbo,
 		GL_LINEAR);
 
 	// 6Clean up
-	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-	glDeleteFramebuffers(1, &dstFbo);
+	state.BindFramebuffer(GL_FRAMEBUFFER, 0);
+	state.DeleteFramebuffers(1, &dstFbo);
 
 	glFlush(); // ensure GPU starts processing before xrReleaseSwapchainImage
 
@@ -295,6 +304,7 @@ void OpenXRSupport::InitCopyFrameBuffer(int width, int height)
 
 bool OpenXRSupport::WaitFrame()
 {
+	PROFILE_SCOPE("XR wait");
 	XrResult res;
 	
 	res = xrWaitFrame(xrSession, nullptr, &frameState);
@@ -308,6 +318,7 @@ bool OpenXRSupport::WaitFrame()
 
 bool OpenXRSupport::BeginFrame()
 {
+	PROFILE_SCOPE("XR begin");
 	XrResult res;
 	res = xrBeginFrame(xrSession, nullptr);
 	if (XR_FAILED(res)) {
@@ -399,6 +410,7 @@ std::tuple<uint32_t, uint32_t> OpenXRSupport::CreateXRSwapchains()
 
 bool OpenXRSupport::LocateViews()
 {
+	PROFILE_SCOPE("XR locate");
 	XrResult res;
 
 	locateInfo.viewConfigurationType = XR_VIEW_CONFIGURATION_TYPE_PRIMARY_STEREO;
@@ -517,5 +529,5 @@ bool OpenXRSupport::CopyFrameBuffer()
 
 void OpenXRSupport::EndLoop()
 {
-	glDeleteFramebuffers(1, &xrDstFbo);
+	GLStateCache::Get().DeleteFramebuffers(1, &xrDstFbo);
 }